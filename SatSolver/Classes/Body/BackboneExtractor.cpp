@@ -0,0 +1,245 @@
+/**
+<summary>
+The BackboneExtractor class computes the literals every model of a formula
+satisfies, by chunked probing on incremental CdclSolvers.
+</summary>
+*/
+#include "BackboneExtractor.h"
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+
+// Constructor for the BackboneExtractor class
+BackboneExtractor::BackboneExtractor(const BooleanFormula &formula, int num_workers)
+    : formula(formula), num_workers(std::max(1, num_workers)), num_vars(formula.getVariableCount()),
+      model(num_vars, BoolValue::UNASSIGNED)
+{
+    // Flipping counts TRUE literals, so repeated literals are merged and tautologies, never FALSE, left out
+    occurrences.resize(2 * num_vars);
+    std::vector<int> lits;
+    for (const Clause &clause : formula.getClauses())
+    {
+        lits.clear();
+        for (const Literal &lit : clause.getLiterals())
+        {
+            lits.push_back(2 * (lit.getVariable() - 1) + (lit.getValue() == BoolValue::FALSE ? 1 : 0));
+        }
+        std::sort(lits.begin(), lits.end());
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+        bool tautology = false;
+        for (size_t i = 1; i < lits.size(); i++)
+        {
+            tautology |= (lits[i] == (lits[i - 1] ^ 1));
+        }
+        if (tautology)
+        {
+            continue;
+        }
+        int index = static_cast<int>(clauses.size());
+        clauses.emplace_back();
+        for (int lit : lits)
+        {
+            clauses.back().push_back((lit & 1) ? -((lit >> 1) + 1) : (lit >> 1) + 1);
+            occurrences[lit].push_back(index);
+        }
+    }
+    true_counts.assign(clauses.size(), 0);
+}
+
+/**
+<summary>
+Decides the formula and, if it is satisfiable, computes its backbone.
+</summary>
+<returns>True if the formula is satisfiable, otherwise false.</returns>
+*/
+bool BackboneExtractor::compute()
+{
+    workers.resize(1);
+    workers[0].sat.reset(new CdclSolver(formula));
+    num_sat_calls++;
+    if (workers[0].sat->solveLimited() != BoolValue::TRUE)
+    {
+        return false;
+    }
+    model = workers[0].sat->getAssignment();
+    model.resize(num_vars, BoolValue::UNASSIGNED);
+
+    status.assign(num_vars, Status::CANDIDATE);
+    candidate.resize(num_vars);
+    in_flight.assign(num_vars, 0);
+    for (int var = 0; var < num_vars; var++)
+    {
+        candidate[var] = model[var] == BoolValue::FALSE ? -(var + 1) : var + 1;
+    }
+    filter(model);
+
+    // The other workers build their solvers on their own threads
+    int remaining = static_cast<int>(std::count(status.begin(), status.end(), Status::CANDIDATE));
+    workers.resize(std::min(num_workers, std::max(1, (remaining + chunk_size - 1) / chunk_size)));
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers.size(); w++)
+    {
+        threads.emplace_back([this, w]()
+                             {
+                                 workers[w].sat.reset(new CdclSolver(formula));
+                                 probe(workers[w]);
+                             });
+    }
+    probe(workers[0]);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int var = 0; var < num_vars; var++)
+    {
+        if (status[var] == Status::BACKBONE)
+        {
+            backbone.push_back(candidate[var]);
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Tests chunks of candidates until every variable is decided.
+</summary>
+<param name="worker">The worker's solver.</param>
+<remarks>
+A worker takes the first candidates no other worker is testing, and waits while
+there are none but some test may still leave candidates undecided. The clause
+of a chunk stays in the solver, switched off by the negation of its activation
+literal once the call is over.
+</remarks>
+*/
+void BackboneExtractor::probe(Worker &worker)
+{
+    std::vector<int> chunk;
+    std::vector<int> pending;
+    std::vector<int> negation;
+    while (true)
+    {
+        chunk.clear();
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            while (true)
+            {
+                while (next_candidate < status.size() && status[next_candidate] != Status::CANDIDATE)
+                {
+                    next_candidate++;
+                }
+                for (size_t var = next_candidate; var < status.size() && chunk.size() < static_cast<size_t>(chunk_size); var++)
+                {
+                    if (status[var] == Status::CANDIDATE && !in_flight[var])
+                    {
+                        chunk.push_back(static_cast<int>(var));
+                    }
+                }
+                if (!chunk.empty() || num_in_flight == 0)
+                {
+                    break;
+                }
+                changed.wait(lock);
+            }
+            if (chunk.empty())
+            {
+                return;
+            }
+            for (int var : chunk)
+            {
+                in_flight[var] = 1;
+            }
+            num_in_flight++;
+            pending.assign(fixed.begin() + worker.fixed_added, fixed.end());
+            worker.fixed_added = fixed.size();
+        }
+
+        for (int lit : pending)
+        {
+            worker.sat->addClause(std::vector<int>{lit});
+        }
+        int activation = worker.sat->newVariable();
+        negation.assign(1, -activation);
+        for (int var : chunk)
+        {
+            negation.push_back(-candidate[var]);
+        }
+        worker.sat->addClause(negation);
+        BoolValue result = worker.sat->solveLimited(std::vector<int>{activation});
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            num_sat_calls++;
+            for (int var : chunk)
+            {
+                in_flight[var] = 0;
+            }
+            num_in_flight--;
+            if (result == BoolValue::TRUE)
+            {
+                filter(worker.sat->getAssignment());
+            }
+            else
+            {
+                // No model falsifies any literal of the chunk, so none can have been refuted
+                num_backbone_chunks++;
+                for (int var : chunk)
+                {
+                    status[var] = Status::BACKBONE;
+                    fixed.push_back(candidate[var]);
+                }
+            }
+        }
+        changed.notify_all();
+        worker.sat->addClause(std::vector<int>{-activation});
+    }
+}
+
+/**
+<summary>
+Refutes the candidates a model falsifies or can flip; the caller holds mtx.
+</summary>
+<param name="assignment">The model, one BoolValue per variable of the solver.</param>
+<remarks>
+A candidate the model satisfies can still be flipped when every clause it
+occurs in has another TRUE literal; the flipped assignment is a model too.
+</remarks>
+*/
+void BackboneExtractor::filter(const std::vector<BoolValue> &assignment)
+{
+    for (int var = 0; var < num_vars; var++)
+    {
+        if (status[var] == Status::CANDIDATE && assignment[var] != (candidate[var] > 0 ? BoolValue::TRUE : BoolValue::FALSE))
+        {
+            status[var] = Status::REFUTED;
+            num_filtered++;
+        }
+    }
+
+    for (size_t c = 0; c < clauses.size(); c++)
+    {
+        true_counts[c] = 0;
+        for (int lit : clauses[c])
+        {
+            true_counts[c] += assignment[std::abs(lit) - 1] == (lit > 0 ? BoolValue::TRUE : BoolValue::FALSE);
+        }
+    }
+    for (int var = 0; var < num_vars; var++)
+    {
+        if (status[var] != Status::CANDIDATE)
+        {
+            continue;
+        }
+        bool flippable = true;
+        for (int c : occurrences[2 * var + (candidate[var] > 0 ? 0 : 1)])
+        {
+            flippable &= true_counts[c] >= 2;
+        }
+        if (flippable)
+        {
+            status[var] = Status::REFUTED;
+            num_flipped++;
+        }
+    }
+}
@@ -6,16 +6,20 @@ and pure literal elimination.
 </summary>
 */
 #include "BacktrackSolver.h"
+#include "Tracer.h"
+#include <stdexcept>
 
 // Constructor for the BacktrackSolver class
-BacktrackSolver::BacktrackSolver(BooleanFormula &formula)
-    : formula(formula)
+BacktrackSolver::BacktrackSolver(const BooleanFormula &formula, SolverWorkspace *workspace)
+    : formula(formula),
+      owned_workspace(workspace == nullptr ? new SolverWorkspace() : nullptr),
+      workspace(workspace != nullptr ? *workspace : *owned_workspace),
+      current_assignment(this->workspace.assignment),
+      variable_activity(this->workspace.activity),
+      clause_store(this->workspace.clause_store)
 {
-    // Initialize the current assignment vector with UNASSIGNED values
-    int varCount = formula.getVariableCount();
-    current_assignment.resize(varCount, BoolValue::UNASSIGNED);
-    // Initialize the variable activity vector with zeros
-    variable_activity.resize(varCount, 0);
+    // Start from UNASSIGNED values and zero activity, reusing the workspace's buffers
+    this->workspace.reset(formula.getVariableCount(), formula.getClauses());
 }
 
 /**
@@ -27,17 +31,165 @@ Tries to solve the Boolean formula using backtracking.
 bool BacktrackSolver::solve()
 {
     // Perform unit propagation and check for conflicts
-    if (!unitPropagation())
     {
-        return false;
+        TraceScope trace("propagate");
+        if (!unitPropagation())
+        {
+            return false;
+        }
     }
     // Perform pure literal elimination
-    if (!pureLiteralElimination())
     {
-        return false;
+        TraceScope trace("pure literals");
+        if (!pureLiteralElimination())
+        {
+            return false;
+        }
+    }
+    initializeCounters();
+    if (!resumed.decisions.empty())
+    {
+        // The steps above are deterministic, so the snapshot's counters already include them
+        num_decisions = resumed.num_decisions;
+        num_backtracks = resumed.num_backtracks;
+        num_unit_propagations = resumed.num_unit_propagations;
     }
     // Start the backtracking process
-    return backtrack();
+    bool result = backtrack();
+    if (checkpointer)
+    {
+        checkpointer->discard();
+    }
+    // The counters decided satisfiability; check the model once against the clauses themselves
+    if (result && !clause_store.verify(current_assignment))
+    {
+        throw std::logic_error("BacktrackSolver found an assignment that does not satisfy the formula");
+    }
+    return result;
+}
+
+/**
+<summary>
+Makes solve() write snapshots of its search to a file and resume from the one
+already there.
+</summary>
+<param name="path">The snapshot file.</param>
+<param name="interval">The minimum time between two snapshots.</param>
+<returns>True if a snapshot was loaded and the search will resume from it.</returns>
+<remarks>
+The search state is the path of branches to the node being explored: every
+branch left of it has been refuted. Variable activity is recomputed at each
+node and nothing is learned, so the path and the counters are all a snapshot
+needs.
+</remarks>
+*/
+bool BacktrackSolver::enableCheckpoints(const std::string &path, std::chrono::milliseconds interval)
+{
+    uint64_t formula_hash = Checkpointer::hashFormula(formula);
+    bool loaded = Checkpointer::load(path, formula_hash, resumed);
+    for (const SearchDecision &decision : resumed.decisions)
+    {
+        if (decision.variable < 0 || decision.variable >= static_cast<int>(current_assignment.size()))
+        {
+            loaded = false;
+        }
+    }
+    if (!loaded)
+    {
+        resumed = CheckpointState();
+    }
+    decisions.reserve(current_assignment.size());
+    unchanged_depth = resumed.decisions.size();
+    checkpointer.reset(new Checkpointer(path, formula_hash, interval, resumed));
+    return loaded;
+}
+
+/**
+<summary>
+Hands the current decision stack and counters to the checkpointer.
+</summary>
+*/
+void BacktrackSolver::saveCheckpoint()
+{
+    CheckpointState counters;
+    counters.num_decisions = num_decisions;
+    counters.num_backtracks = num_backtracks;
+    counters.num_unit_propagations = num_unit_propagations;
+    checkpointer->submit(unchanged_depth, decisions, counters);
+    unchanged_depth = decisions.size();
+}
+
+/**
+<summary>
+Enumerates the models of the formula projected onto a set of variables.
+</summary>
+<param name="projection">The 1-based variables to project onto; empty means all variables.</param>
+<param name="limit">The maximum number of projected models to find; 0 means no limit.</param>
+<param name="on_model">Called with the assignment of each model; returning false stops the enumeration.</param>
+<returns>The number of distinct projected models found.</returns>
+<remarks>
+Pure literal elimination is skipped because it discards models.
+</remarks>
+*/
+ModelCount BacktrackSolver::enumerate(const std::vector<int> &projection, unsigned long long limit,
+                                      const std::function<bool(const std::vector<BoolValue> &)> &on_model)
+{
+    enumerating = true;
+    projected_variables = projection;
+    if (projected_variables.empty())
+    {
+        for (size_t i = 0; i < current_assignment.size(); i++)
+        {
+            projected_variables.push_back(i + 1);
+        }
+    }
+    model_limit = limit;
+    model_callback = on_model;
+    models_found = ModelCount(0);
+
+    if (unitPropagation())
+    {
+        initializeCounters();
+        backtrack();
+    }
+
+    enumerating = false;
+    return models_found;
+}
+
+/**
+<summary>
+Records the model at the current node: adds its blocking clause, updates the
+count and notifies the callback.
+</summary>
+<returns>True if the enumeration should continue, otherwise false.</returns>
+*/
+bool BacktrackSolver::recordModel()
+{
+    Clause blocking;
+    int unassigned_projected = 0;
+    for (int var : projected_variables)
+    {
+        BoolValue val = current_assignment[var - 1];
+        if (val == BoolValue::UNASSIGNED)
+        {
+            unassigned_projected++;
+        }
+        else
+        {
+            blocking.addLiteral(Literal(var, val).negate());
+        }
+    }
+    blocking_clauses.push_back(blocking);
+    clause_store.add(blocking);
+    models_found += ModelCount::powerOfTwo(unassigned_projected);
+
+    if (model_callback && !model_callback(current_assignment))
+    {
+        return false;
+    }
+    // An empty blocking clause means every projected model has been covered
+    return !blocking.getLiterals().empty() && (model_limit == 0 || !models_found.atLeast(model_limit));
 }
 
 /**
@@ -63,21 +215,59 @@ bool BacktrackSolver::backtrack()
     // Increment the decision count
     num_decisions++;
 
-    // Check if all clauses are satisfied with the current assignment
-    if (isAllClausesSatisfied())
+    // The clause counters give the status of the formula; blocking clauses need a full evaluation
+    BoolValue status = num_falsified_clauses > 0 ? BoolValue::FALSE
+                       : enumerating             ? evaluateClauses()
+                       : isAllClausesSatisfied() ? BoolValue::TRUE
+                                                 : BoolValue::UNASSIGNED;
+    if (status == BoolValue::TRUE)
     {
-        // Print the solution if all clauses are satisfied
-        std::cout << "Solution found: ";
-        for (BoolValue val : current_assignment)
+        if (enumerating)
         {
-            std::cout << static_cast<int>(val) << " ";
+            // Block this model and keep searching from the current node
+            return !recordModel();
+        }
+
+        // Print the solution if all clauses are satisfied, formatted in one buffer
+        if (verbose)
+        {
+            std::string line = "Solution found: ";
+            line.reserve(line.size() + 2 * current_assignment.size());
+            for (BoolValue val : current_assignment)
+            {
+                line += static_cast<char>('0' + static_cast<int>(val));
+                line += ' ';
+            }
+            std::cout << line << std::endl;
         }
-        std::cout << std::endl;
         return true;
     }
 
-    // Decide which variable to assign next based on variable activity
-    int variable_index = decideVariable();
+    // A falsified clause cannot be repaired deeper in this subtree
+    if (status == BoolValue::FALSE)
+    {
+        return false;
+    }
+
+    if (checkpointer && !enumerating && checkpointer->due())
+    {
+        saveCheckpoint();
+    }
+
+    // Follow a resumed snapshot down to its node, then decide based on variable activity
+    int variable_index;
+    BoolValue first_value = BoolValue::TRUE;
+    if (!enumerating && resume_depth < resumed.decisions.size())
+    {
+        variable_index = resumed.decisions[resume_depth].variable;
+        first_value = resumed.decisions[resume_depth].value;
+        resume_depth++;
+    }
+    else
+    {
+        TraceScope trace("decide");
+        variable_index = decideVariable();
+    }
 
     // No unassigned variable remains
     if (variable_index == -1)
@@ -85,22 +275,32 @@ bool BacktrackSolver::backtrack()
         return false;
     }
 
-    // Try TRUE assignment
-    current_assignment[variable_index] = BoolValue::TRUE;
-    num_backtracks++;
-    if (backtrack())
+    decisions.push_back({variable_index, BoolValue::TRUE});
+    // Try TRUE assignment, unless the snapshot shows it was already refuted
+    if (first_value == BoolValue::TRUE)
     {
-        return true;
+        assignVariable(variable_index, BoolValue::TRUE);
+        num_backtracks++;
+        if (backtrack())
+        {
+            return true;
+        }
+        unassignVariable(variable_index);
     }
     // Try FALSE assignment
-    current_assignment[variable_index] = BoolValue::FALSE;
+    decisions.back().value = BoolValue::FALSE;
+    unchanged_depth = std::min(unchanged_depth, decisions.size() - 1);
+    assignVariable(variable_index, BoolValue::FALSE);
     if (backtrack())
     {
         return true;
     }
 
     // If neither assignment worked, backtrack and mark the variable as unassigned
-    current_assignment[variable_index] = BoolValue::UNASSIGNED;
+    Tracer::instant("backtrack", variable_index + 1);
+    unassignVariable(variable_index);
+    decisions.pop_back();
+    unchanged_depth = std::min(unchanged_depth, decisions.size());
     return false;
 }
 
@@ -110,24 +310,15 @@ Decides which variable to try next based on the activity of variables
 in unsatisfied clauses.
 </summary>
 <returns>The index of the variable to assign next. Returns -1 if no variable is found.</returns>
+<remarks>
+The activity of a variable is its number of occurrences in clauses that
+Clause::evaluate() finds FALSE; there a negative literal of an unassigned
+variable counts as TRUE. assignVariable() and unassignVariable() keep the
+activity up to date, since only assigning TRUE can change such a clause.
+</remarks>
 */
 int BacktrackSolver::decideVariable()
 {
-    // Reset the variable activity count
-    std::fill(variable_activity.begin(), variable_activity.end(), 0);
-
-    // Count the frequency of variables in unsatisfied clauses
-    for (const Clause &clause : formula.getClauses())
-    {
-        if (clause.evaluate(current_assignment) == BoolValue::FALSE)
-        {
-            for (const Literal &lit : clause.getLiterals())
-            {
-                variable_activity[lit.getVariable() - 1]++;
-            }
-        }
-    }
-
     // Find an unassigned variable with the highest frequency (activity)
     int max_frequency = -1;
     int chosen_variable = -1;
@@ -171,17 +362,219 @@ bool BacktrackSolver::isSatisfied()
 Checks if all the clauses in the formula are satisfied with the current assignment.
 </summary>
 <returns>True if all clauses are satisfied, otherwise false.</returns>
+<remarks>
+Reads the counter kept along the search path instead of scanning the clauses.
+</remarks>
 */
 bool BacktrackSolver::isAllClausesSatisfied()
 {
+    return num_satisfied_clauses == formula.getClauseCount();
+}
+
+/**
+<summary>
+Builds the occurrence lists of the formula's literals and counts the TRUE
+and FALSE literals of each clause under the current assignment.
+</summary>
+<remarks>
+Called once before the search, after propagation at the root; from then on
+every assignment goes through assignVariable() and unassignVariable().
+</remarks>
+*/
+void BacktrackSolver::initializeCounters()
+{
+    std::vector<int> &literals = workspace.clause_literals;
+    std::vector<uint32_t> &starts = workspace.clause_starts;
+    std::vector<uint32_t> &occurrence_starts = workspace.occurrence_starts;
+    std::vector<uint32_t> &occurrences = workspace.occurrences;
+
+    literals.clear();
+    starts.assign(1, 0);
     for (const Clause &clause : formula.getClauses())
     {
-        if (clause.evaluate(current_assignment) == BoolValue::FALSE)
+        for (const Literal &lit : clause.getLiterals())
         {
-            return false;
+            literals.push_back(2 * (lit.getVariable() - 1) + (lit.getValue() == BoolValue::FALSE ? 1 : 0));
+        }
+        starts.push_back(static_cast<uint32_t>(literals.size()));
+    }
+
+    // Counting sort: prefix sums give each literal's end, filling backwards moves it to the start
+    occurrence_starts.assign(2 * current_assignment.size() + 1, 0);
+    for (int lit : literals)
+    {
+        occurrence_starts[lit]++;
+    }
+    for (size_t l = 1; l < occurrence_starts.size(); l++)
+    {
+        occurrence_starts[l] += occurrence_starts[l - 1];
+    }
+    occurrences.resize(literals.size());
+    int num_clauses = static_cast<int>(starts.size()) - 1;
+    for (int c = num_clauses - 1; c >= 0; c--)
+    {
+        for (uint32_t k = starts[c]; k < starts[c + 1]; k++)
+        {
+            occurrences[--occurrence_starts[literals[k]]] = c;
+        }
+    }
+
+    workspace.true_counts.assign(num_clauses, 0);
+    workspace.false_counts.assign(num_clauses, 0);
+    workspace.evaluated_counts.assign(num_clauses, 0);
+    std::fill(variable_activity.begin(), variable_activity.end(), 0);
+    num_satisfied_clauses = 0;
+    num_falsified_clauses = 0;
+    for (int c = 0; c < num_clauses; c++)
+    {
+        int true_count = 0, false_count = 0, evaluated_count = 0;
+        for (uint32_t k = starts[c]; k < starts[c + 1]; k++)
+        {
+            BoolValue val = current_assignment[literals[k] >> 1];
+            bool negative = (literals[k] & 1) != 0;
+            true_count += (val != BoolValue::UNASSIGNED && static_cast<int>(val) == (literals[k] & 1));
+            false_count += (val != BoolValue::UNASSIGNED && static_cast<int>(val) != (literals[k] & 1));
+            evaluated_count += negative ? val != BoolValue::TRUE : val == BoolValue::TRUE;
+        }
+        workspace.true_counts[c] = true_count;
+        workspace.false_counts[c] = false_count;
+        workspace.evaluated_counts[c] = evaluated_count;
+        num_satisfied_clauses += (true_count > 0);
+        num_falsified_clauses += (true_count == 0 && false_count == static_cast<int>(starts[c + 1] - starts[c]));
+        if (evaluated_count == 0)
+        {
+            for (uint32_t k = starts[c]; k < starts[c + 1]; k++)
+            {
+                variable_activity[literals[k] >> 1]++;
+            }
         }
     }
-    return true;
+}
+
+/**
+<summary>
+Adds to the activity of every variable of a clause.
+</summary>
+<param name="clause">The index of the clause.</param>
+<param name="delta">1 when the clause starts counting for decisions, -1 when it stops.</param>
+*/
+void BacktrackSolver::addClauseActivity(uint32_t clause, int delta)
+{
+    const std::vector<int> &literals = workspace.clause_literals;
+    for (uint32_t k = workspace.clause_starts[clause]; k < workspace.clause_starts[clause + 1]; k++)
+    {
+        variable_activity[literals[k] >> 1] += delta;
+    }
+}
+
+/**
+<summary>
+Assigns a variable and updates the counters of the clauses it occurs in.
+</summary>
+<param name="variable">The 0-based variable.</param>
+<param name="value">TRUE or FALSE.</param>
+*/
+void BacktrackSolver::assignVariable(int variable, BoolValue value)
+{
+    const std::vector<uint32_t> &starts = workspace.clause_starts;
+    const std::vector<uint32_t> &occurrence_starts = workspace.occurrence_starts;
+    const std::vector<uint32_t> &occurrences = workspace.occurrences;
+
+    current_assignment[variable] = value;
+    int satisfied = 2 * variable + (value == BoolValue::FALSE ? 1 : 0);
+    for (uint32_t o = occurrence_starts[satisfied]; o < occurrence_starts[satisfied + 1]; o++)
+    {
+        num_satisfied_clauses += (workspace.true_counts[occurrences[o]]++ == 0);
+    }
+    int falsified = satisfied ^ 1;
+    for (uint32_t o = occurrence_starts[falsified]; o < occurrence_starts[falsified + 1]; o++)
+    {
+        uint32_t c = occurrences[o];
+        if (++workspace.false_counts[c] == static_cast<int>(starts[c + 1] - starts[c]) && workspace.true_counts[c] == 0)
+        {
+            num_falsified_clauses++;
+        }
+    }
+
+    if (value == BoolValue::TRUE)
+    {
+        // The positive literals become TRUE for Clause::evaluate() and the negative ones FALSE
+        for (uint32_t o = occurrence_starts[satisfied]; o < occurrence_starts[satisfied + 1]; o++)
+        {
+            if (workspace.evaluated_counts[occurrences[o]]++ == 0)
+            {
+                addClauseActivity(occurrences[o], -1);
+            }
+        }
+        for (uint32_t o = occurrence_starts[falsified]; o < occurrence_starts[falsified + 1]; o++)
+        {
+            if (--workspace.evaluated_counts[occurrences[o]] == 0)
+            {
+                addClauseActivity(occurrences[o], 1);
+            }
+        }
+    }
+}
+
+/**
+<summary>
+Unassigns a variable and reverts the counters of the clauses it occurs in.
+</summary>
+<param name="variable">The 0-based variable.</param>
+*/
+void BacktrackSolver::unassignVariable(int variable)
+{
+    const std::vector<uint32_t> &starts = workspace.clause_starts;
+    const std::vector<uint32_t> &occurrence_starts = workspace.occurrence_starts;
+    const std::vector<uint32_t> &occurrences = workspace.occurrences;
+
+    // Undo assignVariable() in reverse order
+    int satisfied = 2 * variable + (current_assignment[variable] == BoolValue::FALSE ? 1 : 0);
+    int falsified = satisfied ^ 1;
+    if (current_assignment[variable] == BoolValue::TRUE)
+    {
+        for (uint32_t o = occurrence_starts[falsified]; o < occurrence_starts[falsified + 1]; o++)
+        {
+            if (workspace.evaluated_counts[occurrences[o]]++ == 0)
+            {
+                addClauseActivity(occurrences[o], -1);
+            }
+        }
+        for (uint32_t o = occurrence_starts[satisfied]; o < occurrence_starts[satisfied + 1]; o++)
+        {
+            if (--workspace.evaluated_counts[occurrences[o]] == 0)
+            {
+                addClauseActivity(occurrences[o], 1);
+            }
+        }
+    }
+    for (uint32_t o = occurrence_starts[falsified]; o < occurrence_starts[falsified + 1]; o++)
+    {
+        uint32_t c = occurrences[o];
+        if (workspace.false_counts[c]-- == static_cast<int>(starts[c + 1] - starts[c]) && workspace.true_counts[c] == 0)
+        {
+            num_falsified_clauses--;
+        }
+    }
+    for (uint32_t o = occurrence_starts[satisfied]; o < occurrence_starts[satisfied + 1]; o++)
+    {
+        num_satisfied_clauses -= (--workspace.true_counts[occurrences[o]] == 0);
+    }
+    current_assignment[variable] = BoolValue::UNASSIGNED;
+}
+
+/**
+<summary>
+Evaluates the formula and the blocking clauses under the current partial assignment.
+</summary>
+<returns>
+TRUE if every clause is satisfied, FALSE if some clause has all of its literals
+assigned false, otherwise UNASSIGNED.
+</returns>
+*/
+BoolValue BacktrackSolver::evaluateClauses()
+{
+    return clause_store.evaluate(current_assignment);
 }
 
 /**
@@ -245,9 +638,9 @@ across all clauses.
 */
 bool BacktrackSolver::pureLiteralElimination()
 {
-    // Create vectors to track the presence of positive and negative literals
-    std::vector<bool> positiveSeen(formula.getVariableCount(), false);
-    std::vector<bool> negativeSeen(formula.getVariableCount(), false);
+    // Track the presence of positive and negative literals in the workspace's buffers
+    std::vector<char> &positiveSeen = workspace.positive_seen;
+    std::vector<char> &negativeSeen = workspace.negative_seen;
 
     // Iterate through clauses and mark the presence of literals
     for (const Clause &clause : formula.getClauses())
@@ -266,33 +659,18 @@ bool BacktrackSolver::pureLiteralElimination()
         }
     }
 
-    // Create sets to store pure positive and pure negative literals
-    std::set<int> purePositives;
-    std::set<int> pureNegatives;
-
-    // Identify pure literals and insert them into the corresponding sets
+    // Assign TRUE to pure positive literals and FALSE to pure negative literals
     for (size_t i = 0; i < positiveSeen.size(); i++)
     {
         if (positiveSeen[i] && !negativeSeen[i])
         {
-            purePositives.insert(i + 1);
+            current_assignment[i] = BoolValue::TRUE;
         }
         else if (!positiveSeen[i] && negativeSeen[i])
         {
-            pureNegatives.insert(i + 1);
+            current_assignment[i] = BoolValue::FALSE;
         }
     }
 
-    // Assign TRUE to pure positive literals and FALSE to pure negative literals
-    for (int var : purePositives)
-    {
-        current_assignment[var - 1] = BoolValue::TRUE;
-    }
-
-    for (int var : pureNegatives)
-    {
-        current_assignment[var - 1] = BoolValue::FALSE;
-    }
-
     return true;
 }
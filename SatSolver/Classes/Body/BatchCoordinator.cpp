@@ -0,0 +1,436 @@
+/**
+<summary>
+The BatchCoordinator class scales a batch beyond one machine: it splits the
+formulas into tasks, hands them to worker processes over a socket, watches the
+workers' heartbeats and reassigns the tasks of workers that die.
+</summary>
+*/
+#include "BatchCoordinator.h"
+#include "FrameIO.h"
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+const int BatchCoordinator::MAX_CUBE_DEPTH;
+const int BatchCoordinator::MAX_ATTEMPTS;
+
+// Constructor for the BatchCoordinator class
+BatchCoordinator::BatchCoordinator(const std::string &address, const std::vector<BooleanFormula> &formulas, int chunk_size, int cube_depth,
+                                   const EngineOptions &engine)
+    : address(address), formulas(formulas), engine(engine), heartbeat_timeout(5000), connect_timeout(30000)
+{
+    chunk_size = std::max(1, chunk_size);
+    cube_depth = std::min(cube_depth, MAX_CUBE_DEPTH);
+    if (cube_depth > 0)
+    {
+        cubes.resize(formulas.size());
+        for (size_t i = 0; i < formulas.size(); i++)
+        {
+            addCubes(i, cube_depth);
+        }
+    }
+    else
+    {
+        for (size_t first = 0; first < formulas.size(); first += chunk_size)
+        {
+            WorkUnit unit;
+            unit.first_index = first;
+            unit.count = std::min<int>(chunk_size, formulas.size() - first);
+            units.push_back(unit);
+        }
+    }
+    for (size_t i = 0; i < units.size(); i++)
+    {
+        pending.push_back(i);
+    }
+}
+
+// Destructor for the BatchCoordinator class
+BatchCoordinator::~BatchCoordinator()
+{
+    for (Worker &worker : workers)
+    {
+        if (worker.alive)
+        {
+            ::close(worker.fd);
+        }
+    }
+    if (listen_fd >= 0)
+    {
+        ::close(listen_fd);
+        if (address.compare(0, 5, "unix:") == 0)
+        {
+            ::unlink(address.c_str() + 5);
+        }
+    }
+}
+
+/**
+<summary>
+Starts listening, so that workers may be launched before run() is called.
+</summary>
+*/
+void BatchCoordinator::listen()
+{
+    if (listen_fd < 0)
+    {
+        listen_fd = FrameIO::listenOn(address);
+    }
+}
+
+/**
+<summary>
+Distributes the tasks until every formula has a result, then tells the workers to quit.
+</summary>
+<param name="on_result">Called once per formula with its index and merged report.</param>
+<returns>True if every formula has a result, false if some were given up or no worker was connected for the connect timeout.</returns>
+<remarks>
+The connect timeout runs whenever no worker is connected, from the start and
+after the last one is dropped, so a batch whose workers never arrive or all die
+is handed back to the caller instead of waiting forever.
+</remarks>
+*/
+bool BatchCoordinator::run(const std::function<void(int, const SolveReport &)> &on_result)
+{
+    listen();
+
+    auto unattended_since = std::chrono::steady_clock::now();
+    while (formulas_reported < static_cast<int>(formulas.size()))
+    {
+        if (!workers.empty())
+        {
+            unattended_since = std::chrono::steady_clock::now();
+        }
+        else if (std::chrono::steady_clock::now() - unattended_since > connect_timeout)
+        {
+            std::cerr << "No worker connected for " << connect_timeout.count() / 1000.0 << " s" << std::endl;
+            return false;
+        }
+
+
+        // Hand pending tasks to idle workers
+        for (Worker &worker : workers)
+        {
+            while (worker.alive && worker.unit == -1 && !pending.empty())
+            {
+                int unit_id = pending.front();
+                pending.pop_front();
+                if (units[unit_id].done)
+                {
+                    continue;
+                }
+                worker.unit = unit_id;
+                if (!FrameIO::writeFrame(worker.fd, taskPayload(unit_id)))
+                {
+                    dropWorker(worker);
+                }
+            }
+        }
+
+        std::vector<pollfd> fds(1 + workers.size());
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            fds[i + 1].fd = workers[i].alive ? workers[i].fd : -1;
+            fds[i + 1].events = POLLIN;
+        }
+        ::poll(fds.data(), fds.size(), 200);
+
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0)
+            {
+                Worker worker;
+                worker.fd = fd;
+                worker.last_seen = std::chrono::steady_clock::now();
+                if (FrameIO::writeFrame(fd, "E" + engine.toText()))
+                {
+                    workers.push_back(worker);
+                }
+                else
+                {
+                    ::close(fd);
+                }
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i + 1 < fds.size(); i++)
+        {
+            Worker &worker = workers[i];
+            if (!worker.alive)
+            {
+                continue;
+            }
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                char chunk[65536];
+                ssize_t got = ::recv(worker.fd, chunk, sizeof(chunk), 0);
+                if (got <= 0)
+                {
+                    dropWorker(worker);
+                    continue;
+                }
+                worker.buffer.append(chunk, got);
+                worker.last_seen = now;
+
+                std::string payload;
+                try
+                {
+                    while (worker.alive && FrameIO::extractFrame(worker.buffer, payload))
+                    {
+                        handleMessage(worker, payload, on_result);
+                    }
+                }
+                catch (const std::exception &)
+                {
+                    dropWorker(worker);
+                }
+            }
+            else if (now - worker.last_seen > heartbeat_timeout)
+            {
+                std::cerr << "Worker " << worker.name << " missed its heartbeats" << std::endl;
+                dropWorker(worker);
+            }
+        }
+
+        workers.erase(std::remove_if(workers.begin(), workers.end(),
+                                     [](const Worker &worker)
+                                     { return !worker.alive; }),
+                      workers.end());
+    }
+
+    for (Worker &worker : workers)
+    {
+        FrameIO::writeFrame(worker.fd, "Q");
+    }
+    return formulas_abandoned == 0;
+}
+
+/**
+<summary>
+Builds the cubes of a formula over its most frequently occurring variables.
+</summary>
+<param name="index">The index of the formula.</param>
+<param name="depth">The number of variables to split on.</param>
+*/
+void BatchCoordinator::addCubes(int index, int depth)
+{
+    const BooleanFormula &formula = formulas[index];
+    std::vector<int> occurrences(formula.getVariableCount() + 1, 0);
+    for (const Clause &clause : formula.getClauses())
+    {
+        for (const Literal &lit : clause.getLiterals())
+        {
+            occurrences[lit.getVariable()]++;
+        }
+    }
+
+    std::vector<int> split_vars;
+    for (size_t var = 1; var < occurrences.size(); var++)
+    {
+        split_vars.push_back(var);
+    }
+    std::stable_sort(split_vars.begin(), split_vars.end(), [&](int a, int b)
+                     { return occurrences[a] > occurrences[b]; });
+    split_vars.resize(std::min<size_t>(depth, split_vars.size()));
+
+    int num_cubes = 1 << split_vars.size();
+    for (int mask = 0; mask < num_cubes; mask++)
+    {
+        WorkUnit unit;
+        unit.first_index = index;
+        unit.count = 1;
+        for (size_t bit = 0; bit < split_vars.size(); bit++)
+        {
+            unit.cube.push_back((mask >> bit) & 1 ? split_vars[bit] : -split_vars[bit]);
+        }
+        units.push_back(unit);
+    }
+    cubes[index].remaining = num_cubes;
+}
+
+/**
+<summary>
+Serializes a task for sending to a worker.
+</summary>
+<param name="unit_id">The task to serialize.</param>
+<returns>The task frame payload.</returns>
+*/
+std::string BatchCoordinator::taskPayload(int unit_id) const
+{
+    const WorkUnit &unit = units[unit_id];
+    std::string payload = "T";
+    FrameIO::appendUint32(payload, unit_id);
+
+    std::ostringstream text;
+    if (unit.cube.empty())
+    {
+        for (int i = unit.first_index; i < unit.first_index + unit.count; i++)
+        {
+            formulas[i].writeToStream(text, i + 1);
+        }
+    }
+    else
+    {
+        // A cube is the formula with its split literals added as unit clauses
+        BooleanFormula cube_formula = formulas[unit.first_index];
+        for (int lit : unit.cube)
+        {
+            cube_formula.addClause(Clause({Literal(std::abs(lit), lit > 0 ? BoolValue::TRUE : BoolValue::FALSE)}));
+        }
+        cube_formula.writeToStream(text, unit.first_index + 1);
+    }
+    return payload + text.str();
+}
+
+/**
+<summary>
+Handles one frame received from a worker.
+</summary>
+<param name="worker">The worker that sent the frame.</param>
+<param name="payload">The frame payload.</param>
+<param name="on_result">The result callback passed to run().</param>
+*/
+void BatchCoordinator::handleMessage(Worker &worker, const std::string &payload, const std::function<void(int, const SolveReport &)> &on_result)
+{
+    if (payload.empty())
+    {
+        return;
+    }
+    if (payload[0] == 'H')
+    {
+        worker.name = payload.substr(1);
+        std::cerr << "Worker " << worker.name << " connected" << std::endl;
+        return;
+    }
+    if (payload[0] != 'R')
+    {
+        return; // Heartbeats only refresh last_seen
+    }
+
+    size_t offset = 1;
+    uint32_t unit_id;
+    if (!FrameIO::readUint32(payload, offset, unit_id) || unit_id >= units.size())
+    {
+        return;
+    }
+    if (static_cast<int>(unit_id) == worker.unit)
+    {
+        worker.unit = -1;
+    }
+    WorkUnit &unit = units[unit_id];
+    if (unit.done)
+    {
+        return; // Late result of a task that was reassigned or made redundant
+    }
+
+    std::vector<SolveReport> reports;
+    std::istringstream rows(payload.substr(offset));
+    std::string row;
+    SolveReport report;
+    while (std::getline(rows, row) && SolveReport::fromRow(row, report))
+    {
+        reports.push_back(report);
+    }
+    if (static_cast<int>(reports.size()) != unit.count)
+    {
+        if (++unit.attempts < MAX_ATTEMPTS)
+        {
+            pending.push_front(unit_id);
+            return;
+        }
+        // Give the formulas up rather than handing the same task out forever
+        std::cerr << "Task " << unit_id << " returned malformed results " << unit.attempts << " times; giving it up" << std::endl;
+        if (unit.cube.empty())
+        {
+            unit.done = true;
+            formulas_reported += unit.count;
+            formulas_abandoned += unit.count;
+        }
+        else if (!cubes[unit.first_index].reported)
+        {
+            // One missing cube leaves the whole formula undecided
+            cubes[unit.first_index].reported = true;
+            for (WorkUnit &other : units)
+            {
+                if (other.first_index == unit.first_index)
+                {
+                    other.done = true;
+                }
+            }
+            formulas_reported++;
+            formulas_abandoned++;
+        }
+        return;
+    }
+    unit.done = true;
+
+    if (unit.cube.empty())
+    {
+        for (int i = 0; i < unit.count; i++)
+        {
+            on_result(unit.first_index + i, reports[i]);
+            formulas_reported++;
+        }
+        return;
+    }
+
+    // Merge cube results: the formula is satisfiable as soon as one cube is
+    CubeProgress &progress = cubes[unit.first_index];
+    if (progress.reported)
+    {
+        return;
+    }
+    progress.remaining--;
+    progress.merged.elapsed_us += reports[0].elapsed_us;
+    progress.merged.decisions += reports[0].decisions;
+    progress.merged.backtracks += reports[0].backtracks;
+    progress.merged.unit_propagations += reports[0].unit_propagations;
+    if (reports[0].satisfiable || progress.remaining == 0)
+    {
+        progress.merged.satisfiable = reports[0].satisfiable;
+        progress.merged.assignment = reports[0].satisfiable
+                                         ? reports[0].assignment
+                                         : std::vector<BoolValue>(formulas[unit.first_index].getVariableCount(), BoolValue::UNASSIGNED);
+        progress.reported = true;
+        for (WorkUnit &other : units)
+        {
+            if (other.first_index == unit.first_index)
+            {
+                other.done = true;
+            }
+        }
+        on_result(unit.first_index, progress.merged);
+        formulas_reported++;
+    }
+}
+
+/**
+<summary>
+Closes a worker's socket and queues its task again if it was not finished.
+</summary>
+<param name="worker">The worker to drop.</param>
+*/
+void BatchCoordinator::dropWorker(Worker &worker)
+{
+    if (!worker.alive)
+    {
+        return;
+    }
+    ::close(worker.fd);
+    worker.alive = false;
+    if (worker.unit != -1 && !units[worker.unit].done)
+    {
+        pending.push_front(worker.unit);
+        num_reassignments++;
+        std::cerr << "Reassigning task " << worker.unit << " of worker " << worker.name << std::endl;
+    }
+    worker.unit = -1;
+}
@@ -0,0 +1,125 @@
+#include "BatchWorker.h"
+#include "FrameIO.h"
+#include "BooleanFormula.h"
+#include "SolveReport.h"
+#include <sstream>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+
+// Constructor for the BatchWorker class
+BatchWorker::BatchWorker(const std::string &address)
+    : address(address)
+{
+}
+
+/**
+<summary>
+Connects to the coordinator and solves tasks until told to quit.
+</summary>
+<returns>True if the coordinator ended the session, false if it could not be reached or went away.</returns>
+<remarks>
+Connecting is retried for a few seconds so that workers may start before the coordinator.
+</remarks>
+*/
+bool BatchWorker::run()
+{
+    for (int attempt = 0; attempt < 50 && fd < 0; attempt++)
+    {
+        fd = FrameIO::connectTo(address);
+        if (fd < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    char hostname[256] = "";
+    ::gethostname(hostname, sizeof(hostname) - 1);
+    send("H" + std::string(hostname) + ":" + std::to_string(::getpid()));
+    std::thread heartbeat(&BatchWorker::heartbeatLoop, this);
+
+    bool finished = false;
+    EngineOptions engine;
+    std::string payload;
+    while (FrameIO::readFrame(fd, payload))
+    {
+        if (payload == "Q")
+        {
+            finished = true;
+            break;
+        }
+        if (!payload.empty() && payload[0] == 'E')
+        {
+            // Sent once before the first task; solving with other options would give different results
+            if (!EngineOptions::fromText(payload.substr(1), engine))
+            {
+                std::cerr << "Unreadable engine options from the coordinator" << std::endl;
+                break;
+            }
+            continue;
+        }
+
+        size_t offset = 1;
+        uint32_t unit_id;
+        if (payload[0] != 'T' || !FrameIO::readUint32(payload, offset, unit_id))
+        {
+            continue;
+        }
+
+        std::istringstream input(payload.substr(offset));
+        std::vector<BooleanFormula> formulas = BooleanFormula::loadFromStream(input);
+        std::string result = "R";
+        FrameIO::appendUint32(result, unit_id);
+        for (const BooleanFormula &formula : formulas)
+        {
+            result += SolveReport::solve(formula, engine).toRow() + "\n";
+        }
+        if (!send(result))
+        {
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mtx);
+        stopping = true;
+    }
+    stop_cv.notify_all();
+    heartbeat.join();
+    ::close(fd);
+    fd = -1;
+    return finished;
+}
+
+/**
+<summary>
+Sends a heartbeat frame every interval until the worker stops.
+</summary>
+*/
+void BatchWorker::heartbeatLoop()
+{
+    std::unique_lock<std::mutex> lock(stop_mtx);
+    while (!stop_cv.wait_for(lock, std::chrono::milliseconds(heartbeat_interval_ms), [this]
+                             { return stopping; }))
+    {
+        send("B");
+    }
+}
+
+/**
+<summary>
+Sends a frame to the coordinator.
+</summary>
+<param name="payload">The frame payload.</param>
+<returns>True if the frame was sent, otherwise false.</returns>
+*/
+bool BatchWorker::send(const std::string &payload)
+{
+    std::lock_guard<std::mutex> lock(write_mtx);
+    return FrameIO::writeFrame(fd, payload);
+}
@@ -1,8 +1,12 @@
 #include "BooleanFormula.h"
+#include "DecompressingStreamBuf.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cerrno>
 
 /**
 <summary>
@@ -15,6 +19,25 @@ void BooleanFormula::addClause(const Clause &clause)
     clauses.push_back(clause);
 }
 
+/**
+<summary>
+Adds a weighted clause, making the formula a weighted one.
+</summary>
+<param name="clause">The clause to be added.</param>
+<param name="weight">The cost of leaving the clause unsatisfied.</param>
+*/
+void BooleanFormula::addWeightedClause(const Clause &clause, unsigned long long weight)
+{
+    if (!weighted)
+    {
+        // Clauses added before the first weight count as weight 1
+        weights.assign(clauses.size(), 1);
+        weighted = true;
+    }
+    clauses.push_back(clause);
+    weights.push_back(weight);
+}
+
 /**
 <summary>
 Loads a collection of Boolean formulas from a file.
@@ -23,34 +46,86 @@ Loads a collection of Boolean formulas from a file.
 <returns>A vector of Boolean formulas read from the file.</returns>
 <remarks>
 The file format is expected to contain meta information lines starting with 'c',
-formula specification lines starting with 'p', and clauses.
+formula specification lines starting with 'p', and clauses. Files compressed
+with gzip, xz or zstd are decompressed while they are parsed.
 </remarks>
 */
 std::vector<BooleanFormula> BooleanFormula::loadFromFile(const std::string &filename)
 {
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open())
     {
         throw std::runtime_error("Failed to open the file");
     }
 
+    // Compressed files are recognised by their magic bytes, not their extension
+    unsigned char magic[6];
+    file.read(reinterpret_cast<char *>(magic), sizeof(magic));
+    const char *decompressor = DecompressingStreamBuf::detectDecompressor(magic, file.gcount());
+    if (decompressor != nullptr)
+    {
+        file.close();
+        DecompressingStreamBuf buffer(decompressor, filename);
+        std::istream input(&buffer);
+        std::vector<BooleanFormula> formulas = loadFromStream(input, true);
+        if (!buffer.close())
+        {
+            throw std::runtime_error(std::string("Failed to decompress the file with ") + decompressor);
+        }
+        return formulas;
+    }
+
+    file.clear();
+    file.seekg(0);
+    std::vector<BooleanFormula> formulas = loadFromStream(file, true);
+    file.close();
+    return formulas;
+}
+
+/**
+<summary>
+Loads a collection of Boolean formulas from an input stream.
+</summary>
+<param name="input">The stream to be read.</param>
+<param name="verbose">Whether every line, clause and literal read is echoed to the console.</param>
+<returns>A vector of Boolean formulas read from the stream.</returns>
+<remarks>
+Literals may be separated by commas or whitespace and a clause may span several
+lines, so plain DIMACS input is accepted as well. A 'p' line that is not
+preceded by a 'c' line starts a new formula with an unknown ('?') answer.
+After a "p wcnf VARS CLAUSES [TOP]" line every clause starts with its weight;
+clauses weighing at least TOP are hard. Throws std::runtime_error for a token
+that is not a number or a literal beyond Literal::MAX_VARIABLE.
+</remarks>
+*/
+std::vector<BooleanFormula> BooleanFormula::loadFromStream(std::istream &input, bool verbose)
+{
     std::vector<BooleanFormula> formulas;
     std::string line;
 
     BooleanFormula current_formula;
     bool reading_formula = false;
+    bool has_problem_line = false;
+    bool weighted = false;      // The current problem line is "p wcnf"
+    bool expect_weight = false; // The next number is the weight of a clause
+    unsigned long long weight = 0;
+    Clause clause;
 
-    while (std::getline(file, line))
+    while (std::getline(input, line))
     {
-        std::cout << "Reading line: " << line << std::endl;
+        if (verbose)
+        {
+            std::cout << "Reading line: " << line << std::endl;
+        }
 
         // Check if the line contains a comment (starts with 'c')
         if (line[0] == 'c')
         {
-            if (reading_formula)
+            if (reading_formula && has_problem_line)
             {
                 formulas.push_back(current_formula);
                 current_formula = BooleanFormula();
+                has_problem_line = false;
             }
 
             // Determine the delimiter used in the comment line
@@ -79,31 +154,84 @@ std::vector<BooleanFormula> BooleanFormula::loadFromFile(const std::string &file
         // Check if the line contains the formula specification (starts with 'p')
         if (line[0] == 'p')
         {
+            if (reading_formula && has_problem_line)
+            {
+                formulas.push_back(current_formula);
+                current_formula = BooleanFormula();
+            }
+            reading_formula = true;
+            has_problem_line = true;
+
+            std::string problem = line;
+            std::replace(problem.begin(), problem.end(), ',', ' ');
+            std::istringstream iss(problem);
+            std::string token, format;
+            unsigned long long top = 0, count;
+            iss >> token >> format >> count >> count;
+            weighted = (format == "wcnf");
+            expect_weight = weighted;
+            if (weighted && iss >> top)
+            {
+                current_formula.setHardWeight(top);
+            }
             continue;
         }
 
-        if (reading_formula)
+        // SATLIB files end with a '%' line
+        if (reading_formula && line[0] != '%')
         {
+            std::replace(line.begin(), line.end(), ',', ' ');
             std::istringstream iss(line);
-            std::string literal_str;
-            Clause clause;
-
-            while (std::getline(iss, literal_str, ','))
-            { // Using ',' as the delimiter
-                int literal_val = std::stoi(literal_str);
+            std::string token;
 
+            while (iss >> token)
+            {
+                // A token that is not a whole number would otherwise end the clause silently
+                char *end;
+                errno = 0;
+                if (expect_weight)
+                {
+                    weight = std::strtoull(token.c_str(), &end, 10);
+                    if (*end != '\0' || errno == ERANGE || token[0] == '-')
+                    {
+                        throw std::runtime_error("Malformed weight '" + token + "'");
+                    }
+                    expect_weight = false;
+                    continue;
+                }
+                long long number = std::strtoll(token.c_str(), &end, 10);
+                if (*end != '\0' || errno == ERANGE)
+                {
+                    throw std::runtime_error("Malformed literal '" + token + "'");
+                }
+                if (number < -Literal::MAX_VARIABLE || number > Literal::MAX_VARIABLE)
+                {
+                    throw std::runtime_error("Literal " + token + " is out of range");
+                }
+                int literal_val = static_cast<int>(number);
                 if (literal_val == 0)
                 {
-                    current_formula.addClause(clause);
-                    std::cout << "Added clause: ";
-                    for (const Literal &lit : clause.getLiterals())
+                    if (weighted)
                     {
-                        std::cout << (lit.getValue() == BoolValue::TRUE ? "" : "-") << lit.getVariable() << " ";
+                        current_formula.addWeightedClause(clause, weight);
+                        expect_weight = true;
+                    }
+                    else
+                    {
+                        current_formula.addClause(clause);
+                    }
+                    if (verbose)
+                    {
+                        std::cout << "Added clause: ";
+                        for (const Literal &lit : clause.getLiterals())
+                        {
+                            std::cout << (lit.getValue() == BoolValue::TRUE ? "" : "-") << lit.getVariable() << " ";
+                        }
+                        std::cout << std::endl;
                     }
-                    std::cout << std::endl;
 
                     clause.clear();
-                    break;
+                    continue;
                 }
 
                 BoolValue literal_bool = (literal_val > 0) ? BoolValue::TRUE : BoolValue::FALSE;
@@ -111,7 +239,10 @@ std::vector<BooleanFormula> BooleanFormula::loadFromFile(const std::string &file
                 Literal literal(variable, literal_bool);
 
                 // Debug print for each literal
-                std::cout << "Parsed Literal: " << (literal.getValue() == BoolValue::TRUE ? "" : "-") << literal.getVariable() << std::endl;
+                if (verbose)
+                {
+                    std::cout << "Parsed Literal: " << (literal.getValue() == BoolValue::TRUE ? "" : "-") << literal.getVariable() << std::endl;
+                }
 
                 clause.addLiteral(literal);
             }
@@ -123,10 +254,86 @@ std::vector<BooleanFormula> BooleanFormula::loadFromFile(const std::string &file
         formulas.push_back(current_formula);
     }
 
-    file.close();
     return formulas;
 }
 
+/**
+<summary>
+Builds a formula from a flat buffer of signed variable numbers.
+</summary>
+<param name="literals">The literals, each clause terminated by a zero.</param>
+<param name="count">The number of entries in the buffer.</param>
+<returns>The formula described by the buffer.</returns>
+<remarks>
+Trailing literals that are not terminated by a zero are ignored. Throws
+std::runtime_error for a literal beyond Literal::MAX_VARIABLE.
+</remarks>
+*/
+BooleanFormula BooleanFormula::fromLiterals(const int32_t *literals, size_t count)
+{
+    BooleanFormula formula;
+    Clause clause;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (literals[i] == 0)
+        {
+            formula.addClause(clause);
+            clause.clear();
+            continue;
+        }
+        if (literals[i] < -Literal::MAX_VARIABLE || literals[i] > Literal::MAX_VARIABLE)
+        {
+            throw std::runtime_error("Literal " + std::to_string(literals[i]) + " is out of range");
+        }
+        clause.addLiteral(Literal(std::abs(literals[i]), literals[i] > 0 ? BoolValue::TRUE : BoolValue::FALSE));
+    }
+    return formula;
+}
+
+/**
+<summary>
+Writes the formula in the comma-separated .cnf format read by loadFromStream.
+</summary>
+<param name="output">The stream to write to.</param>
+<param name="number">The formula number written on the 'c' line.</param>
+*/
+void BooleanFormula::writeToStream(std::ostream &output, int number) const
+{
+    int varCount = getVariableCount();
+    output << "c," << number << "," << varCount << "," << answer << "\n";
+    output << "p,cnf," << varCount << "," << clauses.size() << "\n";
+    for (const Clause &clause : clauses)
+    {
+        for (const Literal &lit : clause.getLiterals())
+        {
+            output << (lit.getValue() == BoolValue::TRUE ? "" : "-") << lit.getVariable() << ",";
+        }
+        output << "0\n";
+    }
+}
+
+/**
+<summary>
+Writes the formula in standard DIMACS, which loadFromStream also reads.
+</summary>
+<param name="output">The stream to write to.</param>
+<param name="number">The formula number written on the 'c' line.</param>
+*/
+void BooleanFormula::writeDimacs(std::ostream &output, int number) const
+{
+    int varCount = getVariableCount();
+    output << "c " << number << " " << varCount << " " << answer << "\n";
+    output << "p cnf " << varCount << " " << clauses.size() << "\n";
+    for (const Clause &clause : clauses)
+    {
+        for (const Literal &lit : clause.getLiterals())
+        {
+            output << (lit.getValue() == BoolValue::TRUE ? "" : "-") << lit.getVariable() << " ";
+        }
+        output << "0\n";
+    }
+}
+
 /**
 <summary>
 Retrieves the number of variables in the formula.
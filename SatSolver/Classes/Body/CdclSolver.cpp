@@ -0,0 +1,1742 @@
+/**
+<summary>
+The CdclSolver class implements conflict-driven clause learning, the engine
+behind the portfolio and every incremental feature built on assumptions.
+</summary>
+*/
+#include "CdclSolver.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+namespace
+{
+    // Converts a DIMACS literal to the internal encoding and back.
+    int toInternal(int lit) { return 2 * (std::abs(lit) - 1) + (lit < 0 ? 1 : 0); }
+    int toDimacs(int lit) { return (lit & 1) ? -((lit >> 1) + 1) : (lit >> 1) + 1; }
+
+    /**
+    <summary>
+    Computes an element of the Luby sequence 1, 1, 2, 1, 1, 2, 4, ...
+    </summary>
+    <param name="index">The 0-based position in the sequence.</param>
+    <returns>The element, a power of two.</returns>
+    */
+    double luby(int index)
+    {
+        int size = 1, sequence = 0;
+        while (size < index + 1)
+        {
+            sequence++;
+            size = 2 * size + 1;
+        }
+        while (size - 1 != index)
+        {
+            size = (size - 1) >> 1;
+            sequence--;
+            index = index % size;
+        }
+        return std::pow(2.0, sequence);
+    }
+}
+
+// Constructor for the CdclSolver class
+CdclSolver::CdclSolver(const BooleanFormula &formula)
+{
+    int formula_vars = formula.getVariableCount();
+    while (num_vars < formula_vars)
+    {
+        newVariable();
+    }
+    std::vector<int> literals;
+    for (const Clause &clause : formula.getClauses())
+    {
+        literals.clear();
+        for (const Literal &lit : clause.getLiterals())
+        {
+            literals.push_back(lit.getValue() == BoolValue::FALSE ? -lit.getVariable() : lit.getVariable());
+        }
+        if (!addClause(literals))
+        {
+            break;
+        }
+    }
+}
+
+/**
+<summary>
+Adds a fresh variable.
+</summary>
+<returns>The 1-based number of the new variable.</returns>
+*/
+int CdclSolver::newVariable()
+{
+    int var = num_vars++;
+    assigns.push_back(0);
+    level.push_back(0);
+    reason.push_back(-1);
+    activity.push_back(0);
+    saved_phase.push_back(default_phase);
+    seen.push_back(0);
+    heap_index.push_back(-1);
+    watches.resize(2 * num_vars);
+    implications.resize(2 * num_vars);
+    heapInsert(var);
+    return var + 1;
+}
+
+/**
+<summary>
+Sets the polarity tried first for variables that were never assigned.
+</summary>
+<param name="positive">True to try TRUE first, false to try FALSE first.</param>
+*/
+void CdclSolver::setDefaultPhase(bool positive)
+{
+    default_phase = positive ? 1 : -1;
+    std::fill(saved_phase.begin(), saved_phase.end(), default_phase);
+}
+
+/**
+<summary>
+Connects the solver to an exchange shared with solvers of the same formula.
+</summary>
+<param name="exchange">The exchange, or nullptr to stop sharing.</param>
+<param name="worker_id">The id of this solver among the sharers.</param>
+*/
+void CdclSolver::setClauseExchange(ClauseExchange *exchange, int worker_id)
+{
+    this->exchange = exchange;
+    this->worker_id = worker_id;
+    exchange_cursor = exchange != nullptr ? exchange->head() : 0;
+}
+
+/**
+<summary>
+Collects the learned clauses worth sharing in a buffer, for a caller that
+hands them to other solvers at points of its choosing, instead of an exchange.
+</summary>
+<param name="outbox">The buffer clauses are appended to, in internal encoding, or nullptr to stop collecting.</param>
+<param name="max_size">Clauses longer than this are not collected.</param>
+<param name="max_lbd">Clauses with a larger LBD are not collected.</param>
+*/
+void CdclSolver::setClauseOutbox(std::vector<std::vector<int>> *outbox, int max_size, int max_lbd)
+{
+    this->outbox = outbox;
+    outbox_max_size = max_size;
+    outbox_max_lbd = max_lbd;
+}
+
+/**
+<summary>
+Adds clauses collected from other solvers' outboxes, in order. Must be called between solves.
+</summary>
+<param name="shared">The clauses, in internal encoding; this solver's own are recognized and skipped.</param>
+<returns>False if the clauses are now known to be unsatisfiable, otherwise true.</returns>
+<remarks>
+After a solve stopped by its budget the clauses wait for the next restart, as
+those of an exchange do, so that the kept trail survives the import.
+</remarks>
+*/
+bool CdclSolver::importSharedClauses(const std::vector<std::vector<int>> &shared)
+{
+    if (!consistent)
+    {
+        return false;
+    }
+    if (decisionLevel() > 0)
+    {
+        for (const std::vector<int> &original : shared)
+        {
+            if (shared_hashes.count(ClauseExchange::hashClause(original.data(), static_cast<int>(original.size()))) == 0)
+            {
+                incoming.push_back(original);
+            }
+        }
+        return true;
+    }
+    std::vector<int> clause;
+    for (const std::vector<int> &original : shared)
+    {
+        clause = original;
+        if (importClause(clause) < 0)
+        {
+            consistent = false;
+            return false;
+        }
+    }
+    consistent = (propagate() == -1);
+    return consistent;
+}
+
+/**
+<summary>
+Adds a clause, creating any variables it mentions. Must be called between solves.
+</summary>
+<param name="literals">The DIMACS literals of the clause; zeros are ignored.</param>
+<returns>False if the clauses are now known to be unsatisfiable, otherwise true.</returns>
+*/
+bool CdclSolver::addClause(const std::vector<int> &literals)
+{
+    return addClause(literals.data(), literals.size());
+}
+
+/**
+<summary>
+Adds a clause read straight from a caller's buffer. Must be called between solves.
+</summary>
+<param name="literals">The DIMACS literals of the clause; zeros are ignored.</param>
+<param name="count">The number of literals.</param>
+<returns>False if the clauses are now known to be unsatisfiable, otherwise true.</returns>
+*/
+bool CdclSolver::addClause(const int32_t *literals, size_t count)
+{
+    if (!consistent)
+    {
+        return false;
+    }
+
+    cancelUntil(0);
+    std::vector<int> &clause = added;
+    clause.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        int lit = literals[i];
+        if (lit == 0)
+        {
+            continue;
+        }
+        while (std::abs(lit) > num_vars)
+        {
+            newVariable();
+        }
+        clause.push_back(toInternal(lit));
+    }
+
+    // Drop duplicates and literals fixed FALSE; satisfied clauses and tautologies are not needed
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+    size_t kept = 0;
+    for (size_t i = 0; i < clause.size(); i++)
+    {
+        if (value(clause[i]) == 1 || (i > 0 && clause[i] == (clause[i - 1] ^ 1)))
+        {
+            return true;
+        }
+        if (value(clause[i]) != -1)
+        {
+            clause[kept++] = clause[i];
+        }
+    }
+    clause.resize(kept);
+
+    if (clause.empty())
+    {
+        consistent = false;
+    }
+    else if (clause.size() == 1)
+    {
+        assign(clause[0], -1);
+        consistent = (propagate() == -1);
+    }
+    else
+    {
+        attachClause(clause, false, 0);
+    }
+    return consistent;
+}
+
+/**
+<summary>
+Attempts to solve the formula.
+</summary>
+<returns>True if a solution is found, otherwise false.</returns>
+*/
+bool CdclSolver::solve()
+{
+    return solveLimited() == BoolValue::TRUE;
+}
+
+/**
+<summary>
+Solves under assumptions, within the conflict budget and until interrupted.
+</summary>
+<param name="assumptions">DIMACS literals assumed true for this call only.</param>
+<returns>TRUE if satisfiable, FALSE if unsatisfiable under the assumptions, UNASSIGNED if stopped early.</returns>
+*/
+BoolValue CdclSolver::solveLimited(const std::vector<int> &assumptions)
+{
+    model.clear();
+    failed_assumptions.clear();
+    if (!consistent)
+    {
+        return BoolValue::FALSE;
+    }
+
+    std::vector<int> internal;
+    for (int lit : assumptions)
+    {
+        while (std::abs(lit) > num_vars)
+        {
+            newVariable();
+        }
+        internal.push_back(toInternal(lit));
+    }
+    if (internal != this->assumptions)
+    {
+        cancelUntil(0); // A kept trail only fits the assumptions it was built under
+        this->assumptions.swap(internal);
+    }
+    conflict_limit = conflict_budget < 0 ? 0 : num_conflicts + conflict_budget;
+    if (max_learned == 0)
+    {
+        max_learned = std::max(2000.0, (clauses.size() + ternaries.size()) / 3.0);
+    }
+
+    // A solve that follows one stopped early continues its restart schedule, within the same segment
+    if (!stopped_early)
+    {
+        restart_position = 0;
+        segment_conflicts = 0;
+    }
+    BoolValue status = BoolValue::UNASSIGNED;
+    while (status == BoolValue::UNASSIGNED && withinBudget())
+    {
+        int segment = static_cast<int>(luby(restart_position) * restart_interval);
+        status = search(segment);
+        if (status == BoolValue::UNASSIGNED && segment_conflicts >= segment)
+        {
+            restart_position++;
+            segment_conflicts = 0;
+            num_restarts++;
+            Tracer::instant("restart", num_restarts);
+        }
+    }
+    stopped_early = (status == BoolValue::UNASSIGNED);
+
+    if (status == BoolValue::TRUE)
+    {
+        model.resize(num_vars);
+        for (int var = 0; var < num_vars; var++)
+        {
+            model[var] = assigns[var] > 0 ? BoolValue::TRUE : assigns[var] < 0 ? BoolValue::FALSE : BoolValue::UNASSIGNED;
+        }
+    }
+    if (status != BoolValue::UNASSIGNED || interrupted.load(std::memory_order_relaxed))
+    {
+        cancelUntil(0);
+    }
+    return status;
+}
+
+/**
+<summary>
+Searches until a model, a refutation, the restart limit or the end of the budget.
+</summary>
+<param name="max_conflicts">The conflicts of the current Luby segment, counting those of earlier calls.</param>
+<returns>TRUE, FALSE, or UNASSIGNED to restart or when the budget runs out.</returns>
+<remarks>
+On a restart the trail is undone; when only the budget runs out it is kept,
+fully propagated, for the next call to continue from.
+</remarks>
+*/
+BoolValue CdclSolver::search(int max_conflicts)
+{
+    TraceScope trace("search");
+    if (decisionLevel() == 0 && inprocess_gap > 0 && num_conflicts >= next_inprocess)
+    {
+        TraceScope trace_inprocess("inprocess");
+        if (!inprocess())
+        {
+            consistent = false;
+            return BoolValue::FALSE;
+        }
+    }
+    bool import_pending = true;
+    std::vector<int> learned;
+
+    for (;;)
+    {
+        int conflict;
+        {
+            TraceScope trace_propagate("propagate");
+            conflict = propagate();
+        }
+        if (conflict != -1)
+        {
+            num_conflicts++;
+            segment_conflicts++;
+            if (decisionLevel() == 0)
+            {
+                consistent = false;
+                return BoolValue::FALSE;
+            }
+
+            int backtrack_level, lbd;
+            {
+                TraceScope trace_analyze("analyze");
+                analyze(conflict, learned, backtrack_level, lbd);
+            }
+            {
+                TraceScope trace_backtrack("backtrack", decisionLevel() - backtrack_level);
+                cancelUntil(backtrack_level);
+            }
+            if (learned.size() == 1)
+            {
+                assign(learned[0], -1);
+            }
+            else
+            {
+                int ref = attachClause(learned, true, lbd);
+                if ((ref & 3) != BINARY_CLAUSE)
+                {
+                    bumpClause(ref);
+                }
+                assign(learned[0], ref);
+            }
+            exportClause(learned, lbd);
+
+            var_increment /= 0.95;
+            clause_increment /= 0.999;
+            continue;
+        }
+
+        if (segment_conflicts >= max_conflicts)
+        {
+            cancelUntil(0);
+            return BoolValue::UNASSIGNED;
+        }
+        if (!withinBudget())
+        {
+            return BoolValue::UNASSIGNED;
+        }
+
+        if (decisionLevel() == 0 && import_pending)
+        {
+            import_pending = false;
+            int imported;
+            {
+                TraceScope trace_import("import");
+                imported = importClauses();
+            }
+            if (imported < 0)
+            {
+                consistent = false;
+                return BoolValue::FALSE;
+            }
+            if (imported > 0)
+            {
+                continue; // Propagate the imported units first
+            }
+        }
+
+        if (num_reducible >= max_learned + trail.size())
+        {
+            TraceScope trace_reduce("reduce");
+            reduceLearned();
+        }
+
+        int next = -1;
+        while (decisionLevel() < static_cast<int>(assumptions.size()))
+        {
+            int lit = assumptions[decisionLevel()];
+            if (value(lit) == 1)
+            {
+                trail_limits.push_back(trail.size()); // Already holds: open an empty level
+            }
+            else if (value(lit) == -1)
+            {
+                analyzeFinal(lit);
+                return BoolValue::FALSE;
+            }
+            else
+            {
+                next = lit;
+                break;
+            }
+        }
+
+        if (next == -1)
+        {
+            TraceScope trace_decide("decide");
+            next = pickBranchLiteral();
+            if (next == -1)
+            {
+                return BoolValue::TRUE;
+            }
+        }
+        num_decisions++;
+        trail_limits.push_back(trail.size());
+        assign(next, -1);
+    }
+}
+
+/**
+<summary>
+Stores a clause of at least two literals in the store of its width.
+</summary>
+<param name="literals">The internal literals.</param>
+<param name="learned">Whether the clause was learned.</param>
+<param name="lbd">The literal block distance of a learned clause.</param>
+<returns>The reference of the clause, usable as the reason of its first literal.</returns>
+*/
+int CdclSolver::attachClause(const std::vector<int> &literals, bool learned, int lbd)
+{
+    num_learned += learned;
+    if (literals.size() == 2)
+    {
+        implications[literals[0]].push_back(literals[1]);
+        implications[literals[1]].push_back(literals[0]);
+        return (literals[1] << 2) | BINARY_CLAUSE;
+    }
+
+    int ref;
+    num_reducible += learned;
+    if (literals.size() == 3)
+    {
+        TernaryClause clause = {{literals[0], literals[1], literals[2]}, 0, static_cast<uint8_t>(std::min(lbd, 255)), learned, false};
+        int index;
+        if (!free_ternaries.empty())
+        {
+            index = free_ternaries.back();
+            free_ternaries.pop_back();
+            ternaries[index] = clause;
+        }
+        else
+        {
+            index = static_cast<int>(ternaries.size());
+            ternaries.push_back(clause);
+        }
+        ref = (index << 2) | TERNARY_CLAUSE;
+    }
+    else
+    {
+        int index;
+        if (!free_clauses.empty())
+        {
+            index = free_clauses.back();
+            free_clauses.pop_back();
+        }
+        else
+        {
+            index = static_cast<int>(clauses.size());
+            clauses.push_back(ClauseRecord());
+        }
+
+        ClauseRecord &clause = clauses[index];
+        clause.literals = literals;
+        clause.learned = learned;
+        clause.deleted = false;
+        clause.vivified = false;
+        clause.lbd = lbd;
+        clause.activity = 0;
+        if (learned && inprocess_gap > 0)
+        {
+            recent_learned.push_back(index);
+        }
+        ref = (index << 2) | LONG_CLAUSE;
+    }
+
+    watches[literals[0]].push_back({ref, literals[1]});
+    watches[literals[1]].push_back({ref, literals[0]});
+    return ref;
+}
+
+/**
+<summary>
+Gets the literals of a referenced clause.
+</summary>
+<param name="ref">The clause reference.</param>
+<param name="first">For a binary clause, the literal to put first.</param>
+<param name="size">Receives the number of literals.</param>
+<returns>The literals; the view of a binary clause is valid until the next call.</returns>
+*/
+const int *CdclSolver::literalsOf(int ref, int first, int &size)
+{
+    switch (ref & 3)
+    {
+    case TERNARY_CLAUSE:
+        size = 3;
+        return ternaries[ref >> 2].literals;
+    case BINARY_CLAUSE:
+        binary_literals[0] = first;
+        binary_literals[1] = ref >> 2;
+        size = 2;
+        return binary_literals;
+    default:
+        size = static_cast<int>(clauses[ref >> 2].literals.size());
+        return clauses[ref >> 2].literals.data();
+    }
+}
+
+/**
+<summary>
+Assigns a literal TRUE at the current decision level.
+</summary>
+<param name="lit">The literal to assign.</param>
+<param name="from">The implying clause, or -1 for a decision.</param>
+*/
+void CdclSolver::assign(int lit, int from)
+{
+    int var = lit >> 1;
+    assigns[var] = (lit & 1) ? -1 : 1;
+    level[var] = decisionLevel();
+    reason[var] = from;
+    trail.push_back(lit);
+}
+
+/**
+<summary>
+Undoes every assignment above a decision level, saving the phases.
+</summary>
+<param name="target">The decision level to return to.</param>
+<param name="save_phases">Whether the undone values become the saved phases.</param>
+*/
+void CdclSolver::cancelUntil(int target, bool save_phases)
+{
+    if (decisionLevel() <= target)
+    {
+        return;
+    }
+    for (size_t i = trail.size(); i-- > static_cast<size_t>(trail_limits[target]);)
+    {
+        int var = trail[i] >> 1;
+        if (save_phases)
+        {
+            saved_phase[var] = assigns[var];
+        }
+        assigns[var] = 0;
+        reason[var] = -1;
+        if (heap_index[var] < 0)
+        {
+            heapInsert(var);
+        }
+    }
+    trail.resize(trail_limits[target]);
+    trail_limits.resize(target);
+    propagate_head = trail.size();
+}
+
+/**
+<summary>
+Propagates the assignments on the trail through the implication lists and watched literals.
+</summary>
+<returns>The reference of a falsified clause, or -1 if there is no conflict.</returns>
+*/
+int CdclSolver::propagate()
+{
+    int conflict = -1;
+    while (propagate_head < trail.size() && conflict == -1)
+    {
+        int false_lit = trail[propagate_head++] ^ 1;
+        num_propagations++;
+
+        // Binary clauses need no watch bookkeeping: every partner is implied
+        for (int other : implications[false_lit])
+        {
+            int other_value = value(other);
+            if (other_value == 0)
+            {
+                assign(other, (false_lit << 2) | BINARY_CLAUSE);
+            }
+            else if (other_value == -1)
+            {
+                conflict = (other << 2) | BINARY_CLAUSE;
+                conflict_literal = false_lit;
+                break;
+            }
+        }
+        if (conflict != -1)
+        {
+            break;
+        }
+
+        std::vector<Watcher> &list = watches[false_lit];
+        size_t kept = 0, i = 0;
+        while (i < list.size())
+        {
+            Watcher watcher = list[i++];
+            if (value(watcher.blocker) == 1)
+            {
+                list[kept++] = watcher;
+                continue;
+            }
+
+            WatchResult result;
+            if ((watcher.clause & 3) == TERNARY_CLAUSE)
+            {
+                result = visitWatch<3>(ternaries[watcher.clause >> 2].literals, 3, false_lit, watcher);
+            }
+            else
+            {
+                std::vector<int> &lits = clauses[watcher.clause >> 2].literals;
+                result = visitWatch<0>(lits.data(), static_cast<int>(lits.size()), false_lit, watcher);
+            }
+            if (result == WATCH_MOVED)
+            {
+                continue;
+            }
+
+            list[kept++] = watcher;
+            if (result == WATCH_UNIT)
+            {
+                assign(watcher.blocker, watcher.clause);
+            }
+            else if (result == WATCH_CONFLICT)
+            {
+                conflict = watcher.clause;
+                while (i < list.size())
+                {
+                    list[kept++] = list[i++];
+                }
+            }
+        }
+        list.resize(kept);
+    }
+    if (conflict != -1)
+    {
+        propagate_head = trail.size();
+    }
+    return conflict;
+}
+
+/**
+<summary>
+Visits one watcher of a falsified literal.
+</summary>
+<param name="literals">The clause literals.</param>
+<param name="size">The number of literals, used only when Width is 0.</param>
+<param name="false_lit">The falsified literal.</param>
+<param name="watcher">The watcher; its blocker is updated when the watcher stays.</param>
+<returns>The outcome; on WATCH_UNIT the blocker is the implied literal.</returns>
+<remarks>
+With a non-zero Width the search for a replacement watch has a constant trip
+count, which the compiler unrolls.
+</remarks>
+*/
+template <int Width>
+CdclSolver::WatchResult CdclSolver::visitWatch(int *literals, int size, int false_lit, Watcher &watcher)
+{
+    if (literals[0] == false_lit)
+    {
+        std::swap(literals[0], literals[1]);
+    }
+    int first = literals[0];
+    if (first != watcher.blocker && value(first) == 1)
+    {
+        watcher.blocker = first;
+        return WATCH_KEPT;
+    }
+
+    const int count = Width != 0 ? Width : size;
+    for (int k = 2; k < count; k++)
+    {
+        if (value(literals[k]) != -1)
+        {
+            std::swap(literals[1], literals[k]);
+            watches[literals[1]].push_back({watcher.clause, first});
+            return WATCH_MOVED;
+        }
+    }
+    watcher.blocker = first;
+    return value(first) == -1 ? WATCH_CONFLICT : WATCH_UNIT;
+}
+
+/**
+<summary>
+Derives the first-UIP clause of a conflict and minimizes it.
+</summary>
+<param name="conflict">The falsified clause.</param>
+<param name="learned">Receives the clause, asserting literal first.</param>
+<param name="backtrack_level">Receives the level to backjump to.</param>
+<param name="lbd">Receives the literal block distance of the clause.</param>
+*/
+void CdclSolver::analyze(int conflict, std::vector<int> &learned, int &backtrack_level, int &lbd)
+{
+    learned.clear();
+    learned.push_back(-1); // Room for the asserting literal
+    int open = 0;          // Literals of the current level still to resolve
+    int lit = -1;
+    size_t index = trail.size();
+
+    do
+    {
+        if (((conflict & 3) == LONG_CLAUSE && clauses[conflict >> 2].learned) ||
+            ((conflict & 3) == TERNARY_CLAUSE && ternaries[conflict >> 2].learned))
+        {
+            bumpClause(conflict);
+        }
+        int size;
+        const int *lits = literalsOf(conflict, lit == -1 ? conflict_literal : lit, size);
+        for (int j = (lit == -1) ? 0 : 1; j < size; j++)
+        {
+            int q = lits[j];
+            int var = q >> 1;
+            if (!seen[var] && level[var] > 0)
+            {
+                bumpVariable(var);
+                seen[var] = 1;
+                if (level[var] >= decisionLevel())
+                {
+                    open++;
+                }
+                else
+                {
+                    learned.push_back(q);
+                }
+            }
+        }
+
+        // Walk back to the next marked literal of the trail
+        while (!seen[trail[--index] >> 1])
+        {
+        }
+        lit = trail[index];
+        conflict = reason[lit >> 1];
+        seen[lit >> 1] = 0;
+        open--;
+    } while (open > 0);
+    learned[0] = lit ^ 1;
+
+    // Remove literals implied by the rest of the clause
+    analyze_clear = learned;
+    uint32_t levels = 0;
+    for (size_t i = 1; i < learned.size(); i++)
+    {
+        levels |= 1u << (level[learned[i] >> 1] & 31);
+    }
+    size_t kept = 1;
+    for (size_t i = 1; i < learned.size(); i++)
+    {
+        if (reason[learned[i] >> 1] == -1 || !isRedundant(learned[i], levels))
+        {
+            learned[kept++] = learned[i];
+        }
+    }
+    learned.resize(kept);
+    for (int cleared : analyze_clear)
+    {
+        seen[cleared >> 1] = 0;
+    }
+
+    // Put the literal of the highest remaining level second, to be watched
+    backtrack_level = 0;
+    if (learned.size() > 1)
+    {
+        size_t highest = 1;
+        for (size_t i = 2; i < learned.size(); i++)
+        {
+            if (level[learned[i] >> 1] > level[learned[highest] >> 1])
+            {
+                highest = i;
+            }
+        }
+        std::swap(learned[1], learned[highest]);
+        backtrack_level = level[learned[1] >> 1];
+    }
+
+    if (level_stamp.size() <= static_cast<size_t>(decisionLevel()))
+    {
+        level_stamp.resize(decisionLevel() + 1, 0);
+    }
+    stamp++;
+    lbd = 0;
+    for (int q : learned)
+    {
+        int lvl = level[q >> 1];
+        if (level_stamp[lvl] != stamp)
+        {
+            level_stamp[lvl] = stamp;
+            lbd++;
+        }
+    }
+}
+
+/**
+<summary>
+Checks whether a literal of a learned clause is implied by the others.
+</summary>
+<param name="lit">The literal to check.</param>
+<param name="levels">Bit set of the levels in the learned clause.</param>
+<returns>True if the literal can be removed.</returns>
+*/
+bool CdclSolver::isRedundant(int lit, uint32_t levels)
+{
+    analyze_stack.clear();
+    analyze_stack.push_back(lit);
+    size_t top = analyze_clear.size();
+    while (!analyze_stack.empty())
+    {
+        int implied = analyze_stack.back() ^ 1;
+        analyze_stack.pop_back();
+        int size;
+        const int *lits = literalsOf(reason[implied >> 1], implied, size);
+        for (int i = 1; i < size; i++)
+        {
+            int q = lits[i];
+            int var = q >> 1;
+            if (seen[var] || level[var] == 0)
+            {
+                continue;
+            }
+            if (reason[var] != -1 && (levels & (1u << (level[var] & 31))) != 0)
+            {
+                seen[var] = 1;
+                analyze_stack.push_back(q);
+                analyze_clear.push_back(q);
+            }
+            else
+            {
+                for (size_t j = top; j < analyze_clear.size(); j++)
+                {
+                    seen[analyze_clear[j] >> 1] = 0;
+                }
+                analyze_clear.resize(top);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Collects the assumptions that imply the negation of a failed assumption.
+</summary>
+<param name="lit">The assumption found FALSE.</param>
+*/
+void CdclSolver::analyzeFinal(int lit)
+{
+    failed_assumptions.push_back(toDimacs(lit));
+    if (decisionLevel() == 0 || level[lit >> 1] == 0)
+    {
+        return;
+    }
+
+    seen[lit >> 1] = 1;
+    for (size_t i = trail.size(); i-- > static_cast<size_t>(trail_limits[0]);)
+    {
+        int var = trail[i] >> 1;
+        if (!seen[var])
+        {
+            continue;
+        }
+        if (reason[var] == -1)
+        {
+            failed_assumptions.push_back(toDimacs(trail[i])); // Decisions below the assumptions are assumptions
+        }
+        else
+        {
+            int size;
+            const int *lits = literalsOf(reason[var], trail[i], size);
+            for (int j = 1; j < size; j++)
+            {
+                if (level[lits[j] >> 1] > 0)
+                {
+                    seen[lits[j] >> 1] = 1;
+                }
+            }
+        }
+        seen[var] = 0;
+    }
+    seen[lit >> 1] = 0;
+}
+
+/**
+<summary>
+Picks the next decision literal.
+</summary>
+<returns>The literal, or -1 if every variable is assigned.</returns>
+*/
+int CdclSolver::pickBranchLiteral()
+{
+    int var = -1;
+    if (random_decision_frequency > 0 && !heap.empty() && nextRandom() < random_decision_frequency)
+    {
+        var = heap[static_cast<size_t>(nextRandom() * heap.size())];
+    }
+    while (var == -1 || assigns[var] != 0)
+    {
+        if (heap.empty())
+        {
+            return -1;
+        }
+        var = heapRemoveMax();
+    }
+    return 2 * var + (saved_phase[var] > 0 ? 0 : 1);
+}
+
+/**
+<summary>
+Deletes the less useful half of the learned clauses.
+</summary>
+<remarks>
+Ternary and long clauses are ranked together by LBD, then activity. Glue
+clauses (LBD at most 2) and clauses that are the reason of a current
+assignment are always kept. Learned binary clauses are never deleted: they
+cost no watchers, and most of them are glue anyway.
+</remarks>
+*/
+void CdclSolver::reduceLearned()
+{
+    std::vector<int> candidates;
+    for (size_t t = 0; t < ternaries.size(); t++)
+    {
+        const TernaryClause &clause = ternaries[t];
+        if (!clause.learned || clause.deleted || clause.lbd <= 2)
+        {
+            continue;
+        }
+        int ref = static_cast<int>(t << 2) | TERNARY_CLAUSE;
+        int first = clause.literals[0];
+        if (value(first) == 1 && reason[first >> 1] == ref)
+        {
+            continue; // Locked
+        }
+        candidates.push_back(ref);
+    }
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        const ClauseRecord &clause = clauses[i];
+        if (!clause.learned || clause.deleted || clause.lbd <= 2)
+        {
+            continue;
+        }
+        int first = clause.literals[0];
+        if (value(first) == 1 && reason[first >> 1] == static_cast<int>(i << 2))
+        {
+            continue; // Locked
+        }
+        candidates.push_back(static_cast<int>(i << 2) | LONG_CLAUSE);
+    }
+    auto lbd_of = [this](int ref)
+    { return (ref & 3) == TERNARY_CLAUSE ? static_cast<int>(ternaries[ref >> 2].lbd) : clauses[ref >> 2].lbd; };
+    auto activity_of = [this](int ref)
+    { return (ref & 3) == TERNARY_CLAUSE ? static_cast<double>(ternaries[ref >> 2].activity) : clauses[ref >> 2].activity; };
+    std::sort(candidates.begin(), candidates.end(), [&](int a, int b)
+              {
+                  if (lbd_of(a) != lbd_of(b))
+                  {
+                      return lbd_of(a) > lbd_of(b);
+                  }
+                  if (activity_of(a) != activity_of(b))
+                  {
+                      return activity_of(a) < activity_of(b);
+                  }
+                  return a < b; });
+
+    size_t removed = candidates.size() / 2;
+    for (size_t i = 0; i < removed; i++)
+    {
+        int ref = candidates[i];
+        if ((ref & 3) == TERNARY_CLAUSE)
+        {
+            ternaries[ref >> 2].deleted = true;
+        }
+        else
+        {
+            clauses[ref >> 2].deleted = true;
+        }
+    }
+    for (std::vector<Watcher> &list : watches)
+    {
+        list.erase(std::remove_if(list.begin(), list.end(), [this](const Watcher &watcher)
+                                  { return (watcher.clause & 3) == TERNARY_CLAUSE ? ternaries[watcher.clause >> 2].deleted
+                                                                                  : clauses[watcher.clause >> 2].deleted; }),
+                   list.end());
+    }
+    for (size_t i = 0; i < removed; i++)
+    {
+        int ref = candidates[i];
+        if ((ref & 3) == TERNARY_CLAUSE)
+        {
+            ternaries[ref >> 2].learned = false;
+            free_ternaries.push_back(ref >> 2);
+            continue;
+        }
+        ClauseRecord &clause = clauses[ref >> 2];
+        std::vector<int>().swap(clause.literals);
+        clause.learned = false;
+        free_clauses.push_back(ref >> 2);
+    }
+    num_learned -= removed;
+    num_reducible -= removed;
+    max_learned *= 1.1;
+}
+
+/**
+<summary>
+Runs one inprocessing pass. Called at level 0.
+</summary>
+<returns>False if the clauses were found unsatisfiable, otherwise true.</returns>
+<remarks>
+The budget is a tenth of the propagations the search made since the last pass,
+so inprocessing costs a bounded share of the solve however long it runs.
+</remarks>
+*/
+bool CdclSolver::inprocess()
+{
+    num_inprocessings++;
+    Tracer::instant("inprocess", num_inprocessings);
+    if (propagate() != -1)
+    {
+        return false;
+    }
+    unsigned long long budget = std::max(20000ull, (num_propagations - inprocess_propagations) / 10);
+    unsigned long long ticks = 0;
+
+    removeSatisfied();
+    subsumeLearned(ticks, budget);
+    bool result = vivify(ticks, budget);
+    collectDeleted();
+
+    next_inprocess = num_conflicts + static_cast<unsigned long long>(inprocess_gap);
+    inprocess_gap *= 1.5;
+    inprocess_propagations = num_propagations;
+    return result;
+}
+
+/**
+<summary>
+Removes the clauses satisfied by the level-0 assignments and strips their falsified literals from the rest.
+</summary>
+<remarks>
+After propagation at level 0, a clause with a FALSE watched literal is
+satisfied, so stripping never touches the watches of the clauses kept. Clauses
+that shrink to three or two literals move to the store of their width.
+</remarks>
+*/
+void CdclSolver::removeSatisfied()
+{
+    if (root_cleaned == trail.size())
+    {
+        return; // No new level-0 assignments
+    }
+
+    // Binary clauses of a fixed variable are satisfied either way
+    for (size_t i = root_cleaned; i < trail.size(); i++)
+    {
+        for (int lit : {trail[i], trail[i] ^ 1})
+        {
+            for (int partner : implications[lit])
+            {
+                std::vector<int> &list = implications[partner];
+                list.erase(std::remove(list.begin(), list.end(), lit), list.end());
+            }
+            std::vector<int>().swap(implications[lit]);
+        }
+    }
+    root_cleaned = trail.size();
+
+    std::vector<int> kept;
+    for (size_t t = 0; t < ternaries.size(); t++)
+    {
+        if (ternaries[t].deleted)
+        {
+            continue;
+        }
+        bool satisfied = false;
+        kept.clear();
+        for (int lit : ternaries[t].literals)
+        {
+            satisfied |= (value(lit) == 1);
+            if (value(lit) == 0)
+            {
+                kept.push_back(lit);
+            }
+        }
+        if (satisfied || kept.size() < 3)
+        {
+            bool learned = ternaries[t].learned;
+            deleteTernary(static_cast<int>(t));
+            num_satisfied_removed += satisfied;
+            if (!satisfied)
+            {
+                attachClause(kept, learned, 1);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        if (clauses[i].deleted || clauses[i].literals.empty())
+        {
+            continue;
+        }
+        bool satisfied = false;
+        kept.clear();
+        for (int lit : clauses[i].literals)
+        {
+            satisfied |= (value(lit) == 1);
+            if (value(lit) == 0)
+            {
+                kept.push_back(lit);
+            }
+        }
+        if (satisfied)
+        {
+            num_satisfied_removed++;
+            deleteClause(static_cast<int>(i));
+        }
+        else if (kept.size() < clauses[i].literals.size())
+        {
+            if (kept.size() <= 3)
+            {
+                bool learned = clauses[i].learned;
+                int lbd = std::min(clauses[i].lbd, static_cast<int>(kept.size()) - 1);
+                deleteClause(static_cast<int>(i));
+                attachClause(kept, learned, lbd);
+            }
+            else
+            {
+                clauses[i].literals = kept; // The watched pair leads and is unassigned, so it stays in front
+            }
+        }
+    }
+}
+
+/**
+<summary>
+Removes the clauses a newly learned clause subsumes, and new clauses a binary clause subsumes.
+</summary>
+<param name="ticks">The work done so far, in literal visits; increased.</param>
+<param name="budget">The work allowed.</param>
+<remarks>
+An original clause subsumed by a learned one makes the learned clause
+irredundant, so it is no longer eligible for deletion.
+</remarks>
+*/
+void CdclSolver::subsumeLearned(unsigned long long &ticks, unsigned long long budget)
+{
+    if (recent_learned.empty())
+    {
+        return;
+    }
+    occurrences.assign(2 * num_vars, std::vector<int>());
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        if (!clauses[i].deleted && !clauses[i].literals.empty())
+        {
+            for (int lit : clauses[i].literals)
+            {
+                occurrences[lit].push_back(static_cast<int>(i));
+            }
+            ticks += clauses[i].literals.size();
+        }
+    }
+    literal_marks.resize(2 * num_vars, 0);
+
+    std::sort(recent_learned.begin(), recent_learned.end());
+    recent_learned.erase(std::unique(recent_learned.begin(), recent_learned.end()), recent_learned.end());
+    for (int index : recent_learned)
+    {
+        if (ticks >= budget)
+        {
+            break;
+        }
+        if (clauses[index].deleted || clauses[index].literals.empty())
+        {
+            continue;
+        }
+        const std::vector<int> subsumer = clauses[index].literals;
+        for (int lit : subsumer)
+        {
+            literal_marks[lit] = 1;
+        }
+
+        bool subsumed = false;
+        for (size_t a = 0; a < subsumer.size() && !subsumed; a++)
+        {
+            for (int partner : implications[subsumer[a]])
+            {
+                subsumed |= (literal_marks[partner] != 0);
+            }
+            ticks += implications[subsumer[a]].size();
+        }
+
+        if (subsumed)
+        {
+            num_subsumed++;
+            deleteClause(index);
+        }
+        else
+        {
+            int rarest = subsumer[0];
+            for (int lit : subsumer)
+            {
+                rarest = occurrences[lit].size() < occurrences[rarest].size() ? lit : rarest;
+            }
+            for (int other : occurrences[rarest])
+            {
+                ClauseRecord &candidate = clauses[other];
+                if (other == index || candidate.deleted || candidate.literals.size() < subsumer.size())
+                {
+                    continue;
+                }
+                size_t matched = 0;
+                for (int lit : candidate.literals)
+                {
+                    matched += literal_marks[lit];
+                }
+                ticks += candidate.literals.size();
+                if (matched == subsumer.size())
+                {
+                    if (!candidate.learned && clauses[index].learned)
+                    {
+                        clauses[index].learned = false;
+                        num_reducible--;
+                    }
+                    num_subsumed++;
+                    deleteClause(other);
+                }
+            }
+        }
+
+        for (int lit : subsumer)
+        {
+            literal_marks[lit] = 0;
+        }
+    }
+    recent_learned.clear();
+    std::vector<std::vector<int>>().swap(occurrences);
+}
+
+/**
+<summary>
+Shortens clauses by assigning the negations of their literals in turn:
+literals found FALSE are dropped, and a conflict or a literal found TRUE ends the clause there.
+</summary>
+<param name="ticks">The work done so far, in literal visits; increased by the propagations.</param>
+<param name="budget">The work allowed.</param>
+<returns>False if a shortened unit clause is falsified, otherwise true.</returns>
+<remarks>
+A literal already TRUE at level 0 means the clause is satisfied and is removed.
+The clause itself may take part in the propagation; whatever is derived is
+still implied by the formula, and the shortened clause subsumes the original.
+Learned clauses go first, lowest LBD first, then the original ones. Each
+clause is tried once. Phases are not saved while vivifying.
+</remarks>
+*/
+bool CdclSolver::vivify(unsigned long long &ticks, unsigned long long budget)
+{
+    std::vector<int> candidates;
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        if (!clauses[i].deleted && !clauses[i].vivified && !clauses[i].literals.empty())
+        {
+            candidates.push_back(static_cast<int>(i));
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [this](int a, int b)
+                     {
+                         if (clauses[a].learned != clauses[b].learned)
+                         {
+                             return clauses[a].learned;
+                         }
+                         return clauses[a].learned && clauses[a].lbd < clauses[b].lbd; });
+
+    std::vector<int> literals, shortened;
+    for (int index : candidates)
+    {
+        if (ticks >= budget)
+        {
+            break;
+        }
+        if (clauses[index].deleted)
+        {
+            continue;
+        }
+        clauses[index].vivified = true;
+        literals = clauses[index].literals;
+
+        unsigned long long start = num_propagations;
+        shortened.clear();
+        bool satisfied = false;
+        for (int lit : literals)
+        {
+            int lit_value = value(lit);
+            if (lit_value == 1)
+            {
+                satisfied = (level[lit >> 1] == 0);
+                shortened.push_back(lit);
+                break;
+            }
+            if (lit_value == -1)
+            {
+                continue;
+            }
+            shortened.push_back(lit);
+            trail_limits.push_back(trail.size());
+            assign(lit ^ 1, -1);
+            if (propagate() != -1)
+            {
+                break;
+            }
+        }
+        cancelUntil(0, false);
+        ticks += num_propagations - start + literals.size();
+
+        if (satisfied)
+        {
+            num_satisfied_removed++;
+            deleteClause(index);
+            continue;
+        }
+        if (shortened.size() >= literals.size())
+        {
+            continue;
+        }
+
+        num_vivified++;
+        bool learned = clauses[index].learned;
+        int lbd = std::min(clauses[index].lbd, static_cast<int>(shortened.size()) - 1);
+        deleteClause(index);
+        if (shortened.size() == 1)
+        {
+            assign(shortened[0], -1);
+            if (propagate() != -1)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            attachClause(shortened, learned, lbd);
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Marks a long clause deleted; its watchers go at the end of the pass.
+</summary>
+<param name="index">The index of the clause in the store.</param>
+*/
+void CdclSolver::deleteClause(int index)
+{
+    ClauseRecord &clause = clauses[index];
+    clause.deleted = true;
+    if (clause.learned)
+    {
+        num_learned--;
+        num_reducible--;
+    }
+    pending_free.push_back(index);
+}
+
+/**
+<summary>
+Marks a ternary clause deleted; its watchers go at the end of the pass.
+</summary>
+<param name="index">The index of the clause in the ternary store.</param>
+*/
+void CdclSolver::deleteTernary(int index)
+{
+    TernaryClause &clause = ternaries[index];
+    clause.deleted = true;
+    if (clause.learned)
+    {
+        num_learned--;
+        num_reducible--;
+    }
+    pending_free_ternaries.push_back(index);
+}
+
+/**
+<summary>
+Drops the watchers of deleted clauses and frees their slots.
+</summary>
+*/
+void CdclSolver::collectDeleted()
+{
+    for (std::vector<Watcher> &list : watches)
+    {
+        list.erase(std::remove_if(list.begin(), list.end(), [this](const Watcher &watcher)
+                                  {
+                                      int index = watcher.clause >> 2;
+                                      switch (watcher.clause & 3)
+                                      {
+                                      case LONG_CLAUSE:
+                                          return clauses[index].deleted;
+                                      case TERNARY_CLAUSE:
+                                          return ternaries[index].deleted;
+                                      default:
+                                          return false;
+                                      } }),
+                   list.end());
+    }
+    for (int index : pending_free)
+    {
+        ClauseRecord &clause = clauses[index];
+        std::vector<int>().swap(clause.literals);
+        clause.learned = false;
+        free_clauses.push_back(index);
+    }
+    pending_free.clear();
+    for (int index : pending_free_ternaries)
+    {
+        ternaries[index].learned = false;
+        free_ternaries.push_back(index);
+    }
+    pending_free_ternaries.clear();
+}
+
+/**
+<summary>
+Publishes a learned clause to the exchange if it passes the filters.
+</summary>
+<param name="learned">The clause.</param>
+<param name="lbd">Its literal block distance.</param>
+*/
+void CdclSolver::exportClause(const std::vector<int> &learned, int lbd)
+{
+    int size = static_cast<int>(learned.size());
+    if (outbox != nullptr)
+    {
+        if (size <= outbox_max_size && lbd <= outbox_max_lbd &&
+            shared_hashes.insert(ClauseExchange::hashClause(learned.data(), size)).second)
+        {
+            outbox->push_back(learned);
+            num_exported++;
+        }
+        return;
+    }
+    if (exchange == nullptr || !exchange->accepts(size, lbd))
+    {
+        return;
+    }
+    if (shared_hashes.insert(ClauseExchange::hashClause(learned.data(), size)).second &&
+        exchange->publish(worker_id, learned.data(), size, lbd))
+    {
+        num_exported++;
+    }
+}
+
+/**
+<summary>
+Adds the clauses other solvers published since the last import, and those
+importSharedClauses() held back. Called at level 0.
+</summary>
+<returns>-1 if an imported clause is falsified, 1 if units were assigned, otherwise 0.</returns>
+*/
+int CdclSolver::importClauses()
+{
+    if (exchange != nullptr)
+    {
+        exchange->collect(worker_id, exchange_cursor, incoming);
+    }
+
+    int result = 0;
+    for (std::vector<int> &clause : incoming)
+    {
+        int imported = importClause(clause);
+        if (imported < 0)
+        {
+            incoming.clear();
+            return -1;
+        }
+        result = std::max(result, imported);
+    }
+    incoming.clear();
+    return result;
+}
+
+/**
+<summary>
+Adds one clause learned by another solver. Called at level 0.
+</summary>
+<param name="clause">The clause in internal encoding; simplified in place.</param>
+<returns>-1 if it is falsified, 1 if it assigned a unit, otherwise 0.</returns>
+*/
+int CdclSolver::importClause(std::vector<int> &clause)
+{
+    int size = static_cast<int>(clause.size());
+    if (!shared_hashes.insert(ClauseExchange::hashClause(clause.data(), size)).second)
+    {
+        return 0; // Seen before, from this or another worker
+    }
+
+    bool satisfied = false;
+    size_t kept = 0;
+    for (int lit : clause)
+    {
+        if (lit < 0 || (lit >> 1) >= num_vars)
+        {
+            satisfied = true; // Not a clause over our variables; ignore it
+            break;
+        }
+        satisfied |= (value(lit) == 1);
+        if (value(lit) == 0)
+        {
+            clause[kept++] = lit;
+        }
+    }
+    if (satisfied)
+    {
+        return 0;
+    }
+    clause.resize(kept);
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+
+    num_imported++;
+    if (clause.empty())
+    {
+        return -1;
+    }
+    if (clause.size() == 1)
+    {
+        assign(clause[0], -1);
+        return 1;
+    }
+    attachClause(clause, true, static_cast<int>(clause.size()) - 1);
+    return 0;
+}
+
+/**
+<summary>
+Checks whether the solve must stop on the budget or an interrupt.
+</summary>
+<returns>True if the solve may continue.</returns>
+*/
+bool CdclSolver::withinBudget() const
+{
+    return !interrupted.load(std::memory_order_relaxed) &&
+           (conflict_budget < 0 || num_conflicts < conflict_limit);
+}
+
+/**
+<summary>
+Raises the activity of a variable met in a conflict.
+</summary>
+<param name="var">The 0-based variable.</param>
+*/
+void CdclSolver::bumpVariable(int var)
+{
+    activity[var] += var_increment;
+    if (activity[var] > 1e100)
+    {
+        for (double &a : activity)
+        {
+            a *= 1e-100;
+        }
+        var_increment *= 1e-100;
+    }
+    if (heap_index[var] >= 0)
+    {
+        heapUp(heap_index[var]);
+    }
+}
+
+/**
+<summary>
+Raises the activity of a learned clause used in a conflict.
+</summary>
+<param name="ref">The reference of a ternary or long clause.</param>
+*/
+void CdclSolver::bumpClause(int ref)
+{
+    double activity;
+    if ((ref & 3) == TERNARY_CLAUSE)
+    {
+        activity = ternaries[ref >> 2].activity += static_cast<float>(clause_increment);
+    }
+    else
+    {
+        activity = clauses[ref >> 2].activity += clause_increment;
+    }
+    if (activity > 1e20)
+    {
+        for (ClauseRecord &other : clauses)
+        {
+            other.activity *= 1e-20;
+        }
+        for (TernaryClause &other : ternaries)
+        {
+            other.activity *= 1e-20f;
+        }
+        clause_increment *= 1e-20;
+    }
+}
+
+/**
+<summary>
+Draws from the xorshift generator behind random decisions.
+</summary>
+<returns>A number in [0, 1).</returns>
+*/
+double CdclSolver::nextRandom()
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return (random_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void CdclSolver::heapInsert(int var)
+{
+    heap_index[var] = static_cast<int>(heap.size());
+    heap.push_back(var);
+    heapUp(heap_index[var]);
+}
+
+int CdclSolver::heapRemoveMax()
+{
+    int top = heap[0];
+    heap[0] = heap.back();
+    heap_index[heap[0]] = 0;
+    heap_index[top] = -1;
+    heap.pop_back();
+    if (!heap.empty())
+    {
+        heapDown(0);
+    }
+    return top;
+}
+
+void CdclSolver::heapUp(int position)
+{
+    int var = heap[position];
+    while (position > 0)
+    {
+        int parent = (position - 1) >> 1;
+        if (activity[heap[parent]] >= activity[var])
+        {
+            break;
+        }
+        heap[position] = heap[parent];
+        heap_index[heap[position]] = position;
+        position = parent;
+    }
+    heap[position] = var;
+    heap_index[var] = position;
+}
+
+void CdclSolver::heapDown(int position)
+{
+    int var = heap[position];
+    int size = static_cast<int>(heap.size());
+    for (;;)
+    {
+        int child = 2 * position + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && activity[heap[child + 1]] > activity[heap[child]])
+        {
+            child++;
+        }
+        if (activity[heap[child]] <= activity[var])
+        {
+            break;
+        }
+        heap[position] = heap[child];
+        heap_index[heap[position]] = position;
+        position = child;
+    }
+    heap[position] = var;
+    heap_index[var] = position;
+}
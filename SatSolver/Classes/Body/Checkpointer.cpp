@@ -0,0 +1,370 @@
+#include "Checkpointer.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    const char MAGIC[8] = {'S', 'A', 'T', 'C', 'K', 'P', 'T', '1'};
+
+    // The fixed part of a record payload: kept depth, decision count and three counters
+    const size_t RECORD_FIXED_SIZE = 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+    uint32_t checksum(const char *data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void append(std::string &buffer, T value)
+    {
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool take(const std::string &buffer, size_t &offset, T &value)
+    {
+        if (buffer.size() - offset < sizeof(value))
+        {
+            return false;
+        }
+        std::memcpy(&value, buffer.data() + offset, sizeof(value));
+        offset += sizeof(value);
+        return true;
+    }
+
+    // Frames a record as length, checksum and payload
+    std::string encodeRecord(size_t kept, const SearchDecision *decisions, size_t count, const CheckpointState &counters)
+    {
+        std::string payload;
+        payload.reserve(RECORD_FIXED_SIZE + count * sizeof(int32_t));
+        append<uint32_t>(payload, static_cast<uint32_t>(kept));
+        append<uint32_t>(payload, static_cast<uint32_t>(count));
+        append<uint64_t>(payload, counters.num_decisions);
+        append<uint64_t>(payload, counters.num_backtracks);
+        append<uint64_t>(payload, counters.num_unit_propagations);
+        for (size_t i = 0; i < count; i++)
+        {
+            int32_t var = decisions[i].variable + 1;
+            append<int32_t>(payload, decisions[i].value == BoolValue::TRUE ? var : -var);
+        }
+
+        std::string record;
+        record.reserve(2 * sizeof(uint32_t) + payload.size());
+        append<uint32_t>(record, static_cast<uint32_t>(payload.size()));
+        append<uint32_t>(record, checksum(payload.data(), payload.size()));
+        record += payload;
+        return record;
+    }
+
+    bool writeFully(int fd, const std::string &data)
+    {
+        const char *ptr = data.data();
+        size_t size = data.size();
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, ptr, size);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                return false;
+            }
+            ptr += written;
+            size -= written;
+        }
+        return true;
+    }
+}
+
+// Constructor for the Checkpointer class
+Checkpointer::Checkpointer(const std::string &path, uint64_t formula_hash, std::chrono::milliseconds interval, const CheckpointState &initial)
+    : path(path), formula_hash(formula_hash), interval(interval),
+      next_due(std::chrono::steady_clock::now() + interval), stack(initial.decisions)
+{
+    // The resumed state is on disk before the search moves past it
+    rewrite(initial);
+    if (fd < 0)
+    {
+        std::cerr << "Cannot write checkpoint file " << path << ": " << std::strerror(errno) << std::endl;
+    }
+    writer = std::thread(&Checkpointer::writerLoop, this);
+}
+
+// Destructor for the Checkpointer class
+Checkpointer::~Checkpointer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+/**
+<summary>
+Hands a snapshot to the writer thread without waiting for it to be written.
+</summary>
+<param name="kept_depth">The number of leading decisions unchanged since the previous snapshot.</param>
+<param name="decisions">The full decision stack of the search.</param>
+<param name="state">The counters of the search; its decisions are ignored.</param>
+*/
+void Checkpointer::submit(size_t kept_depth, const std::vector<SearchDecision> &decisions, const CheckpointState &state)
+{
+    next_due = std::chrono::steady_clock::now() + interval;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!has_pending || kept_depth < pending_kept)
+        {
+            pending_kept = kept_depth;
+            pending_suffix.clear();
+        }
+        else
+        {
+            // Still unwritten: keep the pending decisions that survived and replace the rest
+            pending_suffix.resize(kept_depth - pending_kept);
+        }
+        pending_suffix.insert(pending_suffix.end(), decisions.begin() + kept_depth, decisions.end());
+        pending_counters.num_decisions = state.num_decisions;
+        pending_counters.num_backtracks = state.num_backtracks;
+        pending_counters.num_unit_propagations = state.num_unit_propagations;
+        has_pending = true;
+    }
+    wake.notify_one();
+}
+
+/**
+<summary>
+Stops taking snapshots and deletes the file, for a search that ran to completion.
+</summary>
+*/
+void Checkpointer::discard()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        has_pending = false;
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+    std::remove(path.c_str());
+}
+
+/**
+<summary>
+Writes pending snapshots until the checkpointer is stopped.
+</summary>
+*/
+void Checkpointer::writerLoop()
+{
+    std::vector<SearchDecision> suffix;
+    CheckpointState counters;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true)
+    {
+        wake.wait(lock, [this]
+                  { return has_pending || stopping; });
+        if (!has_pending)
+        {
+            return;
+        }
+        size_t kept = pending_kept;
+        suffix.swap(pending_suffix);
+        counters = pending_counters;
+        has_pending = false;
+
+        // The search keeps running while the record is written
+        lock.unlock();
+        writeRecord(kept, suffix, counters);
+        lock.lock();
+    }
+}
+
+/**
+<summary>
+Appends one record to the journal, or rewrites the whole file if the journal has grown too long.
+</summary>
+<param name="kept">The number of leading decisions kept from the previous record.</param>
+<param name="suffix">The decisions after the kept ones.</param>
+<param name="counters">The counters of the search.</param>
+*/
+void Checkpointer::writeRecord(size_t kept, const std::vector<SearchDecision> &suffix, const CheckpointState &counters)
+{
+    stack.resize(kept);
+    stack.insert(stack.end(), suffix.begin(), suffix.end());
+    if (fd < 0)
+    {
+        return;
+    }
+
+    size_t full_size = RECORD_FIXED_SIZE + stack.size() * sizeof(int32_t);
+    if (journal_bytes > 4 * full_size + 65536)
+    {
+        rewrite(counters);
+        return;
+    }
+    std::string record = encodeRecord(kept, suffix.data(), suffix.size(), counters);
+    if (writeFully(fd, record))
+    {
+        ::fdatasync(fd);
+    }
+    journal_bytes += record.size();
+}
+
+/**
+<summary>
+Replaces the file with one holding a single record of the full stack.
+</summary>
+<param name="counters">The counters of the search.</param>
+<remarks>
+The new file is written beside the old one and renamed over it, so a kill
+during the rewrite leaves the previous snapshot intact.
+</remarks>
+*/
+void Checkpointer::rewrite(const CheckpointState &counters)
+{
+    std::string contents(MAGIC, sizeof(MAGIC));
+    append<uint64_t>(contents, formula_hash);
+    contents += encodeRecord(0, stack.data(), stack.size(), counters);
+
+    std::string temp_path = path + ".tmp";
+    int temp_fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (temp_fd < 0)
+    {
+        return;
+    }
+    if (!writeFully(temp_fd, contents) || ::fsync(temp_fd) != 0 || std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        ::close(temp_fd);
+        std::remove(temp_path.c_str());
+        return;
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    // The descriptor still refers to the renamed file; later records are appended to it
+    fd = temp_fd;
+    journal_bytes = contents.size();
+}
+
+/**
+<summary>
+Loads the last complete snapshot from a file.
+</summary>
+<param name="path">The snapshot file.</param>
+<param name="formula_hash">The hash of the formula about to be solved.</param>
+<param name="state">Receives the snapshot.</param>
+<returns>True if the file exists, was written for the same formula and holds a snapshot.</returns>
+*/
+bool Checkpointer::load(const std::string &path, uint64_t formula_hash, CheckpointState &state)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::stringstream contents_stream;
+    contents_stream << file.rdbuf();
+    std::string contents = contents_stream.str();
+
+    state = CheckpointState();
+    size_t offset = sizeof(MAGIC);
+    uint64_t stored_hash;
+    if (contents.size() < offset || std::memcmp(contents.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+        !take(contents, offset, stored_hash) || stored_hash != formula_hash)
+    {
+        return false;
+    }
+
+    bool found = false;
+    uint32_t length, sum;
+    while (take(contents, offset, length) && take(contents, offset, sum))
+    {
+        if (contents.size() - offset < length || length < RECORD_FIXED_SIZE ||
+            checksum(contents.data() + offset, length) != sum)
+        {
+            break; // Torn or damaged tail
+        }
+        size_t end = offset + length;
+        uint32_t kept, count;
+        CheckpointState record;
+        take(contents, offset, kept);
+        take(contents, offset, count);
+        take(contents, offset, record.num_decisions);
+        take(contents, offset, record.num_backtracks);
+        take(contents, offset, record.num_unit_propagations);
+        if (kept > state.decisions.size() || (end - offset) != count * sizeof(int32_t))
+        {
+            break;
+        }
+
+        state.decisions.resize(kept);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            int32_t lit;
+            take(contents, offset, lit);
+            state.decisions.push_back({std::abs(lit) - 1, lit > 0 ? BoolValue::TRUE : BoolValue::FALSE});
+        }
+        state.num_decisions = record.num_decisions;
+        state.num_backtracks = record.num_backtracks;
+        state.num_unit_propagations = record.num_unit_propagations;
+        found = true;
+    }
+    return found;
+}
+
+/**
+<summary>
+Hashes the variable count and clauses of a formula.
+</summary>
+<param name="formula">The formula.</param>
+<returns>The hash.</returns>
+*/
+uint64_t Checkpointer::hashFormula(const BooleanFormula &formula)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](int64_t value)
+    {
+        hash = (hash ^ static_cast<uint64_t>(value)) * 1099511628211ull;
+    };
+    mix(formula.getVariableCount());
+    for (const Clause &clause : formula.getClauses())
+    {
+        for (const Literal &lit : clause.getLiterals())
+        {
+            mix(lit.getValue() == BoolValue::TRUE ? lit.getVariable() : -lit.getVariable());
+        }
+        mix(0);
+    }
+    return hash;
+}
@@ -1,4 +1,5 @@
 #include "Clause.h"
+#include <cstdlib>
 
 /**
 <summary>
@@ -0,0 +1,132 @@
+/**
+<summary>
+The ClauseExchange class lets portfolio workers share short, low-LBD learned
+clauses without taking locks on the search path.
+</summary>
+*/
+#include "ClauseExchange.h"
+#include <algorithm>
+
+const int ClauseExchange::MAX_SHARED_SIZE;
+
+// Constructor for the ClauseExchange class
+ClauseExchange::ClauseExchange(size_t capacity, int max_size, int max_lbd)
+    : max_size(std::min(max_size, MAX_SHARED_SIZE)), max_lbd(max_lbd), next_position(0)
+{
+    size_t rounded = 1;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+    mask = rounded - 1;
+    slots.reset(new Slot[rounded]);
+    for (size_t i = 0; i < rounded; i++)
+    {
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+        slots[i].size.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+<summary>
+Publishes a clause for the other workers.
+</summary>
+<param name="source">The id of the publishing worker.</param>
+<param name="literals">The clause literals in the solvers' internal encoding.</param>
+<param name="size">The number of literals.</param>
+<param name="lbd">The literal block distance.</param>
+<returns>True if the clause was published, false if it was filtered or dropped.</returns>
+*/
+bool ClauseExchange::publish(int source, const int *literals, int size, int lbd)
+{
+    if (!accepts(size, lbd))
+    {
+        return false;
+    }
+
+    uint64_t position = next_position.fetch_add(1, std::memory_order_acq_rel);
+    Slot &slot = slots[position & mask];
+
+    // Claim the slot; give up if a producer from an earlier lap is still writing it
+    uint64_t seen = slot.sequence.load(std::memory_order_acquire);
+    if ((seen & 1) != 0 || seen >= 2 * position + 2 ||
+        !slot.sequence.compare_exchange_strong(seen, 2 * position + 1, std::memory_order_acq_rel))
+    {
+        return false;
+    }
+
+    slot.source.store(source, std::memory_order_relaxed);
+    slot.size.store(size, std::memory_order_relaxed);
+    for (int i = 0; i < size; i++)
+    {
+        slot.literals[i].store(literals[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * position + 2, std::memory_order_release);
+    return true;
+}
+
+/**
+<summary>
+Reads every clause published by other workers since the reader's cursor.
+</summary>
+<param name="reader">The id of the reading worker, whose own clauses are skipped.</param>
+<param name="cursor">The reader's position; advanced past everything read.</param>
+<param name="clauses">Receives the clauses read.</param>
+*/
+void ClauseExchange::collect(int reader, uint64_t &cursor, std::vector<std::vector<int>> &clauses) const
+{
+    uint64_t end = next_position.load(std::memory_order_acquire);
+    if (end - cursor > mask + 1)
+    {
+        cursor = end - (mask + 1); // Everything older has been overwritten
+    }
+
+    int buffer[MAX_SHARED_SIZE];
+    for (; cursor < end; cursor++)
+    {
+        const Slot &slot = slots[cursor & mask];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * cursor + 2)
+        {
+            continue; // Not yet published, dropped, or already overwritten
+        }
+
+        int source = slot.source.load(std::memory_order_relaxed);
+        int size = std::min(slot.size.load(std::memory_order_relaxed), static_cast<int>(MAX_SHARED_SIZE));
+        for (int i = 0; i < size; i++)
+        {
+            buffer[i] = slot.literals[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before || source == reader)
+        {
+            continue; // Overwritten while reading, or our own clause
+        }
+        clauses.push_back(std::vector<int>(buffer, buffer + size));
+    }
+}
+
+/**
+<summary>
+Hashes a clause independently of the order of its literals.
+</summary>
+<param name="literals">The clause literals.</param>
+<param name="size">The number of literals.</param>
+<returns>The clause hash.</returns>
+<remarks>
+Each literal is mixed with a 64-bit finalizer and the results are summed, so
+permutations of the same clause hash alike.
+</remarks>
+*/
+uint64_t ClauseExchange::hashClause(const int *literals, int size)
+{
+    uint64_t hash = static_cast<uint64_t>(size);
+    for (int i = 0; i < size; i++)
+    {
+        uint64_t x = static_cast<uint64_t>(static_cast<uint32_t>(literals[i])) + 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        hash += x ^ (x >> 31);
+    }
+    return hash;
+}
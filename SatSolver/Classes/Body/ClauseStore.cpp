@@ -0,0 +1,147 @@
+#include "ClauseStore.h"
+
+// Constructor for the ClauseStore class
+ClauseStore::ClauseStore(const std::vector<Clause> &clauses)
+{
+    assign(clauses);
+}
+
+/**
+<summary>
+Replaces the stored clauses, keeping the capacity of the buckets.
+</summary>
+<param name="clauses">The clauses to store.</param>
+*/
+void ClauseStore::assign(const std::vector<Clause> &clauses)
+{
+    units.clear();
+    binaries.clear();
+    ternaries.clear();
+    long_literals.clear();
+    long_offsets.assign(1, 0);
+    num_empty = 0;
+    for (const Clause &clause : clauses)
+    {
+        add(clause);
+    }
+}
+
+/**
+<summary>
+Adds a clause to the bucket of its width.
+</summary>
+<param name="clause">The clause to add.</param>
+*/
+void ClauseStore::add(const Clause &clause)
+{
+    const std::vector<Literal> &lits = clause.getLiterals();
+    int encoded[3];
+    for (size_t i = 0; i < lits.size() && i < 3; i++)
+    {
+        encoded[i] = 2 * (lits[i].getVariable() - 1) + (lits[i].getValue() == BoolValue::FALSE ? 1 : 0);
+    }
+
+    switch (lits.size())
+    {
+    case 0:
+        num_empty++;
+        break;
+    case 1:
+        units.push_back({{encoded[0]}});
+        break;
+    case 2:
+        binaries.push_back({{encoded[0], encoded[1]}});
+        break;
+    case 3:
+        ternaries.push_back({{encoded[0], encoded[1], encoded[2]}});
+        break;
+    default:
+        for (const Literal &lit : lits)
+        {
+            long_literals.push_back(2 * (lit.getVariable() - 1) + (lit.getValue() == BoolValue::FALSE ? 1 : 0));
+        }
+        long_offsets.push_back(static_cast<uint32_t>(long_literals.size()));
+        break;
+    }
+}
+
+/**
+<summary>
+Evaluates every stored clause under a partial assignment.
+</summary>
+<param name="assignment">The value of each variable, indexed from 0.</param>
+<returns>
+TRUE if every clause is satisfied, FALSE if some clause has all of its literals
+assigned false, otherwise UNASSIGNED.
+</returns>
+<remarks>
+The short buckets come first: they are the most likely to hold a falsified
+clause and their kernels have fully unrolled loops.
+</remarks>
+*/
+BoolValue ClauseStore::evaluate(const std::vector<BoolValue> &assignment) const
+{
+    if (num_empty > 0)
+    {
+        return BoolValue::FALSE;
+    }
+
+    const BoolValue *values = assignment.data();
+    int status = evaluateBucket(units, values);
+    if (status >= 0)
+    {
+        int result = evaluateBucket(binaries, values);
+        status = result < 0 ? -1 : status & result;
+    }
+    if (status >= 0)
+    {
+        int result = evaluateBucket(ternaries, values);
+        status = result < 0 ? -1 : status & result;
+    }
+    if (status < 0)
+    {
+        return BoolValue::FALSE;
+    }
+
+    for (size_t i = 0; i + 1 < long_offsets.size(); i++)
+    {
+        int result = evaluateLiterals<0>(&long_literals[long_offsets[i]], long_offsets[i + 1] - long_offsets[i], values);
+        if (result < 0)
+        {
+            return BoolValue::FALSE;
+        }
+        status &= result;
+    }
+    return status != 0 ? BoolValue::TRUE : BoolValue::UNASSIGNED;
+}
+
+/**
+<summary>
+Checks that an assignment satisfies every stored clause.
+</summary>
+<param name="assignment">The value of each variable, indexed from 0.</param>
+<returns>True if every clause has a literal assigned TRUE, otherwise false.</returns>
+<remarks>
+One pass over every bucket, meant for checking a model once the search is
+over: unlike evaluate() it does not stop at the first falsified clause, which
+keeps the loops free of branches.
+</remarks>
+*/
+bool ClauseStore::verify(const std::vector<BoolValue> &assignment) const
+{
+    const BoolValue *values = assignment.data();
+    unsigned all = (num_empty == 0);
+    all &= verifyBucket(units, values);
+    all &= verifyBucket(binaries, values);
+    all &= verifyBucket(ternaries, values);
+    for (size_t i = 0; i + 1 < long_offsets.size(); i++)
+    {
+        unsigned satisfied = 0;
+        for (uint32_t k = long_offsets[i]; k < long_offsets[i + 1]; k++)
+        {
+            satisfied |= static_cast<unsigned>(static_cast<int>(values[long_literals[k] >> 1]) == (long_literals[k] & 1));
+        }
+        all &= satisfied;
+    }
+    return all != 0;
+}
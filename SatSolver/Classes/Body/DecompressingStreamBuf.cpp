@@ -0,0 +1,218 @@
+#include "DecompressingStreamBuf.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+
+const size_t DecompressingStreamBuf::CHUNK_SIZE;
+const size_t DecompressingStreamBuf::MAX_CHUNKS;
+
+/**
+<summary>
+Picks the decompressor for a file from its first bytes.
+</summary>
+<param name="magic">The first bytes of the file.</param>
+<param name="size">The number of bytes available, up to six.</param>
+<returns>"gzip", "xz" or "zstd", or nullptr if the file is not compressed in a known format.</returns>
+*/
+const char *DecompressingStreamBuf::detectDecompressor(const unsigned char *magic, size_t size)
+{
+    static const unsigned char GZIP[] = {0x1f, 0x8b};
+    static const unsigned char XZ[] = {0xfd, '7', 'z', 'X', 'Z', 0x00};
+    static const unsigned char ZSTD[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+    if (size >= sizeof(GZIP) && std::memcmp(magic, GZIP, sizeof(GZIP)) == 0)
+    {
+        return "gzip";
+    }
+    if (size >= sizeof(XZ) && std::memcmp(magic, XZ, sizeof(XZ)) == 0)
+    {
+        return "xz";
+    }
+    if (size >= sizeof(ZSTD) && std::memcmp(magic, ZSTD, sizeof(ZSTD)) == 0)
+    {
+        return "zstd";
+    }
+    return nullptr;
+}
+
+// Constructor for the DecompressingStreamBuf class
+DecompressingStreamBuf::DecompressingStreamBuf(const std::string &tool, const std::string &filename)
+{
+    int fds[2];
+    if (::pipe(fds) != 0)
+    {
+        throw std::runtime_error(std::string("Failed to create a pipe: ") + std::strerror(errno));
+    }
+    child = ::fork();
+    if (child < 0)
+    {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw std::runtime_error(std::string("Failed to start ") + tool + ": " + std::strerror(errno));
+    }
+    if (child == 0)
+    {
+        // The file name is passed as an argument, never through a shell
+        ::dup2(fds[1], STDOUT_FILENO);
+        ::close(fds[0]);
+        ::close(fds[1]);
+        execlp(tool.c_str(), tool.c_str(), "-d", "-c", "--", filename.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    ::close(fds[1]);
+    pipe_fd = fds[0];
+    setg(nullptr, nullptr, nullptr);
+    reader = std::thread(&DecompressingStreamBuf::readerLoop, this);
+}
+
+// Destructor for the DecompressingStreamBuf class
+DecompressingStreamBuf::~DecompressingStreamBuf()
+{
+    close();
+}
+
+/**
+<summary>
+Stops reading and waits for the decompressor to exit.
+</summary>
+<returns>True if the decompressor read the whole file without error, otherwise false.</returns>
+<remarks>
+Closing before the output is exhausted terminates the decompressor and is
+reported as a failure.
+</remarks>
+*/
+bool DecompressingStreamBuf::close()
+{
+    if (closed)
+    {
+        return false;
+    }
+    closed = true;
+    bool complete;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+        complete = end_of_input;
+    }
+    chunk_free.notify_all();
+    if (!complete)
+    {
+        // A reader blocked on the pipe returns once the decompressor is gone
+        ::kill(child, SIGTERM);
+    }
+    if (reader.joinable())
+    {
+        reader.join();
+    }
+    ::close(pipe_fd);
+
+    int status = 0;
+    while (::waitpid(child, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+    return complete && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+<summary>
+Makes the next decompressed chunk the get area, waiting for the reader thread if needed.
+</summary>
+<returns>The next character, or EOF once the decompressor's output is exhausted.</returns>
+*/
+DecompressingStreamBuf::int_type DecompressingStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::unique_lock<std::mutex> lock(mtx);
+    if (!current.empty())
+    {
+        spare.push_back(std::move(current));
+        current.clear();
+        chunk_free.notify_one();
+    }
+    chunk_ready.wait(lock, [this]
+                     { return !filled.empty() || end_of_input; });
+    if (filled.empty())
+    {
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+    current = std::move(filled.front());
+    filled.pop_front();
+    lock.unlock();
+
+    setg(current.data(), current.data(), current.data() + current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+/**
+<summary>
+Reads the decompressor's output into chunks until it ends or the buffer is closed.
+</summary>
+*/
+void DecompressingStreamBuf::readerLoop()
+{
+    while (true)
+    {
+        std::vector<char> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            chunk_free.wait(lock, [this]
+                            { return stopping || !spare.empty() || allocated_chunks < MAX_CHUNKS; });
+            if (stopping)
+            {
+                break;
+            }
+            if (!spare.empty())
+            {
+                chunk = std::move(spare.back());
+                spare.pop_back();
+            }
+            else
+            {
+                allocated_chunks++;
+            }
+        }
+
+        // Fill the chunk completely so the parser sees few, large chunks
+        chunk.resize(CHUNK_SIZE);
+        size_t size = 0;
+        bool finished = false;
+        while (size < CHUNK_SIZE)
+        {
+            ssize_t got = ::read(pipe_fd, chunk.data() + size, CHUNK_SIZE - size);
+            if (got < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (got <= 0)
+            {
+                finished = true;
+                break;
+            }
+            size += got;
+        }
+        chunk.resize(size);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (size > 0)
+        {
+            filled.push_back(std::move(chunk));
+        }
+        if (finished)
+        {
+            break;
+        }
+        chunk_ready.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    end_of_input = true;
+    chunk_ready.notify_one();
+}
@@ -0,0 +1,483 @@
+/**
+<summary>
+The EngineSelector class routes each formula to an engine by its features and
+tunes the routing thresholds on timed benchmark records.
+</summary>
+*/
+#include "EngineSelector.h"
+#include "BacktrackSolver.h"
+#include "TwoSatSolver.h"
+#include "LookaheadSolver.h"
+#include "CdclSolver.h"
+#include "PortfolioSolver.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+namespace
+{
+    // Largest formulas measure() times the exponential engines on
+    const int MEASURE_BACKTRACK_MAX_VARS = 40;
+    const int MEASURE_LOOKAHEAD_MAX_VARS = 2000;
+
+    // Excluded variables checked for an at-most-one constraint, to bound the pairs looked up
+    const size_t MAX_CARDINALITY_NEIGHBOURS = 64;
+
+    // A threshold of the selection, the key it has in a file and the feature it is compared with
+    struct ThresholdField
+    {
+        const char *key;
+        double EngineThresholds::*field;
+        double (*feature)(const FormulaFeatures &);
+        bool upper; // True if the feature must not exceed the threshold, false if it must reach it
+    };
+
+    double variablesOf(const FormulaFeatures &features) { return features.variables; }
+    double clausesOf(const FormulaFeatures &features) { return features.clauses; }
+    double densityOf(const FormulaFeatures &features) { return features.density; }
+    double binaryFractionOf(const FormulaFeatures &features) { return features.binary_fraction; }
+    double cardinalityOf(const FormulaFeatures &features) { return features.cardinality_fraction; }
+
+    const ThresholdField THRESHOLD_FIELDS[] = {
+        {"backtrack_max_vars", &EngineThresholds::backtrack_max_vars, variablesOf, true},
+        {"lookahead_min_density", &EngineThresholds::lookahead_min_density, densityOf, false},
+        {"lookahead_max_vars", &EngineThresholds::lookahead_max_vars, variablesOf, true},
+        {"lookahead_max_binary_fraction", &EngineThresholds::lookahead_max_binary_fraction, binaryFractionOf, true},
+        {"lookahead_max_cardinality", &EngineThresholds::lookahead_max_cardinality, cardinalityOf, true},
+        {"portfolio_min_clauses", &EngineThresholds::portfolio_min_clauses, clausesOf, false},
+    };
+
+    // Fills in the features derived from the counted ones
+    void deriveFeatures(FormulaFeatures &features)
+    {
+        // Satisfiability thresholds of uniform random k-SAT for k up to 7, then about 2^k ln 2
+        static const double thresholds[] = {1, 1, 1, 4.267, 9.931, 21.117, 43.37, 87.79};
+        double threshold = features.max_width < 8 ? thresholds[std::max(0, features.max_width)] : std::ldexp(std::log(2.0), features.max_width);
+        features.ratio = features.variables > 0 ? static_cast<double>(features.clauses) / features.variables : 0;
+        features.density = features.ratio / threshold;
+    }
+
+    // Microseconds since a start time
+    double elapsedSince(std::chrono::steady_clock::time_point start)
+    {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+/**
+<summary>
+Gets the names of the engines the selector chooses from.
+</summary>
+<returns>The names, in the order of EngineRecord::times.</returns>
+*/
+const std::vector<std::string> &EngineSelector::engineNames()
+{
+    static const std::vector<std::string> names = {"backtrack", "twosat", "lookahead", "cdcl", "portfolio"};
+    return names;
+}
+
+/**
+<summary>
+Computes the features of a formula.
+</summary>
+<param name="formula">The formula.</param>
+<returns>The features.</returns>
+<remarks>
+A variable is in an at-most-one constraint when two of the variables it
+excludes, by a clause of two negative literals, also exclude each other, as in
+the pairwise encodings of Sudoku, pigeonhole and scheduling formulas.
+</remarks>
+*/
+FormulaFeatures EngineSelector::extractFeatures(const BooleanFormula &formula)
+{
+    FormulaFeatures features;
+    features.variables = formula.getVariableCount();
+    features.clauses = formula.getClauseCount();
+
+    std::vector<std::vector<int>> excludes(features.variables);
+    int num_binary = 0;
+    for (const Clause &clause : formula.getClauses())
+    {
+        const std::vector<Literal> &literals = clause.getLiterals();
+        features.max_width = std::max(features.max_width, static_cast<int>(literals.size()));
+        if (literals.size() == 2)
+        {
+            num_binary++;
+            int a = literals[0].getVariable() - 1, b = literals[1].getVariable() - 1;
+            if (literals[0].getValue() == BoolValue::FALSE && literals[1].getValue() == BoolValue::FALSE && a != b)
+            {
+                excludes[a].push_back(b);
+                excludes[b].push_back(a);
+            }
+        }
+    }
+    for (std::vector<int> &neighbours : excludes)
+    {
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    }
+
+    int num_cardinality = 0;
+    for (const std::vector<int> &neighbours : excludes)
+    {
+        bool in_constraint = false;
+        size_t width = std::min(neighbours.size(), MAX_CARDINALITY_NEIGHBOURS);
+        for (size_t i = 0; i < width && !in_constraint; i++)
+        {
+            const std::vector<int> &other = excludes[neighbours[i]];
+            for (size_t j = i + 1; j < width && !in_constraint; j++)
+            {
+                in_constraint = std::binary_search(other.begin(), other.end(), neighbours[j]);
+            }
+        }
+        num_cardinality += in_constraint;
+    }
+
+    features.binary_fraction = features.clauses > 0 ? static_cast<double>(num_binary) / features.clauses : 0;
+    features.cardinality_fraction = features.variables > 0 ? static_cast<double>(num_cardinality) / features.variables : 0;
+    deriveFeatures(features);
+    return features;
+}
+
+/**
+<summary>
+Picks the engine for a formula.
+</summary>
+<param name="features">The features of the formula.</param>
+<param name="thresholds">The thresholds.</param>
+<returns>The name of the engine.</returns>
+*/
+std::string EngineSelector::select(const FormulaFeatures &features, const EngineThresholds &thresholds)
+{
+    if (features.max_width <= 2)
+    {
+        return "twosat";
+    }
+    if (features.variables <= thresholds.backtrack_max_vars)
+    {
+        return "backtrack";
+    }
+    if (features.density >= thresholds.lookahead_min_density && features.variables <= thresholds.lookahead_max_vars &&
+        features.binary_fraction <= thresholds.lookahead_max_binary_fraction &&
+        features.cardinality_fraction <= thresholds.lookahead_max_cardinality)
+    {
+        return "lookahead";
+    }
+    if (features.clauses >= thresholds.portfolio_min_clauses)
+    {
+        return "portfolio";
+    }
+    return "cdcl";
+}
+
+/**
+<summary>
+Times every engine that can solve a formula in reasonable time.
+</summary>
+<param name="formula">The formula.</param>
+<param name="portfolio_workers">The solver threads of the portfolio.</param>
+<returns>The record of the formula.</returns>
+<remarks>
+Each time includes building the engine, as solving the formula in a batch does.
+</remarks>
+*/
+EngineRecord EngineSelector::measure(const BooleanFormula &formula, int portfolio_workers)
+{
+    EngineRecord record;
+    record.features = extractFeatures(formula);
+    record.times.assign(engineNames().size(), -1);
+    for (size_t e = 0; e < engineNames().size(); e++)
+    {
+        const std::string &engine = engineNames()[e];
+        auto start = std::chrono::steady_clock::now();
+        if (engine == "backtrack" && record.features.variables <= MEASURE_BACKTRACK_MAX_VARS)
+        {
+            BacktrackSolver solver(formula);
+            solver.solve();
+        }
+        else if (engine == "twosat" && record.features.max_width <= 2)
+        {
+            TwoSatSolver solver(formula);
+            solver.solve();
+        }
+        else if (engine == "lookahead" && record.features.variables <= MEASURE_LOOKAHEAD_MAX_VARS)
+        {
+            LookaheadSolver solver(formula);
+            solver.solve();
+        }
+        else if (engine == "cdcl")
+        {
+            CdclSolver solver(formula);
+            solver.solve();
+        }
+        else if (engine == "portfolio")
+        {
+            PortfolioSolver solver(formula, portfolio_workers);
+            solver.solve();
+        }
+        else
+        {
+            continue;
+        }
+        record.times[e] = elapsedSince(start);
+    }
+    return record;
+}
+
+/**
+<summary>
+Sets the thresholds that minimize the total time of the selected engines on some records.
+</summary>
+<param name="records">The benchmark records.</param>
+<param name="thresholds">The thresholds to start from; receives the tuned ones.</param>
+<returns>The total time of the selected engines, in microseconds.</returns>
+<remarks>
+Coordinate descent: each threshold in turn is set to the best of the values its
+feature takes in the records, or to a value that turns its rule off, until a
+pass changes nothing. Only strict improvements are taken, so thresholds the
+records say nothing about keep their starting values.
+</remarks>
+*/
+double EngineSelector::tune(const std::vector<EngineRecord> &records, EngineThresholds &thresholds)
+{
+    double best = totalTime(records, thresholds);
+    for (int pass = 0; pass < 10; pass++)
+    {
+        bool improved = false;
+        for (const ThresholdField &threshold : THRESHOLD_FIELDS)
+        {
+            std::vector<double> candidates(1, threshold.upper ? -1.0 : 1e18);
+            for (const EngineRecord &record : records)
+            {
+                candidates.push_back(threshold.feature(record.features));
+            }
+            for (double candidate : candidates)
+            {
+                EngineThresholds trial = thresholds;
+                trial.*threshold.field = candidate;
+                double time = totalTime(records, trial);
+                if (time < best)
+                {
+                    best = time;
+                    thresholds = trial;
+                    improved = true;
+                }
+            }
+        }
+        if (!improved)
+        {
+            break;
+        }
+    }
+    return best;
+}
+
+/**
+<summary>
+Computes the total time of the engines a selection picks on some records.
+</summary>
+<param name="records">The benchmark records.</param>
+<param name="thresholds">The thresholds.</param>
+<returns>The total time in microseconds; an engine not measured on a record costs ten times its slowest engine.</returns>
+*/
+double EngineSelector::totalTime(const std::vector<EngineRecord> &records, const EngineThresholds &thresholds)
+{
+    const std::vector<std::string> &names = engineNames();
+    double total = 0;
+    for (const EngineRecord &record : records)
+    {
+        size_t e = std::find(names.begin(), names.end(), select(record.features, thresholds)) - names.begin();
+        double time = e < record.times.size() ? record.times[e] : -1;
+        if (time < 0)
+        {
+            time = 10 * std::max(1.0, *std::max_element(record.times.begin(), record.times.end()));
+        }
+        total += time;
+    }
+    return total;
+}
+
+/**
+<summary>
+Reads thresholds from a file of KEY=VALUE lines; lines starting with # are comments.
+</summary>
+<param name="path">The file.</param>
+<param name="thresholds">Receives the values; keys not in the file keep theirs.</param>
+<returns>True if the file was read and every key and value is valid, otherwise false.</returns>
+*/
+bool EngineSelector::loadThresholds(const std::string &path, EngineThresholds &thresholds)
+{
+    std::ifstream file(path);
+    return file.is_open() && readThresholds(file, thresholds);
+}
+
+/**
+<summary>
+Writes thresholds in the format loadThresholds() reads.
+</summary>
+<param name="path">The file, replaced.</param>
+<param name="thresholds">The thresholds.</param>
+<returns>True if the file was written, otherwise false.</returns>
+*/
+bool EngineSelector::saveThresholds(const std::string &path, const EngineThresholds &thresholds)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file << "# Engine selection thresholds for --engine=auto\n";
+    writeThresholds(file, thresholds);
+    return static_cast<bool>(file.flush());
+}
+
+/**
+<summary>
+Reads thresholds as KEY=VALUE lines; lines starting with # are comments.
+</summary>
+<param name="input">The lines, read to the end.</param>
+<param name="thresholds">Receives the values; keys not read keep theirs.</param>
+<returns>True if every key and value is valid, otherwise false.</returns>
+*/
+bool EngineSelector::readThresholds(std::istream &input, EngineThresholds &thresholds)
+{
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        size_t equals = line.find('=');
+        if (equals == std::string::npos)
+        {
+            return false;
+        }
+        std::string key = line.substr(0, equals);
+        const char *value = line.c_str() + equals + 1;
+        char *end;
+        double number = std::strtod(value, &end);
+        if (end == value)
+        {
+            return false;
+        }
+        bool known = false;
+        for (const ThresholdField &threshold : THRESHOLD_FIELDS)
+        {
+            if (key == threshold.key)
+            {
+                thresholds.*threshold.field = number;
+                known = true;
+            }
+        }
+        if (!known)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Writes thresholds as the KEY=VALUE lines readThresholds() reads.
+</summary>
+<param name="output">The stream written to.</param>
+<param name="thresholds">The thresholds.</param>
+*/
+void EngineSelector::writeThresholds(std::ostream &output, const EngineThresholds &thresholds)
+{
+    std::streamsize precision = output.precision(17);
+    for (const ThresholdField &threshold : THRESHOLD_FIELDS)
+    {
+        output << threshold.key << "=" << thresholds.*threshold.field << "\n";
+    }
+    output.precision(precision);
+}
+
+/**
+<summary>
+Reads benchmark records from a CSV file written by appendRecords().
+</summary>
+<param name="path">The file.</param>
+<param name="records">Receives the records; rows that do not parse are skipped.</param>
+<returns>True if the file was opened, otherwise false.</returns>
+*/
+bool EngineSelector::loadRecords(const std::string &path, std::vector<EngineRecord> &records)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::vector<double> values;
+        std::stringstream row(line);
+        std::string cell;
+        bool numeric = true;
+        while (std::getline(row, cell, ','))
+        {
+            char *end;
+            values.push_back(std::strtod(cell.c_str(), &end));
+            numeric &= !cell.empty() && *end == '\0';
+        }
+        if (!numeric || values.size() != 5 + engineNames().size())
+        {
+            continue; // The header, or a damaged row
+        }
+        EngineRecord record;
+        record.features.variables = static_cast<int>(values[0]);
+        record.features.clauses = static_cast<int>(values[1]);
+        record.features.max_width = static_cast<int>(values[2]);
+        record.features.binary_fraction = values[3];
+        record.features.cardinality_fraction = values[4];
+        deriveFeatures(record.features);
+        record.times.assign(values.begin() + 5, values.end());
+        records.push_back(record);
+    }
+    return true;
+}
+
+/**
+<summary>
+Appends benchmark records to a CSV file, writing its header if it is new.
+</summary>
+<param name="path">The file.</param>
+<param name="records">The records.</param>
+<returns>True if the records were written, otherwise false.</returns>
+*/
+bool EngineSelector::appendRecords(const std::string &path, const std::vector<EngineRecord> &records)
+{
+    bool is_new = !std::ifstream(path).good();
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    if (is_new)
+    {
+        file << "Variables,Clauses,Max Width,Binary Fraction,Cardinality Fraction";
+        for (const std::string &name : engineNames())
+        {
+            file << "," << name;
+        }
+        file << "\n";
+    }
+    file.precision(17);
+    for (const EngineRecord &record : records)
+    {
+        file << record.features.variables << "," << record.features.clauses << "," << record.features.max_width << ","
+             << record.features.binary_fraction << "," << record.features.cardinality_fraction;
+        for (double time : record.times)
+        {
+            file << "," << time;
+        }
+        file << "\n";
+    }
+    return static_cast<bool>(file.flush());
+}
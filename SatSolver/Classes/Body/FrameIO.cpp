@@ -0,0 +1,305 @@
+#include "FrameIO.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+namespace
+{
+    // Reads exactly size bytes unless the peer closes the stream or an error occurs
+    bool readFully(int fd, char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t got = ::read(fd, data, size);
+            if (got < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (got <= 0)
+            {
+                return false;
+            }
+            data += got;
+            size -= got;
+        }
+        return true;
+    }
+
+    // Writes exactly size bytes; a closed peer is an error instead of SIGPIPE, through
+    // MSG_NOSIGNAL where it exists and the SO_NOSIGPIPE socket option on macOS and the BSDs
+    bool writeFully(int fd, const char *data, size_t size)
+    {
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+        int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        while (size > 0)
+        {
+            ssize_t sent = ::send(fd, data, size, flags);
+            if (sent < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (sent <= 0)
+            {
+                return false;
+            }
+            data += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    // Fills in a Unix domain socket address, rejecting paths that do not fit
+    sockaddr_un unixAddress(const std::string &path)
+    {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            throw std::runtime_error("Socket path is too long");
+        }
+        std::strcpy(address.sun_path, path.c_str());
+        return address;
+    }
+
+    // Resolves HOST:PORT into a list of TCP addresses; the caller frees it with freeaddrinfo
+    addrinfo *resolveTcp(const std::string &address, bool passive)
+    {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos)
+        {
+            throw std::runtime_error("Address must be unix:PATH or HOST:PORT");
+        }
+        std::string host = address.substr(0, colon);
+        std::string port = address.substr(colon + 1);
+
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+        addrinfo *result = nullptr;
+        if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0)
+        {
+            return nullptr;
+        }
+        return result;
+    }
+}
+
+/**
+<summary>
+Reads one frame from a socket, retrying on short reads and interrupts.
+</summary>
+<param name="fd">The socket to read from.</param>
+<param name="payload">Receives the payload of the frame.</param>
+<returns>True if a complete frame was read, false on end of stream or error.</returns>
+*/
+bool FrameIO::readFrame(int fd, std::string &payload)
+{
+    uint32_t length;
+    if (!readFully(fd, reinterpret_cast<char *>(&length), sizeof(length)))
+    {
+        return false;
+    }
+    length = ntohl(length);
+    if (length > MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+
+    payload.resize(length);
+    return length == 0 || readFully(fd, &payload[0], length);
+}
+
+/**
+<summary>
+Writes one frame to a socket, retrying on short writes and interrupts.
+</summary>
+<param name="fd">The socket to write to.</param>
+<param name="payload">The payload of the frame.</param>
+<returns>True if the whole frame was written, otherwise false.</returns>
+*/
+bool FrameIO::writeFrame(int fd, const std::string &payload)
+{
+    std::string frame;
+    frame.reserve(payload.size() + 4);
+    appendUint32(frame, static_cast<uint32_t>(payload.size()));
+    frame += payload;
+    return writeFully(fd, frame.data(), frame.size());
+}
+
+/**
+<summary>
+Appends a 32-bit value in network byte order to a buffer.
+</summary>
+<param name="buffer">The buffer to append to.</param>
+<param name="value">The value to append.</param>
+*/
+void FrameIO::appendUint32(std::string &buffer, uint32_t value)
+{
+    uint32_t net = htonl(value);
+    buffer.append(reinterpret_cast<const char *>(&net), sizeof(net));
+}
+
+/**
+<summary>
+Reads a 32-bit value in network byte order from a buffer.
+</summary>
+<param name="buffer">The buffer to read from.</param>
+<param name="offset">The position of the value; advanced past it on success.</param>
+<param name="value">Receives the value.</param>
+<returns>True if the buffer held four more bytes, otherwise false.</returns>
+*/
+bool FrameIO::readUint32(const std::string &buffer, size_t &offset, uint32_t &value)
+{
+    if (offset + sizeof(value) > buffer.size())
+    {
+        return false;
+    }
+    uint32_t net;
+    buffer.copy(reinterpret_cast<char *>(&net), sizeof(net), offset);
+    value = ntohl(net);
+    offset += sizeof(net);
+    return true;
+}
+
+/**
+<summary>
+Removes one complete frame from the front of a receive buffer.
+</summary>
+<param name="buffer">The bytes received so far.</param>
+<param name="payload">Receives the payload of the frame.</param>
+<returns>True if a complete frame was extracted, false if more bytes are needed.</returns>
+*/
+bool FrameIO::extractFrame(std::string &buffer, std::string &payload)
+{
+    size_t offset = 0;
+    uint32_t length;
+    if (!readUint32(buffer, offset, length))
+    {
+        return false;
+    }
+    if (length > MAX_FRAME_SIZE)
+    {
+        throw std::runtime_error("Frame too large");
+    }
+    if (buffer.size() < offset + length)
+    {
+        return false;
+    }
+    payload.assign(buffer, offset, length);
+    buffer.erase(0, offset + length);
+    return true;
+}
+
+/**
+<summary>
+Creates a listening socket for an address of the form "unix:PATH" or "HOST:PORT".
+</summary>
+<param name="address">The address to listen on.</param>
+<returns>The listening socket.</returns>
+*/
+int FrameIO::listenOn(const std::string &address)
+{
+    int fd = -1;
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+        sockaddr_un local = unixAddress(address.substr(5));
+        // A socket file left behind by a previous run would make bind fail; anything else at the path is kept
+        struct stat existing;
+        if (::lstat(local.sun_path, &existing) == 0)
+        {
+            if (!S_ISSOCK(existing.st_mode))
+            {
+                throw std::runtime_error(std::string(local.sun_path) + " exists and is not a socket");
+            }
+            ::unlink(local.sun_path);
+        }
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::bind(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) < 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    else
+    {
+        addrinfo *candidates = resolveTcp(address, true);
+        for (addrinfo *ai = candidates; ai != nullptr && fd < 0; ai = ai->ai_next)
+        {
+            fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            int reuse = 1;
+            if (fd >= 0 && (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+                            ::bind(fd, ai->ai_addr, ai->ai_addrlen) < 0))
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        if (candidates != nullptr)
+        {
+            ::freeaddrinfo(candidates);
+        }
+    }
+
+    if (fd < 0 || ::listen(fd, 64) < 0)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        throw std::runtime_error("Failed to bind the socket");
+    }
+    return fd;
+}
+
+/**
+<summary>
+Connects to an address of the form "unix:PATH" or "HOST:PORT".
+</summary>
+<param name="address">The address to connect to.</param>
+<returns>The connected socket, or -1 if the connection failed.</returns>
+*/
+int FrameIO::connectTo(const std::string &address)
+{
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+        sockaddr_un remote = unixAddress(address.substr(5));
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr *>(&remote), sizeof(remote)) < 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+        return fd;
+    }
+
+    int fd = -1;
+    addrinfo *candidates = resolveTcp(address, false);
+    for (addrinfo *ai = candidates; ai != nullptr && fd < 0; ai = ai->ai_next)
+    {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) < 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    if (candidates != nullptr)
+    {
+        ::freeaddrinfo(candidates);
+    }
+    return fd;
+}
@@ -0,0 +1,375 @@
+#include "InstanceGenerator.h"
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    // SplitMix64: small, fast and identical everywhere
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        uint64_t next()
+        {
+            uint64_t value = (state += 0x9e3779b97f4a7c15ull);
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+            return value ^ (value >> 31);
+        }
+
+        // Uniform in [0, bound), rejecting the values that would bias the modulo
+        uint64_t below(uint64_t bound)
+        {
+            uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+            uint64_t value;
+            do
+            {
+                value = next();
+            } while (value >= limit);
+            return value % bound;
+        }
+
+        bool coin() { return (next() >> 63) != 0; }
+
+    private:
+        uint64_t state;
+    };
+
+    // Mixes the batch seed with the formula index, so each formula stands alone
+    uint64_t formulaSeed(uint64_t seed, int index)
+    {
+        return Random(seed ^ (0xd1b54a32d192ed03ull * (static_cast<uint64_t>(index) + 1))).next();
+    }
+
+    template <typename T>
+    void shuffle(std::vector<T> &items, Random &random)
+    {
+        for (size_t i = items.size(); i > 1; i--)
+        {
+            std::swap(items[i - 1], items[random.below(i)]);
+        }
+    }
+
+    // Draws k distinct variables with random signs
+    void drawClause(int variables, int k, Random &random, std::vector<int> &literals)
+    {
+        literals.clear();
+        while (static_cast<int>(literals.size()) < k)
+        {
+            int var = static_cast<int>(random.below(variables)) + 1;
+            bool repeated = false;
+            for (int lit : literals)
+            {
+                repeated |= (std::abs(lit) == var);
+            }
+            if (!repeated)
+            {
+                literals.push_back(random.coin() ? -var : var);
+            }
+        }
+    }
+
+    void addClause(BooleanFormula &formula, const std::vector<int> &literals)
+    {
+        Clause clause;
+        for (int lit : literals)
+        {
+            clause.addLiteral(Literal(std::abs(lit), lit < 0 ? BoolValue::FALSE : BoolValue::TRUE));
+        }
+        formula.addClause(clause);
+    }
+}
+
+/**
+<summary>
+Parses a generator spec.
+</summary>
+<param name="text">The spec, FAMILY[:KEY=VALUE,...].</param>
+<param name="spec">Receives the parameters; keys not given keep their defaults.</param>
+<returns>True if the family, every key and every value are valid, otherwise false.</returns>
+*/
+bool InstanceGenerator::parseSpec(const std::string &text, GeneratorSpec &spec)
+{
+    size_t colon = text.find(':');
+    spec.family = text.substr(0, colon);
+    if (spec.family != "random" && spec.family != "planted" && spec.family != "sudoku")
+    {
+        return false;
+    }
+
+    std::istringstream iss(colon == std::string::npos ? "" : text.substr(colon + 1));
+    std::string pair;
+    while (std::getline(iss, pair, ','))
+    {
+        size_t equals = pair.find('=');
+        if (equals == std::string::npos)
+        {
+            return false;
+        }
+        std::string key = pair.substr(0, equals);
+        const char *value = pair.c_str() + equals + 1;
+        char *end;
+        double number = std::strtod(value, &end);
+        if (end == value || *end != '\0')
+        {
+            return false;
+        }
+
+        if (key == "vars")
+        {
+            spec.variables = static_cast<int>(number);
+        }
+        else if (key == "k")
+        {
+            spec.k = static_cast<int>(number);
+        }
+        else if (key == "ratio")
+        {
+            spec.ratio = number;
+        }
+        else if (key == "order")
+        {
+            spec.order = static_cast<int>(number);
+        }
+        else if (key == "givens")
+        {
+            spec.givens = number;
+        }
+        else if (key == "count")
+        {
+            spec.count = static_cast<int>(number);
+        }
+        else if (key == "growth")
+        {
+            spec.growth = number;
+        }
+        else if (key == "seed")
+        {
+            spec.seed = std::strtoull(value, nullptr, 10);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    int root = static_cast<int>(std::lround(std::sqrt(static_cast<double>(spec.order))));
+    return spec.variables >= 1 && spec.k >= 1 && spec.k <= spec.variables && spec.ratio >= 0 &&
+           spec.order >= 1 && root * root == spec.order && spec.givens >= 0 && spec.givens <= 1 &&
+           spec.count >= 1 && spec.growth >= 1;
+}
+
+/**
+<summary>
+Generates the formulas of a spec.
+</summary>
+<param name="spec">The parameters.</param>
+<returns>The formulas, in order.</returns>
+<remarks>
+With growth above 1, formula i has about vars * growth^i variables, or for
+Sudoku a side of about order * growth^i rounded up to a perfect square.
+</remarks>
+*/
+std::vector<BooleanFormula> InstanceGenerator::generate(const GeneratorSpec &spec)
+{
+    std::vector<BooleanFormula> formulas;
+    for (int i = 0; i < spec.count; i++)
+    {
+        double scale = std::pow(spec.growth, i);
+        uint64_t seed = formulaSeed(spec.seed, i);
+        if (spec.family == "sudoku")
+        {
+            int root = static_cast<int>(std::ceil(std::sqrt(spec.order * scale) - 1e-9));
+            formulas.push_back(sudoku(root * root, spec.givens, seed));
+        }
+        else
+        {
+            int variables = std::max(spec.k, static_cast<int>(std::lround(spec.variables * scale)));
+            formulas.push_back(spec.family == "planted" ? plantedKSat(variables, spec.k, spec.ratio, seed)
+                                                        : randomKSat(variables, spec.k, spec.ratio, seed));
+        }
+    }
+    return formulas;
+}
+
+/**
+<summary>
+Generates a uniform random k-SAT formula: each clause has k distinct variables with random signs.
+</summary>
+<param name="variables">The number of variables.</param>
+<param name="k">The literals per clause, at most the number of variables.</param>
+<param name="ratio">The clauses per variable.</param>
+<param name="seed">The random seed.</param>
+<returns>The formula, with an unknown ('?') answer.</returns>
+*/
+BooleanFormula InstanceGenerator::randomKSat(int variables, int k, double ratio, uint64_t seed)
+{
+    Random random(seed);
+    BooleanFormula formula;
+    long long num_clauses = std::llround(ratio * variables);
+    std::vector<int> literals;
+    for (long long c = 0; c < num_clauses; c++)
+    {
+        drawClause(variables, k, random, literals);
+        addClause(formula, literals);
+    }
+    return formula;
+}
+
+/**
+<summary>
+Generates a random k-SAT formula satisfied by a hidden random assignment:
+clauses that assignment falsifies are drawn again.
+</summary>
+<param name="variables">The number of variables.</param>
+<param name="k">The literals per clause, at most the number of variables.</param>
+<param name="ratio">The clauses per variable.</param>
+<param name="seed">The random seed.</param>
+<returns>The formula, with answer 'S'.</returns>
+*/
+BooleanFormula InstanceGenerator::plantedKSat(int variables, int k, double ratio, uint64_t seed)
+{
+    Random random(seed);
+    std::vector<bool> solution(variables + 1);
+    for (int var = 1; var <= variables; var++)
+    {
+        solution[var] = random.coin();
+    }
+
+    BooleanFormula formula;
+    formula.setAnswer('S');
+    long long num_clauses = std::llround(ratio * variables);
+    std::vector<int> literals;
+    for (long long c = 0; c < num_clauses; c++)
+    {
+        bool satisfied = false;
+        while (!satisfied)
+        {
+            drawClause(variables, k, random, literals);
+            for (int lit : literals)
+            {
+                satisfied |= (lit > 0) == solution[std::abs(lit)];
+            }
+        }
+        addClause(formula, literals);
+    }
+    return formula;
+}
+
+/**
+<summary>
+Generates a Sudoku puzzle: a shuffled complete grid with some cells given.
+</summary>
+<param name="order">The side of the grid, a perfect square such as 4, 9 or 16.</param>
+<param name="givens">The fraction of cells given as unit clauses.</param>
+<param name="seed">The random seed.</param>
+<returns>The formula, with answer 'S'; variable (r * order + c) * order + v + 1 puts value v + 1 in row r, column c.</returns>
+<remarks>
+The complete grid starts from the pattern (box * (r % box) + r / box + c) % order,
+which is valid, and is shuffled by permuting values, bands, stacks, and rows
+and columns within them; all of these keep it valid.
+</remarks>
+*/
+BooleanFormula InstanceGenerator::sudoku(int order, double givens, uint64_t seed)
+{
+    Random random(seed);
+    int box = static_cast<int>(std::lround(std::sqrt(static_cast<double>(order))));
+    auto variable = [order](int row, int col, int value)
+    {
+        return (row * order + col) * order + value + 1;
+    };
+
+    // Shuffled row and column orders: bands and stacks, then lines within each
+    auto lineOrder = [&]()
+    {
+        std::vector<int> groups(box), lines;
+        for (int g = 0; g < box; g++)
+        {
+            groups[g] = g;
+        }
+        shuffle(groups, random);
+        for (int g : groups)
+        {
+            std::vector<int> within(box);
+            for (int l = 0; l < box; l++)
+            {
+                within[l] = g * box + l;
+            }
+            shuffle(within, random);
+            lines.insert(lines.end(), within.begin(), within.end());
+        }
+        return lines;
+    };
+    std::vector<int> rows = lineOrder(), cols = lineOrder(), values(order);
+    for (int v = 0; v < order; v++)
+    {
+        values[v] = v;
+    }
+    shuffle(values, random);
+
+    BooleanFormula formula;
+    formula.setAnswer('S');
+    std::vector<int> literals;
+
+    // Every cell has a value
+    for (int r = 0; r < order; r++)
+    {
+        for (int c = 0; c < order; c++)
+        {
+            literals.clear();
+            for (int v = 0; v < order; v++)
+            {
+                literals.push_back(variable(r, c, v));
+            }
+            addClause(formula, literals);
+        }
+    }
+
+    // No value twice in a row, column or box
+    std::vector<std::vector<std::pair<int, int>>> units;
+    for (int i = 0; i < order; i++)
+    {
+        std::vector<std::pair<int, int>> row, col, square;
+        for (int j = 0; j < order; j++)
+        {
+            row.push_back({i, j});
+            col.push_back({j, i});
+            square.push_back({(i / box) * box + j / box, (i % box) * box + j % box});
+        }
+        units.push_back(row);
+        units.push_back(col);
+        units.push_back(square);
+    }
+    for (const auto &unit : units)
+    {
+        for (int v = 0; v < order; v++)
+        {
+            for (int a = 0; a < order; a++)
+            {
+                for (int b = a + 1; b < order; b++)
+                {
+                    addClause(formula, {-variable(unit[a].first, unit[a].second, v), -variable(unit[b].first, unit[b].second, v)});
+                }
+            }
+        }
+    }
+
+    // Reveal a random subset of the shuffled solution
+    std::vector<int> cells(order * order);
+    for (int cell = 0; cell < order * order; cell++)
+    {
+        cells[cell] = cell;
+    }
+    shuffle(cells, random);
+    int num_givens = static_cast<int>(std::lround(givens * order * order));
+    for (int g = 0; g < num_givens; g++)
+    {
+        int r = cells[g] / order, c = cells[g] % order;
+        int pattern = (box * (rows[r] % box) + rows[r] / box + cols[c]) % order;
+        addClause(formula, {variable(r, c, values[pattern])});
+    }
+    return formula;
+}
@@ -7,7 +7,8 @@ Constructor for the Literal class that initializes a literal with a variable and
 <param name="var">The variable associated with the literal.</param>
 <param name="val">The value of the literal.</param>
 */
-Literal::Literal(int var, BoolValue val) : variable(var), value(val) {}
+Literal::Literal(int var, BoolValue val)
+    : code((static_cast<uint32_t>(var) << 1) | (val == BoolValue::FALSE ? 1u : 0u)) {}
 
 /**
 <summary>
@@ -18,22 +19,17 @@ Evaluates the literal given its assignment.
 Returns the evaluation result of the literal given the assignment.
 </returns>
 <remarks>
-If the literal's value is TRUE, it returns the assignment value directly.
-If the literal's value is FALSE, it returns the negated value of the assignment.
-For unassigned literals, it returns BoolValue::UNASSIGNED.
+A positive literal returns the assignment as it is. A negative literal returns
+FALSE when its variable is TRUE and TRUE otherwise, so an unassigned variable
+counts as satisfying it, which is what BacktrackSolver's activity counts expect.
+The sign bit selects between the two without a branch.
 </remarks>
 */
 BoolValue Literal::evaluate(BoolValue assignment) const
 {
-    if (value == BoolValue::TRUE)
-    {
-        return assignment;
-    }
-    else if (value == BoolValue::FALSE)
-    {
-        return (assignment == BoolValue::TRUE) ? BoolValue::FALSE : BoolValue::TRUE;
-    }
-    return BoolValue::UNASSIGNED; // This line may not be necessary if literals are always TRUE or FALSE.
+    uint32_t value = static_cast<uint32_t>(assignment);
+    uint32_t negative = 0u - (code & 1);
+    return static_cast<BoolValue>((value & ~negative) | (static_cast<uint32_t>(value == 0) & negative));
 }
 
 /**
@@ -44,7 +40,7 @@ Retrieves the variable of the literal.
 */
 int Literal::getVariable() const
 {
-    return variable;
+    return static_cast<int>(code >> 1);
 }
 
 /**
@@ -55,7 +51,7 @@ Retrieves the value of the literal.
 */
 BoolValue Literal::getValue() const
 {
-    return value;
+    return static_cast<BoolValue>(code & 1);
 }
 
 /**
@@ -64,21 +60,14 @@ Returns a new literal that is the negation of the current one.
 </summary>
 <returns>A new literal which is the negation of the current one.</returns>
 <remarks>
-For a TRUE value, the negation will be FALSE, and vice versa.
-For unassigned literals, the negation remains UNASSIGNED.
+Flips the sign bit.
 </remarks>
 */
 Literal Literal::negate() const
 {
-    if (value == BoolValue::TRUE)
-    {
-        return Literal(variable, BoolValue::FALSE);
-    }
-    else if (value == BoolValue::FALSE)
-    {
-        return Literal(variable, BoolValue::TRUE);
-    }
-    return Literal(variable, BoolValue::UNASSIGNED);
+    Literal negated;
+    negated.code = code ^ 1;
+    return negated;
 }
 
 /**
@@ -91,14 +80,11 @@ Compares two literals to determine their order.
 Returns true if the lhs literal is "less than" the rhs literal, otherwise returns false.
 </returns>
 <remarks>
-Literals are compared first by their variables and then by their values.
+Literals are compared first by their variables and then by their values, the
+positive literal first, which is the order of their codes.
 </remarks>
 */
 bool operator<(const Literal &lhs, const Literal &rhs)
 {
-    if (lhs.getVariable() == rhs.getVariable())
-    {
-        return lhs.getValue() < rhs.getValue();
-    }
-    return lhs.getVariable() < rhs.getVariable();
+    return lhs.code < rhs.code;
 }
\ No newline at end of file
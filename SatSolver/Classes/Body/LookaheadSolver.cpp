@@ -0,0 +1,439 @@
+/**
+<summary>
+The LookaheadSolver class implements a march-style lookahead DPLL search, the
+engine for small, dense random formulas.
+</summary>
+*/
+#include "LookaheadSolver.h"
+#include <algorithm>
+
+namespace
+{
+    // Weight of a clause left with a given number of free literals: unit clauses
+    // force an assignment, and each extra literal makes a clause five times less binding
+    double reductionWeight(int free)
+    {
+        static const double weights[] = {0, 5, 1, 0.2, 0.04, 0.008, 0.0016};
+        return free < 7 ? weights[free] : 0;
+    }
+}
+
+// Constructor for the LookaheadSolver class
+LookaheadSolver::LookaheadSolver(const BooleanFormula &formula)
+    : num_vars(formula.getVariableCount())
+{
+    occurrences.resize(2 * num_vars);
+    values.assign(num_vars, 0);
+    implied_stamp.assign(2 * num_vars, 0);
+    clause_start.push_back(0);
+    std::vector<int> lits;
+    for (const Clause &clause : formula.getClauses())
+    {
+        lits.clear();
+        for (const Literal &lit : clause.getLiterals())
+        {
+            lits.push_back(2 * (lit.getVariable() - 1) + (lit.getValue() == BoolValue::FALSE ? 1 : 0));
+        }
+        std::sort(lits.begin(), lits.end());
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+
+        bool tautology = false;
+        for (size_t i = 1; i < lits.size(); i++)
+        {
+            tautology |= (lits[i] == (lits[i - 1] ^ 1));
+        }
+        if (lits.empty())
+        {
+            consistent = false;
+        }
+        if (tautology || lits.empty())
+        {
+            continue;
+        }
+        int index = numClauses();
+        for (int lit : lits)
+        {
+            occurrences[lit].push_back(index);
+            literals.push_back(lit);
+        }
+        clause_start.push_back(static_cast<int>(literals.size()));
+    }
+    num_true.assign(numClauses(), 0);
+    num_false.assign(numClauses(), 0);
+    clause_stamp.assign(numClauses(), 0);
+}
+
+/**
+<summary>
+Searches for a model.
+</summary>
+<returns>True if the formula is satisfiable, otherwise false.</returns>
+*/
+bool LookaheadSolver::solve()
+{
+    model.assign(num_vars, BoolValue::UNASSIGNED);
+    if (!consistent)
+    {
+        return false;
+    }
+    for (int c = 0; c < numClauses(); c++)
+    {
+        if (clause_start[c + 1] - clause_start[c] == 1)
+        {
+            int lit = literals[clause_start[c]];
+            if (value(lit) < 0)
+            {
+                return false;
+            }
+            if (value(lit) == 0)
+            {
+                assign(lit);
+            }
+        }
+    }
+    if (!propagate(false))
+    {
+        return false;
+    }
+    return search();
+}
+
+/**
+<summary>
+Assigns a literal TRUE; propagate() counts it into its clauses.
+</summary>
+<param name="lit">A free literal.</param>
+*/
+void LookaheadSolver::assign(int lit)
+{
+    values[lit >> 1] = (lit & 1) ? -1 : 1;
+    trail.push_back(lit);
+    num_propagations++;
+}
+
+/**
+<summary>
+Counts the pending trail literals into their clauses and assigns the last free
+literal of every clause left with one.
+</summary>
+<param name="scored">Whether to collect the clauses a FALSE literal reduced.</param>
+<returns>False on a clause with every literal FALSE, otherwise true.</returns>
+<remarks>
+A literal's clauses are always counted in full, even past a conflict, so that
+backtrackTo() can uncount exactly the counted part of the trail. Assignments
+still pending on the trail are seen through the values, so a clause is only
+unit if none of its literals is already TRUE.
+</remarks>
+*/
+bool LookaheadSolver::propagate(bool scored)
+{
+    bool conflict = false;
+    while (propagated < trail.size() && !conflict)
+    {
+        int lit = trail[propagated++];
+        for (int c : occurrences[lit])
+        {
+            if (num_true[c]++ == 0)
+            {
+                num_satisfied++;
+            }
+        }
+        for (int c : occurrences[lit ^ 1])
+        {
+            int free = clause_start[c + 1] - clause_start[c] - ++num_false[c];
+            if (num_true[c] > 0 || conflict)
+            {
+                continue;
+            }
+            if (free == 0)
+            {
+                conflict = true;
+            }
+            else if (free == 1)
+            {
+                int unit = -1;
+                bool satisfied = false;
+                for (int k = clause_start[c]; k < clause_start[c + 1]; k++)
+                {
+                    int v = value(literals[k]);
+                    satisfied |= v > 0;
+                    unit = v == 0 ? literals[k] : unit;
+                }
+                if (!satisfied)
+                {
+                    if (unit < 0)
+                    {
+                        conflict = true;
+                    }
+                    else
+                    {
+                        assign(unit);
+                    }
+                }
+            }
+            else if (scored)
+            {
+                reduced.push_back(c);
+            }
+        }
+    }
+    return !conflict;
+}
+
+/**
+<summary>
+Unassigns the trail back to a given length, uncounting what was counted.
+</summary>
+<param name="length">The trail length to keep.</param>
+*/
+void LookaheadSolver::backtrackTo(size_t length)
+{
+    while (trail.size() > length)
+    {
+        int lit = trail.back();
+        trail.pop_back();
+        if (trail.size() < propagated)
+        {
+            for (int c : occurrences[lit])
+            {
+                if (--num_true[c] == 0)
+                {
+                    num_satisfied--;
+                }
+            }
+            for (int c : occurrences[lit ^ 1])
+            {
+                num_false[c]--;
+            }
+        }
+        values[lit >> 1] = 0;
+    }
+    propagated = std::min(propagated, length);
+}
+
+/**
+<summary>
+Propagates one literal and measures the reduction, then undoes it.
+</summary>
+<param name="lit">A free literal.</param>
+<param name="score">Receives the weighted count of the clauses it shortened without satisfying.</param>
+<returns>1 if propagation conflicts, 2 if the propagation is an autarky and was kept, otherwise 0 and implied holds the literals it assigned.</returns>
+<remarks>
+The propagation is an autarky when every clause it put a FALSE literal in is
+satisfied by it as well: the clauses it touches are then all satisfied and the
+rest are untouched, so keeping it cannot lose a model.
+</remarks>
+*/
+int LookaheadSolver::lookahead(int lit, double &score)
+{
+    num_lookaheads++;
+    size_t mark = trail.size();
+    reduced.clear();
+    assign(lit);
+    if (!propagate(true))
+    {
+        backtrackTo(mark);
+        return 1;
+    }
+
+    // Every clause shortened and not satisfied counts once, by its final number of free literals
+    score = 0;
+    stamp++;
+    bool autarky = true;
+    for (int c : reduced)
+    {
+        if (num_true[c] == 0 && clause_stamp[c] != stamp)
+        {
+            clause_stamp[c] = stamp;
+            autarky = false;
+            score += reductionWeight(clause_start[c + 1] - clause_start[c] - num_false[c]);
+        }
+    }
+    if (autarky)
+    {
+        return 2;
+    }
+    implied.assign(trail.begin() + mark, trail.end());
+    backtrackTo(mark);
+    return 0;
+}
+
+/**
+<summary>
+Ranks the free variables by the clauses their literals occur in and keeps the best.
+</summary>
+<returns>The candidates, best first.</returns>
+<remarks>
+A polarity is rated by the clauses its assignment would shorten, weighted as in
+lookahead(), and a variable by the product of its two ratings, which favours
+variables that reduce the formula on both branches.
+</remarks>
+*/
+std::vector<int> LookaheadSolver::preselect() const
+{
+    std::vector<std::pair<double, int>> ranked;
+    for (int var = 0; var < num_vars; var++)
+    {
+        if (values[var] != 0)
+        {
+            continue;
+        }
+        double rating[2] = {0, 0};
+        for (int sign = 0; sign < 2; sign++)
+        {
+            for (int c : occurrences[2 * var + (sign ^ 1)])
+            {
+                if (num_true[c] == 0)
+                {
+                    rating[sign] += reductionWeight(clause_start[c + 1] - clause_start[c] - num_false[c] - 1);
+                }
+            }
+        }
+        ranked.push_back({rating[0] * rating[1] + rating[0] + rating[1], var});
+    }
+    size_t count = std::min(ranked.size(), std::max<size_t>(min_candidates, static_cast<size_t>(ranked.size() * candidate_fraction)));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), [](const std::pair<double, int> &a, const std::pair<double, int> &b)
+                      { return a.first > b.first || (a.first == b.first && a.second < b.second); });
+    std::vector<int> candidates;
+    for (size_t i = 0; i < count; i++)
+    {
+        candidates.push_back(ranked[i].second);
+    }
+    return candidates;
+}
+
+/**
+<summary>
+Looks ahead on the candidates until no more literals are forced, then picks the branch.
+</summary>
+<param name="branch">Receives the literal to try first, or -1 if every clause is satisfied.</param>
+<returns>False if the node was refuted, otherwise true.</returns>
+<remarks>
+A variable's two scores are mixed as 1024 * s+ * s- + s+ + s-, as march does,
+so a balanced split beats one that only reduces a lot on one side. The side that
+reduces less is tried first, being the likelier to hold a model.
+</remarks>
+*/
+bool LookaheadSolver::chooseBranch(int &branch)
+{
+    while (true)
+    {
+        branch = -1;
+        if (num_satisfied == numClauses())
+        {
+            return true;
+        }
+        bool forced = false;
+        double best = -1;
+        for (int var : preselect())
+        {
+            if (values[var] != 0)
+            {
+                continue;
+            }
+            double score[2];
+            int tried = 2 * var;
+            int result = lookahead(tried, score[0]);
+            unsigned positive_stamp = 0;
+            if (result == 0)
+            {
+                positive_stamp = ++stamp;
+                for (int lit : implied)
+                {
+                    implied_stamp[lit] = positive_stamp;
+                }
+                tried = 2 * var + 1;
+                result = lookahead(tried, score[1]);
+            }
+            if (result == 2)
+            {
+                num_autarkies++;
+                forced = true;
+                continue;
+            }
+            if (result == 1)
+            {
+                // A failed literal: its negation holds at this node
+                num_failed_literals++;
+                forced = true;
+                assign(tried ^ 1);
+                if (!propagate(false))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            // Literals both polarities imply hold at this node
+            bool necessary = false;
+            for (int lit : implied)
+            {
+                if (implied_stamp[lit] == positive_stamp && value(lit) == 0)
+                {
+                    assign(lit);
+                    num_necessary++;
+                    necessary = true;
+                }
+            }
+            if (necessary)
+            {
+                forced = true;
+                if (!propagate(false))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            double mixed = 1024 * score[0] * score[1] + score[0] + score[1];
+            if (mixed > best)
+            {
+                best = mixed;
+                branch = score[0] <= score[1] ? 2 * var : 2 * var + 1;
+            }
+        }
+        if (!forced)
+        {
+            return true;
+        }
+    }
+}
+
+/**
+<summary>
+Recursive search below the current node.
+</summary>
+<returns>True if a model was found, otherwise false.</returns>
+*/
+bool LookaheadSolver::search()
+{
+    size_t mark = trail.size();
+    int branch;
+    if (!chooseBranch(branch))
+    {
+        backtrackTo(mark);
+        return false;
+    }
+    if (branch < 0)
+    {
+        for (int var = 0; var < num_vars; var++)
+        {
+            model[var] = values[var] > 0 ? BoolValue::TRUE : BoolValue::FALSE;
+        }
+        return true;
+    }
+
+    num_decisions++;
+    size_t node = trail.size();
+    for (int lit : {branch, branch ^ 1})
+    {
+        assign(lit);
+        if (propagate(false) && search())
+        {
+            return true;
+        }
+        backtrackTo(node);
+    }
+    backtrackTo(mark);
+    return false;
+}
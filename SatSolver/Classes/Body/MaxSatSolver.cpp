@@ -0,0 +1,413 @@
+#include "MaxSatSolver.h"
+#include "Tracer.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+// Constructor for the MaxSatSolver class
+MaxSatSolver::MaxSatSolver(const BooleanFormula &formula, bool stratify)
+    : formula(formula), stratify(stratify), best_model(formula.getVariableCount(), BoolValue::UNASSIGNED)
+{
+    for (size_t var = 0; var < best_model.size(); var++)
+    {
+        sat.newVariable();
+    }
+    // Selectors are tried TRUE first, so even the first model satisfies many soft clauses
+    sat.setDefaultPhase(true);
+
+    const std::vector<Clause> &clauses = formula.getClauses();
+    std::vector<int> literals;
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        unsigned long long weight = formula.isWeighted() ? formula.getWeights()[i] : 1;
+        bool hard = formula.isWeighted() && formula.getHardWeight() != 0 && weight >= formula.getHardWeight();
+        literals.clear();
+        for (const Literal &lit : clauses[i].getLiterals())
+        {
+            literals.push_back(lit.getValue() == BoolValue::FALSE ? -lit.getVariable() : lit.getVariable());
+        }
+
+        if (hard)
+        {
+            hard_consistent = sat.addClause(literals) && hard_consistent;
+            continue;
+        }
+        if (weight == 0)
+        {
+            continue;
+        }
+        soft_clauses.push_back({i, weight});
+        if (literals.empty())
+        {
+            base_cost += weight;
+        }
+        else if (literals.size() == 1)
+        {
+            // A unit soft clause is its own selector
+            weights[literals[0]] += weight;
+        }
+        else
+        {
+            int selector = sat.newVariable();
+            literals.push_back(-selector);
+            sat.addClause(literals);
+            weights[selector] += weight;
+        }
+    }
+    lower_bound = base_cost;
+}
+
+/**
+<summary>
+Searches for an optimal assignment.
+</summary>
+<param name="on_improvement">Called with the cost, the lower bound and the model each time a better model is found.</param>
+<returns>True if some assignment satisfies the hard clauses, otherwise false.</returns>
+*/
+bool MaxSatSolver::solve(const ImprovementCallback &on_improvement)
+{
+    if (!hard_consistent)
+    {
+        return false;
+    }
+
+    // The watchdog interrupts the SAT solver once the time limit has passed
+    std::mutex mtx;
+    std::condition_variable finished_cv;
+    bool finished = false;
+    std::thread watchdog;
+    if (time_limit.count() > 0)
+    {
+        watchdog = std::thread([&]()
+                               {
+                                   std::unique_lock<std::mutex> lock(mtx);
+                                   if (!finished_cv.wait_for(lock, time_limit, [&]() { return finished; }))
+                                   {
+                                       sat.interrupt();
+                                   } });
+    }
+
+    search(on_improvement);
+
+    if (watchdog.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            finished = true;
+        }
+        finished_cv.notify_all();
+        watchdog.join();
+    }
+    return found;
+}
+
+/**
+<summary>
+Runs the core-guided search until it proves optimality or is interrupted.
+</summary>
+<param name="on_improvement">Called each time a better model is found.</param>
+*/
+void MaxSatSolver::search(const ImprovementCallback &on_improvement)
+{
+    // A first model, of the hard clauses alone, gives an upper bound to report early
+    num_sat_calls++;
+    if (sat.solveLimited() != BoolValue::TRUE)
+    {
+        return;
+    }
+    considerModel(on_improvement);
+
+    unsigned long long stratum = 1;
+    if (stratify && !weights.empty())
+    {
+        for (const auto &entry : weights)
+        {
+            stratum = std::max(stratum, entry.second);
+        }
+    }
+
+    std::vector<int> assumptions;
+    while (best_cost > lower_bound)
+    {
+        assumptions.clear();
+        for (const auto &entry : weights)
+        {
+            if (entry.second >= stratum)
+            {
+                assumptions.push_back(entry.first);
+            }
+        }
+
+        num_sat_calls++;
+        BoolValue result = sat.solveLimited(assumptions);
+        if (result == BoolValue::UNASSIGNED)
+        {
+            return; // Out of time; the best model so far stands
+        }
+        if (result == BoolValue::TRUE)
+        {
+            considerModel(on_improvement);
+            unsigned long long next = nextStratum(stratum);
+            if (next == 0)
+            {
+                // Every assumption held, so no cheaper model exists
+                lower_bound = best_cost;
+                break;
+            }
+            stratum = next;
+            continue;
+        }
+
+        std::vector<int> core = sat.getFailedAssumptions();
+        if (core.empty())
+        {
+            return; // Cannot happen once the hard clauses had a model
+        }
+        trimCore(core);
+        relaxCore(core);
+    }
+    optimal = true;
+}
+
+/**
+<summary>
+Keeps a model of the SAT solver if it is the best so far.
+</summary>
+<param name="on_improvement">Called if the model is kept.</param>
+*/
+void MaxSatSolver::considerModel(const ImprovementCallback &on_improvement)
+{
+    // Drop the selector and totalizer variables
+    std::vector<BoolValue> model(sat.getAssignment().begin(), sat.getAssignment().begin() + formula.getVariableCount());
+    unsigned long long cost = costOf(model);
+    if (found && cost >= best_cost)
+    {
+        return;
+    }
+    found = true;
+    best_cost = cost;
+    best_model = std::move(model);
+    Tracer::instant("maxsat improvement", static_cast<long long>(cost));
+    if (on_improvement)
+    {
+        on_improvement(best_cost, lower_bound, best_model);
+    }
+}
+
+/**
+<summary>
+Computes the weight of the soft clauses a model violates.
+</summary>
+<param name="model">One BoolValue per variable of the formula.</param>
+<returns>The cost.</returns>
+*/
+unsigned long long MaxSatSolver::costOf(const std::vector<BoolValue> &model) const
+{
+    unsigned long long cost = 0;
+    for (const auto &soft : soft_clauses)
+    {
+        if (formula.getClauses()[soft.first].evaluate(model) != BoolValue::TRUE)
+        {
+            cost += soft.second;
+        }
+    }
+    return cost;
+}
+
+/**
+<summary>
+Pays for an unsatisfiable core and relaxes it.
+</summary>
+<param name="core">The failed assumptions.</param>
+<remarks>
+The least weight w of the core is added to the lower bound and taken off each
+of its assumptions. Violating one of them is then paid for, and a totalizer
+over their violations gets the assumption "at most one" with weight w. A core
+assumption that is itself a totalizer bound "at most k" is followed by the
+bound "at most k + 1" with weight w.
+</remarks>
+*/
+void MaxSatSolver::relaxCore(const std::vector<int> &core)
+{
+    num_cores++;
+    Tracer::instant("maxsat core", static_cast<long long>(core.size()));
+
+    unsigned long long min_weight = weights[core[0]];
+    for (int lit : core)
+    {
+        min_weight = std::min(min_weight, weights[lit]);
+    }
+    lower_bound += min_weight;
+
+    std::vector<int> violations;
+    for (int lit : core)
+    {
+        if ((weights[lit] -= min_weight) == 0)
+        {
+            weights.erase(lit);
+        }
+        violations.push_back(-lit);
+
+        auto bound = bounds.find(lit);
+        if (bound != bounds.end())
+        {
+            int root = bound->second.first, k = bound->second.second + 1;
+            if (extendTotalizer(root, k + 1))
+            {
+                int next = -totalizer_nodes[root].outputs[k];
+                weights[next] += min_weight;
+                bounds[next] = {root, k};
+            }
+        }
+    }
+
+    if (violations.size() == 1)
+    {
+        sat.addClause(violations); // The assumption can never hold
+        return;
+    }
+    int root = buildTotalizer(violations);
+    extendTotalizer(root, 2);
+    int at_most_one = -totalizer_nodes[root].outputs[1];
+    weights[at_most_one] += min_weight;
+    bounds[at_most_one] = {root, 1};
+}
+
+/**
+<summary>
+Shrinks a core by solving again under its own assumptions.
+</summary>
+<param name="core">The core, replaced by the smaller cores found.</param>
+<remarks>
+Conflict analysis tends to return more assumptions than needed; a solve under
+the core alone often refutes a subset. Stops after a few rounds, when a round
+removes nothing, or when the solve does not end in a core.
+</remarks>
+*/
+void MaxSatSolver::trimCore(std::vector<int> &core)
+{
+    for (int round = 0; round < 3 && core.size() > 1; round++)
+    {
+        num_sat_calls++;
+        if (sat.solveLimited(core) != BoolValue::FALSE || sat.getFailedAssumptions().size() >= core.size())
+        {
+            return;
+        }
+        core = sat.getFailedAssumptions();
+    }
+}
+
+/**
+<summary>
+Builds the tree of a totalizer counting how many of the inputs are true.
+</summary>
+<param name="inputs">The DIMACS literals to count.</param>
+<returns>The index of the root node; its outputs are added by extendTotalizer().</returns>
+*/
+int MaxSatSolver::buildTotalizer(const std::vector<int> &inputs)
+{
+    std::vector<int> level;
+    for (int input : inputs)
+    {
+        totalizer_nodes.push_back({-1, -1, 1, {input}});
+        level.push_back(static_cast<int>(totalizer_nodes.size()) - 1);
+    }
+
+    // Pair nodes up a balanced tree
+    while (level.size() > 1)
+    {
+        std::vector<int> next;
+        for (size_t n = 0; n + 1 < level.size(); n += 2)
+        {
+            int size = totalizer_nodes[level[n]].size + totalizer_nodes[level[n + 1]].size;
+            totalizer_nodes.push_back({level[n], level[n + 1], size, {}});
+            next.push_back(static_cast<int>(totalizer_nodes.size()) - 1);
+        }
+        if (level.size() % 2 == 1)
+        {
+            next.push_back(level.back());
+        }
+        level = std::move(next);
+    }
+    return level[0];
+}
+
+/**
+<summary>
+Makes sure a totalizer node has its first outputs, encoding them on demand.
+</summary>
+<param name="node">The index of the node.</param>
+<param name="count">The number of outputs needed.</param>
+<returns>False if the node counts fewer inputs than that, otherwise true.</returns>
+<remarks>
+Output s - 1 of a node whose children have outputs a and b gets the clauses
+(-a[i - 1] | -b[j - 1] | r[s - 1]) for i + j = s, dropping the literal of a
+side that counts nothing. Only the direction forcing outputs true is encoded;
+that is the one the "at most" assumptions need. Encoding outputs only as the
+bounds grow keeps large cores from costing a quadratic number of clauses.
+</remarks>
+*/
+bool MaxSatSolver::extendTotalizer(int node, int count)
+{
+    if (count > totalizer_nodes[node].size)
+    {
+        return false;
+    }
+    if (static_cast<int>(totalizer_nodes[node].outputs.size()) >= count)
+    {
+        return true;
+    }
+
+    int left = totalizer_nodes[node].left, right = totalizer_nodes[node].right;
+    extendTotalizer(left, std::min(count, totalizer_nodes[left].size));
+    extendTotalizer(right, std::min(count, totalizer_nodes[right].size));
+
+    std::vector<int> clause;
+    for (int s = static_cast<int>(totalizer_nodes[node].outputs.size()) + 1; s <= count; s++)
+    {
+        int output = sat.newVariable();
+        const std::vector<int> &a = totalizer_nodes[left].outputs, &b = totalizer_nodes[right].outputs;
+        for (int i = 0; i <= std::min(s, static_cast<int>(a.size())); i++)
+        {
+            int j = s - i;
+            if (j > static_cast<int>(b.size()))
+            {
+                continue;
+            }
+            clause.clear();
+            if (i > 0)
+            {
+                clause.push_back(-a[i - 1]);
+            }
+            if (j > 0)
+            {
+                clause.push_back(-b[j - 1]);
+            }
+            clause.push_back(output);
+            sat.addClause(clause);
+        }
+        totalizer_nodes[node].outputs.push_back(output);
+    }
+    return true;
+}
+
+/**
+<summary>
+Gets the next lower weight among the assumptions.
+</summary>
+<param name="stratum">The current weight threshold.</param>
+<returns>The largest assumption weight below the threshold, or 0 if there is none.</returns>
+*/
+unsigned long long MaxSatSolver::nextStratum(unsigned long long stratum) const
+{
+    unsigned long long next = 0;
+    for (const auto &entry : weights)
+    {
+        if (entry.second < stratum)
+        {
+            next = std::max(next, entry.second);
+        }
+    }
+    return next;
+}
@@ -0,0 +1,183 @@
+/**
+<summary>
+The ModelCount class is an arbitrary-precision unsigned integer used to hold
+model counts, which overflow 64 bits as soon as a formula has more than 64
+unconstrained variables.
+</summary>
+*/
+#include "ModelCount.h"
+#include <algorithm>
+
+/**
+<summary>
+Constructor for the ModelCount class.
+</summary>
+<param name="value">The initial value of the count.</param>
+*/
+ModelCount::ModelCount(unsigned long long value)
+{
+    while (value != 0)
+    {
+        limbs.push_back(static_cast<uint32_t>(value));
+        value >>= 32;
+    }
+}
+
+/**
+<summary>
+Creates a count equal to two raised to the given power.
+</summary>
+<param name="exponent">The power of two.</param>
+<returns>The count 2^exponent.</returns>
+*/
+ModelCount ModelCount::powerOfTwo(int exponent)
+{
+    ModelCount result;
+    result.limbs.assign(exponent / 32 + 1, 0);
+    result.limbs.back() = 1u << (exponent % 32);
+    return result;
+}
+
+/**
+<summary>
+Adds another count to this one.
+</summary>
+<param name="other">The count to add.</param>
+<returns>A reference to this count.</returns>
+*/
+ModelCount &ModelCount::operator+=(const ModelCount &other)
+{
+    if (limbs.size() < other.limbs.size())
+    {
+        limbs.resize(other.limbs.size(), 0);
+    }
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < limbs.size(); i++)
+    {
+        uint64_t sum = carry + limbs[i] + (i < other.limbs.size() ? other.limbs[i] : 0);
+        limbs[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+        if (carry == 0 && i >= other.limbs.size())
+        {
+            break;
+        }
+    }
+    if (carry != 0)
+    {
+        limbs.push_back(static_cast<uint32_t>(carry));
+    }
+    return *this;
+}
+
+/**
+<summary>
+Multiplies this count by another one using schoolbook multiplication.
+</summary>
+<param name="other">The count to multiply by.</param>
+<returns>A reference to this count.</returns>
+*/
+ModelCount &ModelCount::operator*=(const ModelCount &other)
+{
+    if (isZero() || other.isZero())
+    {
+        limbs.clear();
+        return *this;
+    }
+
+    std::vector<uint32_t> product(limbs.size() + other.limbs.size(), 0);
+    for (size_t i = 0; i < limbs.size(); i++)
+    {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < other.limbs.size(); j++)
+        {
+            uint64_t cur = product[i + j] + static_cast<uint64_t>(limbs[i]) * other.limbs[j] + carry;
+            product[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        product[i + other.limbs.size()] = static_cast<uint32_t>(carry);
+    }
+    limbs.swap(product);
+    trim();
+    return *this;
+}
+
+/**
+<summary>
+Compares the count against a machine-sized value.
+</summary>
+<param name="value">The value to compare against.</param>
+<returns>True if the count is greater than or equal to the value.</returns>
+*/
+bool ModelCount::atLeast(unsigned long long value) const
+{
+    if (limbs.size() > 2)
+    {
+        return true;
+    }
+    unsigned long long own = 0;
+    for (size_t i = limbs.size(); i-- > 0;)
+    {
+        own = (own << 32) | limbs[i];
+    }
+    return own >= value;
+}
+
+/**
+<summary>
+Converts the count to its decimal representation.
+</summary>
+<returns>The count as a decimal string.</returns>
+<remarks>
+Repeatedly divides a copy of the limbs by 10^9 and emits nine digits at a time.
+</remarks>
+*/
+std::string ModelCount::toString() const
+{
+    if (isZero())
+    {
+        return "0";
+    }
+
+    std::vector<uint32_t> digits = limbs;
+    std::string result;
+    while (!digits.empty())
+    {
+        uint64_t remainder = 0;
+        for (size_t i = digits.size(); i-- > 0;)
+        {
+            uint64_t cur = (remainder << 32) | digits[i];
+            digits[i] = static_cast<uint32_t>(cur / 1000000000u);
+            remainder = cur % 1000000000u;
+        }
+        while (!digits.empty() && digits.back() == 0)
+        {
+            digits.pop_back();
+        }
+
+        for (int k = 0; k < 9; k++)
+        {
+            result.push_back(static_cast<char>('0' + remainder % 10));
+            remainder /= 10;
+            if (digits.empty() && remainder == 0)
+            {
+                break;
+            }
+        }
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+/**
+<summary>
+Removes leading zero limbs so that zero is represented by an empty vector.
+</summary>
+*/
+void ModelCount::trim()
+{
+    while (!limbs.empty() && limbs.back() == 0)
+    {
+        limbs.pop_back();
+    }
+}
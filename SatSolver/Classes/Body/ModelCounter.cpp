@@ -0,0 +1,360 @@
+/**
+<summary>
+The ModelCounter class provides an exact #SAT counter. It branches like DPLL,
+splits the residual formula into variable-disjoint components whose counts
+multiply, and caches component counts keyed by the hashed residual formula so
+that components reached through different branches are only counted once.
+</summary>
+*/
+#include "ModelCounter.h"
+#include <algorithm>
+#include <cstdlib>
+
+// Constructor for the ModelCounter class
+ModelCounter::ModelCounter(const BooleanFormula &formula)
+{
+    int varCount = formula.getVariableCount();
+    values.resize(varCount + 1, 0);
+    parent.resize(varCount + 1, 0);
+    occurrence_stamp.resize(varCount + 1, 0);
+
+    for (const Clause &clause : formula.getClauses())
+    {
+        std::vector<int> lits;
+        for (const Literal &lit : clause.getLiterals())
+        {
+            lits.push_back(lit.getValue() == BoolValue::TRUE ? lit.getVariable() : -lit.getVariable());
+        }
+        clauses.push_back(lits);
+    }
+}
+
+/**
+<summary>
+Computes the exact number of models of the formula over all of its variables.
+</summary>
+<returns>The number of satisfying assignments.</returns>
+*/
+ModelCount ModelCounter::count()
+{
+    std::vector<int> clause_ids(clauses.size());
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        clause_ids[i] = i;
+    }
+    std::vector<int> vars;
+    for (size_t v = 1; v < values.size(); v++)
+    {
+        vars.push_back(v);
+    }
+    return countComponent(clause_ids, vars);
+}
+
+/**
+<summary>
+Counts the models of a residual component under the current partial assignment.
+</summary>
+<param name="clause_ids">The clauses belonging to the component.</param>
+<param name="vars">The unassigned variables belonging to the component.</param>
+<returns>The number of assignments to vars that satisfy the clauses.</returns>
+*/
+ModelCount ModelCounter::countComponent(const std::vector<int> &clause_ids, const std::vector<int> &vars)
+{
+    size_t trail_mark = trail.size();
+    if (!propagate(clause_ids))
+    {
+        undo(trail_mark);
+        return ModelCount(0);
+    }
+
+    // Keep the clauses that are not yet satisfied and mark the variables they mention
+    current_stamp++;
+    std::vector<int> active;
+    for (int id : clause_ids)
+    {
+        bool satisfied = false;
+        for (int lit : clauses[id])
+        {
+            if (literalValue(lit) > 0)
+            {
+                satisfied = true;
+                break;
+            }
+        }
+        if (satisfied)
+        {
+            continue;
+        }
+        active.push_back(id);
+        for (int lit : clauses[id])
+        {
+            if (literalValue(lit) == 0)
+            {
+                occurrence_stamp[std::abs(lit)] = current_stamp;
+            }
+        }
+    }
+
+    // Unassigned variables that no active clause mentions are unconstrained
+    int free_vars = 0;
+    std::vector<int> bound_vars;
+    for (int var : vars)
+    {
+        if (values[var] != 0)
+        {
+            continue;
+        }
+        if (occurrence_stamp[var] == current_stamp)
+        {
+            bound_vars.push_back(var);
+            parent[var] = var;
+        }
+        else
+        {
+            free_vars++;
+        }
+    }
+    ModelCount result = ModelCount::powerOfTwo(free_vars);
+    if (active.empty())
+    {
+        undo(trail_mark);
+        return result;
+    }
+
+    // Group the active clauses into variable-disjoint components
+    for (int id : active)
+    {
+        int first = 0;
+        for (int lit : clauses[id])
+        {
+            if (literalValue(lit) != 0)
+            {
+                continue;
+            }
+            int root = findRoot(std::abs(lit));
+            if (first == 0)
+            {
+                first = root;
+            }
+            else if (root != first)
+            {
+                parent[root] = first;
+            }
+        }
+    }
+
+    std::vector<int> roots;
+    std::vector<std::vector<int>> component_clauses;
+    std::vector<std::vector<int>> component_vars;
+    auto componentOf = [&](int var) -> size_t
+    {
+        int root = findRoot(var);
+        size_t index = std::find(roots.begin(), roots.end(), root) - roots.begin();
+        if (index == roots.size())
+        {
+            roots.push_back(root);
+            component_clauses.emplace_back();
+            component_vars.emplace_back();
+        }
+        return index;
+    };
+    for (int var : bound_vars)
+    {
+        component_vars[componentOf(var)].push_back(var);
+    }
+    for (int id : active)
+    {
+        for (int lit : clauses[id])
+        {
+            if (literalValue(lit) == 0)
+            {
+                component_clauses[componentOf(std::abs(lit))].push_back(id);
+                break;
+            }
+        }
+    }
+    if (roots.size() > 1)
+    {
+        num_component_splits++;
+    }
+
+    for (size_t c = 0; c < roots.size() && !result.isZero(); c++)
+    {
+        std::vector<int> key = residualKey(component_clauses[c]);
+        auto cached = cache.find(key);
+        if (cached != cache.end())
+        {
+            num_cache_hits++;
+            result *= cached->second;
+            continue;
+        }
+
+        // Branch on the variable occurring most often in the component
+        std::vector<int> occurrences(values.size(), 0);
+        for (int id : component_clauses[c])
+        {
+            for (int lit : clauses[id])
+            {
+                if (literalValue(lit) == 0)
+                {
+                    occurrences[std::abs(lit)]++;
+                }
+            }
+        }
+        int branch_var = component_vars[c][0];
+        for (int var : component_vars[c])
+        {
+            if (occurrences[var] > occurrences[branch_var])
+            {
+                branch_var = var;
+            }
+        }
+
+        ModelCount component_count;
+        for (int polarity : {1, -1})
+        {
+            num_decisions++;
+            size_t branch_mark = trail.size();
+            assign(polarity * branch_var);
+            component_count += countComponent(component_clauses[c], component_vars[c]);
+            undo(branch_mark);
+        }
+
+        if (cache.size() < max_cache_entries)
+        {
+            cache.emplace(std::move(key), component_count);
+        }
+        result *= component_count;
+    }
+
+    undo(trail_mark);
+    return result;
+}
+
+/**
+<summary>
+Runs unit propagation restricted to the given clauses.
+</summary>
+<param name="clause_ids">The clauses to propagate over.</param>
+<returns>True if no clause became falsified, otherwise false.</returns>
+*/
+bool ModelCounter::propagate(const std::vector<int> &clause_ids)
+{
+    bool change = true;
+    while (change)
+    {
+        change = false;
+        for (int id : clause_ids)
+        {
+            int unassignedCount = 0;
+            int unassignedLiteral = 0;
+            for (int lit : clauses[id])
+            {
+                int val = literalValue(lit);
+                if (val > 0)
+                {
+                    unassignedCount = -1;
+                    break;
+                }
+                if (val == 0)
+                {
+                    unassignedCount++;
+                    unassignedLiteral = lit;
+                }
+            }
+
+            if (unassignedCount == 0)
+            {
+                return false;
+            }
+            if (unassignedCount == 1)
+            {
+                assign(unassignedLiteral);
+                change = true;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Builds the cache key of a component: its residual clauses with literals and
+clauses sorted.
+</summary>
+<param name="clause_ids">The clauses belonging to the component.</param>
+<returns>The canonical residual formula, clauses separated by zeros.</returns>
+*/
+std::vector<int> ModelCounter::residualKey(const std::vector<int> &clause_ids) const
+{
+    std::vector<std::vector<int>> residual;
+    for (int id : clause_ids)
+    {
+        std::vector<int> lits;
+        for (int lit : clauses[id])
+        {
+            if (literalValue(lit) == 0)
+            {
+                lits.push_back(lit);
+            }
+        }
+        std::sort(lits.begin(), lits.end());
+        residual.push_back(lits);
+    }
+    std::sort(residual.begin(), residual.end());
+    residual.erase(std::unique(residual.begin(), residual.end()), residual.end());
+
+    std::vector<int> key;
+    for (const std::vector<int> &lits : residual)
+    {
+        key.insert(key.end(), lits.begin(), lits.end());
+        key.push_back(0);
+    }
+    return key;
+}
+
+/**
+<summary>
+Hashes a residual formula key (FNV-1a over the literal stream).
+</summary>
+<param name="key">The key to hash.</param>
+<returns>The hash value.</returns>
+*/
+size_t ModelCounter::KeyHash::operator()(const std::vector<int> &key) const
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (int lit : key)
+    {
+        hash ^= static_cast<uint32_t>(lit);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+// Assigns a literal TRUE and records it on the trail
+void ModelCounter::assign(int literal)
+{
+    values[std::abs(literal)] = literal > 0 ? 1 : -1;
+    trail.push_back(std::abs(literal));
+}
+
+// Unassigns every variable assigned after the trail mark
+void ModelCounter::undo(size_t trail_mark)
+{
+    while (trail.size() > trail_mark)
+    {
+        values[trail.back()] = 0;
+        trail.pop_back();
+    }
+}
+
+// Finds the union-find representative of a variable, halving paths as it goes
+int ModelCounter::findRoot(int var)
+{
+    while (parent[var] != var)
+    {
+        parent[var] = parent[parent[var]];
+        var = parent[var];
+    }
+    return var;
+}
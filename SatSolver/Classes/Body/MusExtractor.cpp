@@ -0,0 +1,325 @@
+/**
+<summary>
+The MusExtractor class extracts a minimal unsatisfiable subset of the clauses of
+an unsatisfiable formula on incremental CdclSolvers.
+</summary>
+*/
+#include "MusExtractor.h"
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+
+// Constructor for the MusExtractor class
+MusExtractor::MusExtractor(const BooleanFormula &formula, int num_workers)
+    : num_workers(std::max(1, num_workers)), num_vars(formula.getVariableCount()),
+      model(num_vars, BoolValue::UNASSIGNED)
+{
+    occurrences.resize(2 * num_vars);
+    for (const Clause &clause : formula.getClauses())
+    {
+        int index = static_cast<int>(clauses.size());
+        clauses.emplace_back();
+        for (const Literal &lit : clause.getLiterals())
+        {
+            bool negative = lit.getValue() == BoolValue::FALSE;
+            clauses.back().push_back(negative ? -lit.getVariable() : lit.getVariable());
+            occurrences[2 * (lit.getVariable() - 1) + (negative ? 1 : 0)].push_back(index);
+        }
+    }
+    status.assign(clauses.size(), Status::UNKNOWN);
+    in_flight.assign(clauses.size(), 0);
+}
+
+/**
+<summary>
+Decides the formula and, if it is unsatisfiable, extracts an MUS.
+</summary>
+<returns>True if the formula is unsatisfiable, otherwise false.</returns>
+<remarks>
+Every clause test assumes the selectors of the clauses still undecided; the
+decided ones are fixed by unit clauses, so the solvers can simplify with them.
+</remarks>
+*/
+bool MusExtractor::extract()
+{
+    workers.resize(1);
+    workers[0].sat = buildSolver();
+    CdclSolver &sat = *workers[0].sat;
+
+    std::vector<int> core;
+    for (size_t c = 0; c < clauses.size(); c++)
+    {
+        core.push_back(selectorOf(static_cast<int>(c)));
+        remaining.push_back(static_cast<int>(c));
+    }
+    num_sat_calls++;
+    if (sat.solveLimited(core) == BoolValue::TRUE)
+    {
+        model = sat.getAssignment();
+        model.resize(num_vars);
+        return false;
+    }
+
+    // Clause-set refinement: solve the core alone until it stops shrinking
+    core = sat.getFailedAssumptions();
+    while (true)
+    {
+        refine(core);
+        num_sat_calls++;
+        if (sat.solveLimited(core) != BoolValue::FALSE || sat.getFailedAssumptions().size() >= core.size())
+        {
+            break;
+        }
+        core = sat.getFailedAssumptions();
+    }
+    remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](int c)
+                                   { return status[c] != Status::UNKNOWN; }),
+                    remaining.end());
+    initial_core_size = static_cast<int>(remaining.size());
+
+    // The other workers build their solvers on their own threads
+    workers.resize(std::min<size_t>(num_workers, std::max<size_t>(1, remaining.size())));
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers.size(); w++)
+    {
+        threads.emplace_back([this, w]()
+                             {
+                                 workers[w].sat = buildSolver();
+                                 trim(workers[w]);
+                             });
+    }
+    trim(workers[0]);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t c = 0; c < clauses.size(); c++)
+    {
+        if (status[c] == Status::CRITICAL)
+        {
+            mus.push_back(static_cast<int>(c));
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Builds a solver of the formula with every clause relaxed by its selector.
+</summary>
+<returns>The solver.</returns>
+*/
+std::unique_ptr<CdclSolver> MusExtractor::buildSolver() const
+{
+    std::unique_ptr<CdclSolver> sat(new CdclSolver());
+    for (size_t var = 0; var < num_vars + clauses.size(); var++)
+    {
+        sat->newVariable();
+    }
+    std::vector<int> literals;
+    for (size_t c = 0; c < clauses.size(); c++)
+    {
+        literals = clauses[c];
+        literals.push_back(-selectorOf(static_cast<int>(c)));
+        sat->addClause(literals);
+    }
+    return sat;
+}
+
+/**
+<summary>
+Tests clauses until every clause is decided.
+</summary>
+<param name="worker">The worker's solver.</param>
+<remarks>
+A worker takes the first undecided clause no other worker is testing, and waits
+while there is none but some test may still leave clauses undecided.
+</remarks>
+*/
+void MusExtractor::trim(Worker &worker)
+{
+    std::vector<int> assumptions;
+    std::vector<int> pending;
+    std::vector<BoolValue> assignment;
+    while (true)
+    {
+        int candidate = -1;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            while (true)
+            {
+                while (next_candidate < remaining.size() && status[remaining[next_candidate]] != Status::UNKNOWN)
+                {
+                    next_candidate++;
+                }
+                for (size_t i = next_candidate; i < remaining.size() && candidate < 0; i++)
+                {
+                    if (status[remaining[i]] == Status::UNKNOWN && !in_flight[remaining[i]])
+                    {
+                        candidate = remaining[i];
+                    }
+                }
+                if (candidate >= 0 || num_in_flight == 0)
+                {
+                    break;
+                }
+                changed.wait(lock);
+            }
+            if (candidate < 0)
+            {
+                return;
+            }
+            in_flight[candidate] = 1;
+            num_in_flight++;
+
+            assumptions.clear();
+            for (int c : remaining)
+            {
+                if (status[c] == Status::UNKNOWN && c != candidate)
+                {
+                    assumptions.push_back(selectorOf(c));
+                }
+            }
+            pending.assign(fixed.begin() + worker.fixed_added, fixed.end());
+            worker.fixed_added = fixed.size();
+        }
+
+        for (int selector : pending)
+        {
+            worker.sat->addClause(std::vector<int>{selector});
+        }
+        BoolValue result = worker.sat->solveLimited(assumptions);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        num_sat_calls++;
+        in_flight[candidate] = 0;
+        num_in_flight--;
+        if (status[candidate] == Status::UNKNOWN)
+        {
+            if (result == BoolValue::TRUE)
+            {
+                status[candidate] = Status::CRITICAL;
+                fixed.push_back(selectorOf(candidate));
+                assignment = worker.sat->getAssignment();
+                assignment.resize(num_vars);
+                for (BoolValue &value : assignment)
+                {
+                    value = value == BoolValue::TRUE ? BoolValue::TRUE : BoolValue::FALSE;
+                }
+                rotate(candidate, assignment);
+            }
+            else
+            {
+                // The core still proves the set without the candidate unsatisfiable if none of it was dropped since
+                const std::vector<int> &core = worker.sat->getFailedAssumptions();
+                bool valid = true;
+                for (int selector : core)
+                {
+                    valid &= status[selector - num_vars - 1] != Status::REMOVED;
+                }
+                if (valid)
+                {
+                    status[candidate] = Status::REMOVED;
+                    fixed.push_back(-selectorOf(candidate));
+                    refine(core);
+                }
+                else
+                {
+                    num_retests++;
+                }
+            }
+        }
+        changed.notify_all();
+    }
+}
+
+/**
+<summary>
+Marks the undecided clauses of the set outside a core REMOVED; the caller holds mtx.
+</summary>
+<param name="core">The failed selector literals.</param>
+<remarks>
+Critical clauses never appear in a core, being fixed rather than assumed, but
+they are part of the unsatisfiable set it proves and are kept.
+</remarks>
+*/
+void MusExtractor::refine(const std::vector<int> &core)
+{
+    std::vector<char> in_core(clauses.size(), 0);
+    for (int selector : core)
+    {
+        in_core[selector - num_vars - 1] = 1;
+    }
+    for (int c : remaining)
+    {
+        if (status[c] == Status::UNKNOWN && !in_core[c])
+        {
+            status[c] = Status::REMOVED;
+            fixed.push_back(-selectorOf(c));
+            num_refined++;
+        }
+    }
+}
+
+/**
+<summary>
+Proves further clauses critical by flipping a model of a critical clause; the caller holds mtx.
+</summary>
+<param name="critical">The clause the model falsifies, alone in the set.</param>
+<param name="assignment">The model over the formula's variables, modified and restored.</param>
+<remarks>
+Flipping a variable of the critical clause satisfies it, and only clauses with
+the opposite literal can become FALSE. If exactly one clause of the set does,
+the flipped model satisfies every other clause, so that clause is critical too
+and its model is rotated in turn.
+</remarks>
+*/
+void MusExtractor::rotate(int critical, std::vector<BoolValue> &assignment)
+{
+    for (int lit : clauses[critical])
+    {
+        int var = std::abs(lit) - 1;
+        BoolValue saved = assignment[var];
+        assignment[var] = lit > 0 ? BoolValue::TRUE : BoolValue::FALSE;
+
+        int falsified = -1;
+        int num_falsified = 0;
+        for (int c : occurrences[2 * var + (lit > 0 ? 1 : 0)])
+        {
+            if (status[c] != Status::REMOVED && c != falsified && !satisfies(c, assignment))
+            {
+                falsified = c;
+                num_falsified++;
+            }
+        }
+        if (num_falsified == 1 && status[falsified] == Status::UNKNOWN)
+        {
+            status[falsified] = Status::CRITICAL;
+            fixed.push_back(selectorOf(falsified));
+            num_rotated++;
+            rotate(falsified, assignment);
+        }
+        assignment[var] = saved;
+    }
+}
+
+/**
+<summary>
+Tells whether an assignment satisfies a clause.
+</summary>
+<param name="clause">The clause index.</param>
+<param name="assignment">The assignment over the formula's variables.</param>
+<returns>True if some literal of the clause is TRUE.</returns>
+*/
+bool MusExtractor::satisfies(int clause, const std::vector<BoolValue> &assignment) const
+{
+    for (int lit : clauses[clause])
+    {
+        if (assignment[std::abs(lit) - 1] == (lit > 0 ? BoolValue::TRUE : BoolValue::FALSE))
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,200 @@
+#include "PerfCounters.h"
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+const int PerfSample::NUM_EVENTS;
+
+namespace
+{
+    struct EventSpec
+    {
+        const char *name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+#ifdef __linux__
+    const EventSpec EVENTS[PerfSample::NUM_EVENTS] = {
+        {"Cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"Instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"L1D Misses", PERF_TYPE_HW_CACHE,
+         PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {"LLC Misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {"Branch Misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+#else
+    // Without perf_event_open only the names of the columns are needed
+    const EventSpec EVENTS[PerfSample::NUM_EVENTS] = {
+        {"Cycles", 0, 0},
+        {"Instructions", 0, 0},
+        {"L1D Misses", 0, 0},
+        {"LLC Misses", 0, 0},
+        {"Branch Misses", 0, 0},
+    };
+#endif
+}
+
+/**
+<summary>
+Computes the counts between two samples.
+</summary>
+<param name="earlier">The sample taken first.</param>
+<returns>The difference, with -1 kept where either sample lacks a value.</returns>
+*/
+PerfSample PerfSample::operator-(const PerfSample &earlier) const
+{
+    PerfSample difference;
+    for (int i = 0; i < NUM_EVENTS; i++)
+    {
+        if (values[i] >= 0 && earlier.values[i] >= 0)
+        {
+            difference.values[i] = values[i] - earlier.values[i];
+        }
+    }
+    return difference;
+}
+
+/**
+<summary>
+Formats the values as CSV columns, each followed by a comma.
+</summary>
+<returns>The columns.</returns>
+*/
+std::string PerfSample::toColumns() const
+{
+    std::string columns;
+    for (int i = 0; i < NUM_EVENTS; i++)
+    {
+        columns += std::to_string(values[i]) + ",";
+    }
+    return columns;
+}
+
+// Constructor for the PerfCounters class
+PerfCounters::PerfCounters()
+{
+#ifndef __linux__
+    for (int i = 0; i < PerfSample::NUM_EVENTS; i++)
+    {
+        fds[i] = -1;
+    }
+    error = "perf_event_open is only available on Linux";
+#else
+    for (int i = 0; i < PerfSample::NUM_EVENTS; i++)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = EVENTS[i].type;
+        attr.config = EVENTS[i].config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+
+        // pid 0 and cpu -1: this thread, on whichever CPU it runs
+        fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[i] < 0 && error.empty())
+        {
+            error = std::string(EVENTS[i].name) + ": " + std::strerror(errno);
+        }
+    }
+#endif
+}
+
+// Destructor for the PerfCounters class
+PerfCounters::~PerfCounters()
+{
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+}
+
+/**
+<summary>
+Tells whether at least one counter could be opened.
+</summary>
+<returns>True if some counter works.</returns>
+*/
+bool PerfCounters::isAvailable() const
+{
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+<summary>
+Reads the counters.
+</summary>
+<returns>The counts since the counters were opened.</returns>
+*/
+PerfSample PerfCounters::read() const
+{
+    PerfSample sample;
+    for (int i = 0; i < PerfSample::NUM_EVENTS; i++)
+    {
+        uint64_t data[3]; // value, time enabled, time running
+        if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+        {
+            continue;
+        }
+        if (data[2] == 0)
+        {
+            sample.values[i] = 0; // Never scheduled yet
+        }
+        else if (data[2] < data[1])
+        {
+            sample.values[i] = static_cast<long long>(static_cast<double>(data[0]) * data[1] / data[2]);
+        }
+        else
+        {
+            sample.values[i] = static_cast<long long>(data[0]);
+        }
+    }
+    return sample;
+}
+
+/**
+<summary>
+Gets the CSV header of the columns written by PerfSample::toColumns().
+</summary>
+<returns>The column names, each followed by a comma.</returns>
+*/
+std::string PerfCounters::csvHeader()
+{
+    std::string header;
+    for (const EventSpec &event : EVENTS)
+    {
+        header += std::string(event.name) + ",";
+    }
+    return header;
+}
+
+/**
+<summary>
+Gets the name of a counter.
+</summary>
+<param name="event">The index of the counter in a PerfSample.</param>
+<returns>The name.</returns>
+*/
+const char *PerfCounters::eventName(int event)
+{
+    return EVENTS[event].name;
+}
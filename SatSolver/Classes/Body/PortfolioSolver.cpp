@@ -0,0 +1,157 @@
+#include "PortfolioSolver.h"
+#include "CdclSolver.h"
+#include "ClauseExchange.h"
+#include "Tracer.h"
+#include "WorkerPlacement.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <algorithm>
+
+// Constructor for the PortfolioSolver class
+PortfolioSolver::PortfolioSolver(const BooleanFormula &formula, int num_workers, bool share_clauses)
+    : formula(formula), num_workers(std::max(1, num_workers)), share_clauses(share_clauses)
+{
+}
+
+/**
+<summary>
+Attempts to solve the formula.
+</summary>
+<returns>True if a solution is found, otherwise false.</returns>
+<remarks>
+Worker 0 keeps the default configuration; the others vary the first phase, the
+restart unit and the share of random decisions so that they search differently
+and have something worth sharing.
+</remarks>
+*/
+bool PortfolioSolver::solve()
+{
+    static const int restart_intervals[] = {100, 50, 300, 150};
+
+    // Each worker builds its own solver, so that the clause arenas are first
+    // touched, and thus allocated, on the NUMA node of the CPU it runs on
+    ClauseExchange exchange;
+    std::vector<std::unique_ptr<CdclSolver>> solvers(num_workers);
+    std::mutex mtx;
+    std::condition_variable built_cv;
+    int num_built = 0;
+
+    // Round barrier of the deterministic mode
+    std::vector<std::vector<std::vector<int>>> outboxes(num_workers);
+    std::vector<std::vector<int>> shared;
+    std::condition_variable round_cv;
+    int num_arrived = 0;
+    unsigned long long generation = 0;
+
+    std::atomic<int> first(-1);
+    std::vector<BoolValue> results(num_workers, BoolValue::UNASSIGNED);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_workers; i++)
+    {
+        threads.emplace_back([&, i]()
+                             {
+                                 Tracer::setThreadName("portfolio worker " + std::to_string(i));
+                                 if (!cpus.empty())
+                                 {
+                                     WorkerPlacement::pinCurrentThread({cpus[i % cpus.size()]});
+                                 }
+                                 std::unique_ptr<CdclSolver> solver(new CdclSolver(formula));
+                                 solver->setSeed(i + 1);
+                                 solver->setDefaultPhase(i % 2 == 1);
+                                 solver->setRestartInterval(restart_intervals[i % 4]);
+                                 solver->setRandomDecisionFrequency(i == 0 ? 0.0 : 0.01 * (i % 5));
+                                 solver->setInprocessInterval(inprocess_interval);
+                                 if (share_clauses && round_conflicts > 0)
+                                 {
+                                     solver->setClauseOutbox(&outboxes[i]);
+                                 }
+                                 else if (share_clauses)
+                                 {
+                                     solver->setClauseExchange(&exchange, i);
+                                 }
+
+                                 // The winner interrupts every solver, so all must exist before any starts
+                                 {
+                                     std::unique_lock<std::mutex> lock(mtx);
+                                     solvers[i] = std::move(solver);
+                                     if (++num_built == num_workers)
+                                     {
+                                         built_cv.notify_all();
+                                     }
+                                     built_cv.wait(lock, [&]()
+                                                   { return num_built == num_workers; });
+                                 }
+
+                                 while (round_conflicts > 0)
+                                 {
+                                     solvers[i]->setConflictBudget(round_conflicts);
+                                     results[i] = solvers[i]->solveLimited();
+                                     {
+                                         std::unique_lock<std::mutex> lock(mtx);
+                                         unsigned long long round = generation;
+                                         if (++num_arrived == num_workers)
+                                         {
+                                             // The last worker to arrive closes the round
+                                             num_arrived = 0;
+                                             num_rounds++;
+                                             for (int w = 0; w < num_workers && first.load() < 0; w++)
+                                             {
+                                                 if (results[w] != BoolValue::UNASSIGNED)
+                                                 {
+                                                     first.store(w);
+                                                 }
+                                             }
+                                             shared.clear();
+                                             for (auto &outbox : outboxes)
+                                             {
+                                                 shared.insert(shared.end(), outbox.begin(), outbox.end());
+                                                 outbox.clear();
+                                             }
+                                             generation++;
+                                             round_cv.notify_all();
+                                         }
+                                         round_cv.wait(lock, [&]()
+                                                       { return generation != round; });
+                                     }
+                                     if (first.load() >= 0)
+                                     {
+                                         return;
+                                     }
+                                     // Nobody writes the shared clauses again until every worker is back at the barrier
+                                     solvers[i]->importSharedClauses(shared);
+                                 }
+
+                                 results[i] = solvers[i]->solveLimited();
+                                 int none = -1;
+                                 if (results[i] != BoolValue::UNASSIGNED && first.compare_exchange_strong(none, i))
+                                 {
+                                     for (auto &other : solvers)
+                                     {
+                                         other->interrupt();
+                                     }
+                                 } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    winner = first.load();
+    for (const auto &solver : solvers)
+    {
+        num_conflicts += solver->getNumConflicts();
+        num_decisions += solver->getNumDecisions();
+        num_propagations += solver->getNumPropagations();
+        num_exported += solver->getNumExportedClauses();
+        num_imported += solver->getNumImportedClauses();
+    }
+
+    bool satisfiable = (winner >= 0 && results[winner] == BoolValue::TRUE);
+    assignment = satisfiable ? solvers[winner]->getAssignment()
+                             : std::vector<BoolValue>(formula.getVariableCount(), BoolValue::UNASSIGNED);
+    assignment.resize(formula.getVariableCount(), BoolValue::UNASSIGNED);
+    return satisfiable;
+}
@@ -0,0 +1,576 @@
+/**
+<summary>
+The Preprocessor class shrinks a formula before any engine sees it, using the
+binary implication graph to find forced and equivalent literals.
+</summary>
+*/
+#include "Preprocessor.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <unordered_set>
+#include <cstdint>
+
+// Constructor for the Preprocessor class
+Preprocessor::Preprocessor(const BooleanFormula &formula)
+    : num_vars(formula.getVariableCount()), answer(formula.getAnswer())
+{
+    fixed.assign(num_vars, 0);
+    substitution.assign(num_vars, -1);
+    for (const Clause &clause : formula.getClauses())
+    {
+        std::vector<int> lits;
+        for (const Literal &lit : clause.getLiterals())
+        {
+            lits.push_back(2 * (lit.getVariable() - 1) + (lit.getValue() == BoolValue::FALSE ? 1 : 0));
+        }
+        std::sort(lits.begin(), lits.end());
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+
+        bool tautology = false;
+        for (size_t i = 1; i < lits.size(); i++)
+        {
+            tautology |= (lits[i] == (lits[i - 1] ^ 1));
+        }
+        if (lits.empty())
+        {
+            consistent = false;
+        }
+        else if (!tautology)
+        {
+            clauses.push_back(lits);
+        }
+    }
+}
+
+/**
+<summary>
+Runs rounds of simplification until nothing changes or the round limit is reached.
+</summary>
+<returns>False if the formula was found unsatisfiable, otherwise true.</returns>
+*/
+bool Preprocessor::simplify()
+{
+    for (int round = 0; round < 4 && consistent; round++)
+    {
+        TraceScope trace("simplify round", round);
+        propagateUnits();
+        bool changed = false;
+        if (consistent)
+        {
+            TraceScope trace_equivalences("equivalences");
+            changed = substituteEquivalences();
+        }
+        if (consistent)
+        {
+            propagateUnits();
+        }
+        if (consistent)
+        {
+            TraceScope trace_probing("probing");
+            changed |= probeLiterals();
+        }
+        if (!changed)
+        {
+            break;
+        }
+    }
+    if (consistent)
+    {
+        propagateUnits();
+    }
+    return consistent;
+}
+
+/**
+<summary>
+Builds the simplified formula.
+</summary>
+<returns>The remaining clauses, with the answer of the original formula.</returns>
+*/
+BooleanFormula Preprocessor::getSimplifiedFormula() const
+{
+    BooleanFormula simplified;
+    simplified.setAnswer(answer);
+    for (const std::vector<int> &lits : clauses)
+    {
+        if (lits.empty())
+        {
+            continue;
+        }
+        Clause clause;
+        for (int lit : lits)
+        {
+            clause.addLiteral(Literal((lit >> 1) + 1, (lit & 1) ? BoolValue::FALSE : BoolValue::TRUE));
+        }
+        simplified.addClause(clause);
+    }
+    return simplified;
+}
+
+/**
+<summary>
+Extends a model of the simplified formula to a model of the original one.
+</summary>
+<param name="model">A model of the simplified formula; it may be shorter than the original variable count.</param>
+<returns>One BoolValue per original variable, none of them UNASSIGNED.</returns>
+<remarks>
+Substitutions are undone newest first, so a representative that was itself
+substituted later already has its value when it is read. Variables left
+without a value by then are unconstrained and set FALSE, so the model is total.
+</remarks>
+*/
+std::vector<BoolValue> Preprocessor::extendModel(const std::vector<BoolValue> &model) const
+{
+    std::vector<BoolValue> extended(num_vars, BoolValue::UNASSIGNED);
+    std::copy(model.begin(), model.begin() + std::min<size_t>(model.size(), num_vars), extended.begin());
+    for (int var = 0; var < num_vars; var++)
+    {
+        if (fixed[var] != 0)
+        {
+            extended[var] = fixed[var] > 0 ? BoolValue::TRUE : BoolValue::FALSE;
+        }
+    }
+    for (size_t i = substitution_order.size(); i-- > 0;)
+    {
+        int var = substitution_order[i];
+        int representative = substitution[var];
+        BoolValue &rep_value = extended[representative >> 1];
+        if (rep_value == BoolValue::UNASSIGNED)
+        {
+            rep_value = BoolValue::FALSE; // Unconstrained: any value will do
+        }
+        bool positive = (rep_value == BoolValue::TRUE) != ((representative & 1) != 0);
+        extended[var] = positive ? BoolValue::TRUE : BoolValue::FALSE;
+    }
+    for (BoolValue &value : extended)
+    {
+        if (value == BoolValue::UNASSIGNED)
+        {
+            value = BoolValue::FALSE; // Only in removed clauses, such as tautologies or ones satisfied by fixed literals
+        }
+    }
+    return extended;
+}
+
+/**
+<summary>
+Fixes a literal TRUE at the top level.
+</summary>
+<param name="lit">The literal.</param>
+*/
+void Preprocessor::fix(int lit)
+{
+    fixed[lit >> 1] = (lit & 1) ? -1 : 1;
+    num_fixed++;
+}
+
+/**
+<summary>
+Propagates the fixed literals and unit clauses, then removes satisfied
+clauses and false literals.
+</summary>
+<returns>True if some variable was fixed.</returns>
+*/
+bool Preprocessor::propagateUnits()
+{
+    std::vector<std::vector<int>> occurrences(2 * num_vars);
+    std::vector<int> queue;
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        for (int lit : clauses[i])
+        {
+            occurrences[lit].push_back(i);
+        }
+    }
+    for (int var = 0; var < num_vars; var++)
+    {
+        if (fixed[var] != 0)
+        {
+            queue.push_back(2 * var + (fixed[var] > 0 ? 0 : 1));
+        }
+    }
+
+    bool changed = false;
+    for (size_t i = 0; i < clauses.size() && consistent; i++)
+    {
+        if (clauses[i].size() == 1)
+        {
+            int lit = clauses[i][0];
+            if (value(lit) == -1)
+            {
+                consistent = false;
+            }
+            else if (value(lit) == 0)
+            {
+                fix(lit);
+                queue.push_back(lit);
+                changed = true;
+            }
+        }
+    }
+
+    for (size_t head = 0; head < queue.size() && consistent; head++)
+    {
+        for (int index : occurrences[queue[head] ^ 1])
+        {
+            int free_count = 0, free_lit = -1;
+            bool satisfied = false;
+            for (int lit : clauses[index])
+            {
+                satisfied |= (value(lit) == 1);
+                if (value(lit) == 0)
+                {
+                    free_count++;
+                    free_lit = lit;
+                }
+            }
+            if (satisfied || free_count > 1)
+            {
+                continue;
+            }
+            if (free_count == 0)
+            {
+                consistent = false;
+                break;
+            }
+            fix(free_lit);
+            queue.push_back(free_lit);
+            changed = true;
+        }
+    }
+
+    // Drop satisfied clauses and false literals
+    for (std::vector<int> &clause : clauses)
+    {
+        bool satisfied = false;
+        size_t kept = 0;
+        for (int lit : clause)
+        {
+            satisfied |= (value(lit) == 1);
+            if (value(lit) == 0)
+            {
+                clause[kept++] = lit;
+            }
+        }
+        clause.resize(satisfied ? 0 : kept);
+    }
+    return changed;
+}
+
+/**
+<summary>
+Finds the strongly connected components of the binary implication graph and
+replaces every literal by the representative of its component.
+</summary>
+<returns>True if some variable was substituted.</returns>
+<remarks>
+The representative is the smallest literal of a component. The component of
+the negated literals is the mirror image, so its smallest literal is the
+negation of this one and the substitution stays consistent under negation.
+Tarjan's algorithm runs with an explicit stack so that long implication chains
+cannot overflow the call stack.
+</remarks>
+*/
+bool Preprocessor::substituteEquivalences()
+{
+    int num_lits = 2 * num_vars;
+    std::vector<std::vector<int>> edges(num_lits);
+    for (const std::vector<int> &clause : clauses)
+    {
+        if (clause.size() == 2)
+        {
+            edges[clause[0] ^ 1].push_back(clause[1]);
+            edges[clause[1] ^ 1].push_back(clause[0]);
+        }
+    }
+
+    std::vector<int> order(num_lits, -1), low(num_lits, 0), representative(num_lits, -1);
+    std::vector<char> on_stack(num_lits, 0);
+    std::vector<int> component;
+    std::vector<std::pair<int, size_t>> calls;
+    int counter = 0;
+
+    for (int root = 0; root < num_lits; root++)
+    {
+        if (order[root] != -1 || edges[root].empty())
+        {
+            continue;
+        }
+        order[root] = low[root] = counter++;
+        component.push_back(root);
+        on_stack[root] = 1;
+        calls.push_back(std::make_pair(root, 0));
+
+        while (!calls.empty())
+        {
+            int node = calls.back().first;
+            size_t &next_edge = calls.back().second;
+            if (next_edge < edges[node].size())
+            {
+                int target = edges[node][next_edge++];
+                if (order[target] == -1)
+                {
+                    order[target] = low[target] = counter++;
+                    component.push_back(target);
+                    on_stack[target] = 1;
+                    calls.push_back(std::make_pair(target, 0));
+                }
+                else if (on_stack[target])
+                {
+                    low[node] = std::min(low[node], order[target]);
+                }
+                continue;
+            }
+
+            calls.pop_back();
+            if (!calls.empty())
+            {
+                int parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[node]);
+            }
+            if (low[node] == order[node])
+            {
+                // Pop the component and find its smallest literal
+                size_t start = component.size();
+                int smallest = node;
+                do
+                {
+                    start--;
+                    smallest = std::min(smallest, component[start]);
+                } while (component[start] != node);
+                for (size_t i = start; i < component.size(); i++)
+                {
+                    representative[component[i]] = smallest;
+                    on_stack[component[i]] = 0;
+                }
+                component.resize(start);
+            }
+        }
+    }
+
+    bool changed = false;
+    for (int var = 0; var < num_vars; var++)
+    {
+        int positive = representative[2 * var];
+        if (positive == -1)
+        {
+            continue;
+        }
+        if (positive == representative[2 * var + 1])
+        {
+            consistent = false; // A literal is equivalent to its own negation
+            return false;
+        }
+        if (positive != 2 * var)
+        {
+            substitution[var] = positive;
+            substitution_order.push_back(var);
+            changed = true;
+        }
+    }
+    if (!changed)
+    {
+        return false;
+    }
+
+    for (std::vector<int> &clause : clauses)
+    {
+        for (int &lit : clause)
+        {
+            if (representative[lit] != -1)
+            {
+                lit = representative[lit];
+            }
+        }
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        for (size_t i = 1; i < clause.size(); i++)
+        {
+            if (clause[i] == (clause[i - 1] ^ 1))
+            {
+                clause.clear(); // Tautology
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Probes both polarities of the variables in binary clauses. Failed literals
+and literals implied by both polarities are fixed, and clauses that became
+unit under a probe give hyper-binary resolvents.
+</summary>
+<returns>True if a literal was fixed or a resolvent added.</returns>
+*/
+bool Preprocessor::probeLiterals()
+{
+    int num_lits = 2 * num_vars;
+    std::vector<std::vector<int>> occurrences(num_lits);
+    std::vector<char> in_binary(num_vars, 0);
+    std::unordered_set<uint64_t> binaries;
+    size_t num_clauses = 0;
+    for (size_t i = 0; i < clauses.size(); i++)
+    {
+        const std::vector<int> &clause = clauses[i];
+        for (int lit : clause)
+        {
+            occurrences[lit].push_back(i);
+        }
+        if (clause.size() == 2)
+        {
+            in_binary[clause[0] >> 1] = in_binary[clause[1] >> 1] = 1;
+            binaries.insert(static_cast<uint64_t>(clause[0]) * num_lits + clause[1]);
+        }
+        num_clauses += !clause.empty();
+    }
+
+    std::vector<signed char> probe_value(num_vars, 0);
+    std::vector<int> trail;
+    std::vector<std::pair<int, int>> resolvents; // (probed literal, implied literal)
+    unsigned long long visits = 0;
+
+    // Propagates a literal on top of the fixed ones; returns false on a conflict
+    auto probe = [&](int start, std::vector<int> &implied, bool collect_resolvents)
+    {
+        auto current = [&](int lit)
+        {
+            int top = value(lit);
+            return top != 0 ? top : ((lit & 1) ? -probe_value[lit >> 1] : probe_value[lit >> 1]);
+        };
+        trail.assign(1, start);
+        probe_value[start >> 1] = (start & 1) ? -1 : 1;
+        bool ok = true;
+        for (size_t head = 0; head < trail.size() && ok; head++)
+        {
+            for (int index : occurrences[trail[head] ^ 1])
+            {
+                visits++;
+                int free_count = 0, free_lit = -1;
+                bool satisfied = false;
+                for (int lit : clauses[index])
+                {
+                    int val = current(lit);
+                    satisfied |= (val == 1);
+                    if (val == 0)
+                    {
+                        free_count++;
+                        free_lit = lit;
+                    }
+                }
+                if (satisfied || free_count > 1 || clauses[index].empty())
+                {
+                    continue;
+                }
+                if (free_count == 0)
+                {
+                    ok = false;
+                    break;
+                }
+                probe_value[free_lit >> 1] = (free_lit & 1) ? -1 : 1;
+                trail.push_back(free_lit);
+                if (collect_resolvents && clauses[index].size() >= 3)
+                {
+                    resolvents.push_back(std::make_pair(start, free_lit));
+                }
+            }
+        }
+        implied.assign(trail.begin() + 1, trail.end());
+        for (int lit : trail)
+        {
+            probe_value[lit >> 1] = 0;
+        }
+        return ok;
+    };
+
+    // Fixes a literal and everything it implies at the top level
+    auto fixWithConsequences = [&](int lit)
+    {
+        std::vector<int> implied;
+        if (!probe(lit, implied, false))
+        {
+            consistent = false;
+            return;
+        }
+        fix(lit);
+        for (int other : implied)
+        {
+            if (value(other) == 0)
+            {
+                fix(other);
+            }
+        }
+    };
+
+    bool changed = false;
+    std::vector<int> positive_implied, negative_implied;
+    std::vector<int> stamp(num_lits, -1);
+    for (int var = 0; var < num_vars && consistent && visits < probe_budget; var++)
+    {
+        if (!in_binary[var] || fixed[var] != 0)
+        {
+            continue;
+        }
+        size_t resolvents_before = resolvents.size();
+        if (!probe(2 * var, positive_implied, true))
+        {
+            resolvents.resize(resolvents_before);
+            num_failed_literals++;
+            fixWithConsequences(2 * var + 1);
+            changed = true;
+            continue;
+        }
+        size_t positive_resolvents = resolvents.size();
+        if (!probe(2 * var + 1, negative_implied, true))
+        {
+            resolvents.resize(positive_resolvents);
+            num_failed_literals++;
+            fixWithConsequences(2 * var);
+            changed = true;
+            continue;
+        }
+
+        // Literals implied by both polarities hold in every model
+        for (int lit : positive_implied)
+        {
+            stamp[lit] = var;
+        }
+        for (int lit : negative_implied)
+        {
+            if (stamp[lit] == var && value(lit) == 0 && consistent)
+            {
+                fixWithConsequences(lit);
+                changed = true;
+            }
+        }
+    }
+    if (!consistent)
+    {
+        return false;
+    }
+
+    for (const std::pair<int, int> &resolvent : resolvents)
+    {
+        if (num_hyper_binary >= static_cast<int>(num_clauses))
+        {
+            break;
+        }
+        int a = resolvent.first ^ 1, b = resolvent.second;
+        if (value(a) != 0 || value(b) != 0 || (a >> 1) == (b >> 1))
+        {
+            continue;
+        }
+        if (a > b)
+        {
+            std::swap(a, b);
+        }
+        if (binaries.insert(static_cast<uint64_t>(a) * num_lits + b).second)
+        {
+            clauses.push_back(std::vector<int>{a, b});
+            num_hyper_binary++;
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,161 @@
+#include "ResultCache.h"
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+
+namespace
+{
+    uint64_t mix(uint64_t value)
+    {
+        value += 0x9e3779b97f4a7c15ull;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+}
+
+/**
+<summary>
+Computes the fingerprint of a formula.
+</summary>
+<param name="formula">The formula.</param>
+<returns>The fingerprint.</returns>
+<remarks>
+Sums of mixed values are order-independent; mixing each clause's sums again
+before adding them keeps clauses with the same literals in total apart.
+</remarks>
+*/
+FormulaFingerprint ResultCache::fingerprint(const BooleanFormula &formula)
+{
+    FormulaFingerprint result;
+    for (const Clause &clause : formula.getClauses())
+    {
+        uint64_t high = 0, low = 0;
+        for (const Literal &lit : clause.getLiterals())
+        {
+            uint64_t code = 2 * static_cast<uint64_t>(lit.getVariable()) + (lit.getValue() == BoolValue::FALSE ? 1 : 0);
+            high += mix(code);
+            low += mix(code ^ 0x5bd1e9955bd1e995ull);
+        }
+        uint64_t size = clause.getLiterals().size();
+        result.high += mix(high + size);
+        result.low += mix(low ^ (size << 32));
+    }
+    result.high = mix(result.high + formula.getClauses().size());
+    result.low = mix(result.low ^ formula.getClauses().size());
+    return result;
+}
+
+// Constructor for the ResultCache class
+ResultCache::ResultCache(const std::string &path)
+{
+    std::ifstream input(path);
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream iss(line);
+        FormulaFingerprint key;
+        Entry entry;
+        char verdict;
+        std::string model;
+        if (!(iss >> std::hex >> key.high >> key.low >> std::dec >> entry.num_vars >> entry.num_clauses >> verdict >> model) ||
+            (verdict != 'S' && verdict != 'U'))
+        {
+            continue; // A line cut short by an interrupted run
+        }
+        entry.satisfiable = (verdict == 'S');
+        if (entry.satisfiable)
+        {
+            for (char value : model)
+            {
+                entry.model.push_back(value == '1' ? BoolValue::TRUE : value == '0' ? BoolValue::FALSE : BoolValue::UNASSIGNED);
+            }
+        }
+        entries[key] = entry;
+    }
+    input.close();
+    file.open(path, std::ios::app);
+}
+
+/**
+<summary>
+Looks up the result of a formula.
+</summary>
+<param name="formula">The formula.</param>
+<param name="key">The fingerprint of the formula.</param>
+<param name="satisfiable">Receives the cached verdict.</param>
+<param name="model">Receives the cached model, one value per variable.</param>
+<returns>True if an entry matches the formula and, when satisfiable, its model satisfies every clause.</returns>
+*/
+bool ResultCache::lookup(const BooleanFormula &formula, const FormulaFingerprint &key, bool &satisfiable, std::vector<BoolValue> &model)
+{
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = entries.find(key);
+        if (it == entries.end())
+        {
+            return false;
+        }
+        entry = it->second;
+    }
+
+    if (entry.num_clauses != formula.getClauseCount() || entry.num_vars != formula.getVariableCount())
+    {
+        return false;
+    }
+    if (entry.satisfiable)
+    {
+        if (entry.model.size() != static_cast<size_t>(entry.num_vars))
+        {
+            return false;
+        }
+        for (const Clause &clause : formula.getClauses())
+        {
+            if (clause.evaluate(entry.model) != BoolValue::TRUE)
+            {
+                return false;
+            }
+        }
+    }
+
+    satisfiable = entry.satisfiable;
+    model = std::move(entry.model);
+    std::lock_guard<std::mutex> lock(mtx);
+    num_hits++;
+    return true;
+}
+
+/**
+<summary>
+Stores the result of a formula and appends it to the file.
+</summary>
+<param name="formula">The formula.</param>
+<param name="key">The fingerprint of the formula.</param>
+<param name="satisfiable">The verdict.</param>
+<param name="model">The model when satisfiable.</param>
+*/
+void ResultCache::store(const BooleanFormula &formula, const FormulaFingerprint &key, bool satisfiable, const std::vector<BoolValue> &model)
+{
+    Entry entry{formula.getVariableCount(), formula.getClauseCount(), satisfiable, satisfiable ? model : std::vector<BoolValue>()};
+
+    std::ostringstream line;
+    line << std::hex << key.high << " " << key.low << std::dec << " " << entry.num_vars << " " << entry.num_clauses << " "
+         << (satisfiable ? "S " : "U ");
+    for (BoolValue val : entry.model)
+    {
+        line << (val == BoolValue::TRUE ? '1' : val == BoolValue::FALSE ? '0' : '-');
+    }
+    if (entry.model.empty())
+    {
+        line << '-';
+    }
+    line << "\n";
+
+    std::lock_guard<std::mutex> lock(mtx);
+    entries[key] = std::move(entry);
+    if (file.is_open())
+    {
+        file << line.str() << std::flush;
+    }
+}
@@ -0,0 +1,306 @@
+#include "SatSolverApi.h"
+#include "CdclSolver.h"
+#include "Literal.h"
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <new>
+
+// The handle behind the C interface
+struct satsolver
+{
+    CdclSolver sat;
+    bool consistent = true;
+    std::vector<int32_t> pending;    // Unterminated clause carried over to the next satsolver_add_literals
+    std::vector<int> assumptions;
+    unsigned long long clauses = 0;
+    unsigned long long solves = 0;
+    unsigned long long solve_microseconds = 0;
+};
+
+static_assert(SATSOLVER_MAX_VARIABLE == Literal::MAX_VARIABLE, "the C interface accepts the literals the parser does");
+
+namespace
+{
+    // Checks literals before they reach the solver, which grows to the largest variable it sees
+    bool inRange(const int32_t *literals, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (literals[i] < -SATSOLVER_MAX_VARIABLE || literals[i] > SATSOLVER_MAX_VARIABLE)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Adds one clause, keeping the handle's verdict
+    void addClause(satsolver *solver, const int32_t *literals, size_t count)
+    {
+        solver->clauses++;
+        solver->consistent = solver->sat.addClause(literals, count) && solver->consistent;
+    }
+}
+
+/**
+<summary>
+Gets the version of the interface the library was built with.
+</summary>
+<returns>SATSOLVER_API_VERSION of the library.</returns>
+*/
+int satsolver_api_version(void)
+{
+    return SATSOLVER_API_VERSION;
+}
+
+/**
+<summary>
+Creates an empty solver.
+</summary>
+<returns>The handle, or NULL if memory ran out.</returns>
+*/
+satsolver *satsolver_create(void)
+{
+    // The solver's constructor allocates too, so nothrow new alone cannot keep bad_alloc from crossing into C
+    try
+    {
+        return new satsolver();
+    }
+    catch (const std::exception &)
+    {
+        return nullptr;
+    }
+}
+
+/**
+<summary>
+Destroys a solver.
+</summary>
+<param name="solver">The handle; NULL is ignored.</param>
+*/
+void satsolver_destroy(satsolver *solver)
+{
+    delete solver;
+}
+
+/**
+<summary>
+Adds clauses from a buffer of zero-terminated literal runs.
+</summary>
+<param name="solver">The handle.</param>
+<param name="literals">The literals; the buffer is not kept.</param>
+<param name="count">The number of entries in the buffer.</param>
+<returns>1 while the clauses may be satisfiable, 0 once they are known not to be, SATSOLVER_ERROR on failure.</returns>
+<remarks>
+Complete runs go to the solver straight from the caller's buffer; only a run
+split across calls is copied.
+</remarks>
+*/
+int satsolver_add_literals(satsolver *solver, const int32_t *literals, size_t count)
+{
+    if (solver == nullptr || (literals == nullptr && count > 0) || !inRange(literals, count))
+    {
+        return SATSOLVER_ERROR;
+    }
+    try
+    {
+        size_t start = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (literals[i] != 0)
+            {
+                continue;
+            }
+            if (!solver->pending.empty())
+            {
+                solver->pending.insert(solver->pending.end(), literals + start, literals + i);
+                addClause(solver, solver->pending.data(), solver->pending.size());
+                solver->pending.clear();
+            }
+            else
+            {
+                addClause(solver, literals + start, i - start);
+            }
+            start = i + 1;
+        }
+        solver->pending.insert(solver->pending.end(), literals + start, literals + count);
+    }
+    catch (const std::exception &)
+    {
+        return SATSOLVER_ERROR;
+    }
+    return solver->consistent ? 1 : 0;
+}
+
+/**
+<summary>
+Solves the clauses added so far.
+</summary>
+<param name="solver">The handle.</param>
+<param name="assumptions">Literals assumed TRUE for this solve only; may be NULL when count is 0.</param>
+<param name="count">The number of assumptions.</param>
+<param name="limits">The limits of the solve, or NULL for none.</param>
+<returns>SATSOLVER_SAT, SATSOLVER_UNSAT, SATSOLVER_UNKNOWN when a limit or an interrupt stopped it, or SATSOLVER_ERROR.</returns>
+<remarks>
+A time limit is enforced by a watchdog thread that interrupts the solver, as
+MaxSatSolver does.
+</remarks>
+*/
+int satsolver_solve(satsolver *solver, const int32_t *assumptions, size_t count, const satsolver_limits *limits)
+{
+    if (solver == nullptr || (assumptions == nullptr && count > 0) || !inRange(assumptions, count) ||
+        std::find(assumptions, assumptions + count, 0) != assumptions + count)
+    {
+        return SATSOLVER_ERROR;
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BoolValue result;
+    try
+    {
+        solver->solves++;
+        solver->assumptions.assign(assumptions, assumptions + count);
+        solver->sat.setConflictBudget(limits != nullptr && limits->conflicts > 0 ? limits->conflicts : -1);
+
+        std::mutex mtx;
+        std::condition_variable finished_cv;
+        bool finished = false;
+        std::thread watchdog;
+        if (limits != nullptr && limits->seconds > 0)
+        {
+            auto time_limit = std::chrono::microseconds(static_cast<long long>(limits->seconds * 1e6));
+            watchdog = std::thread([&]()
+                                   {
+                                       std::unique_lock<std::mutex> lock(mtx);
+                                       if (!finished_cv.wait_for(lock, time_limit, [&]() { return finished; }))
+                                       {
+                                           solver->sat.interrupt();
+                                       } });
+        }
+
+        result = solver->sat.solveLimited(solver->assumptions);
+
+        if (watchdog.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                finished = true;
+            }
+            finished_cv.notify_all();
+            watchdog.join();
+        }
+        solver->sat.clearInterrupt();
+    }
+    catch (const std::exception &)
+    {
+        return SATSOLVER_ERROR;
+    }
+    solver->solve_microseconds += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+    if (result == BoolValue::TRUE)
+    {
+        return SATSOLVER_SAT;
+    }
+    return result == BoolValue::FALSE ? SATSOLVER_UNSAT : SATSOLVER_UNKNOWN;
+}
+
+/**
+<summary>
+Stops a solve running on another thread; it returns SATSOLVER_UNKNOWN.
+</summary>
+<param name="solver">The handle.</param>
+*/
+void satsolver_interrupt(satsolver *solver)
+{
+    if (solver != nullptr)
+    {
+        solver->sat.interrupt();
+    }
+}
+
+/**
+<summary>
+Gets the value of a variable in the model of the last satisfiable solve.
+</summary>
+<param name="solver">The handle.</param>
+<param name="variable">The 1-based variable.</param>
+<returns>The variable if it is TRUE, its negation if it is FALSE, 0 if there is no model or the variable is unknown.</returns>
+*/
+int32_t satsolver_value(const satsolver *solver, int32_t variable)
+{
+    if (solver == nullptr || variable <= 0 || static_cast<size_t>(variable) > solver->sat.getAssignment().size())
+    {
+        return 0;
+    }
+    BoolValue value = solver->sat.getAssignment()[variable - 1];
+    return value == BoolValue::TRUE ? variable : value == BoolValue::FALSE ? -variable : 0;
+}
+
+/**
+<summary>
+Copies the model of the last satisfiable solve.
+</summary>
+<param name="solver">The handle.</param>
+<param name="model">Receives satsolver_value() of variables 1, 2, ... up to the capacity.</param>
+<param name="capacity">The number of entries the buffer holds.</param>
+<returns>The number of variables in the model, 0 if there is none; at most the capacity is written.</returns>
+*/
+size_t satsolver_model(const satsolver *solver, int32_t *model, size_t capacity)
+{
+    if (solver == nullptr)
+    {
+        return 0;
+    }
+    size_t size = solver->sat.getAssignment().size();
+    for (size_t i = 0; i < std::min(size, capacity); i++)
+    {
+        model[i] = satsolver_value(solver, static_cast<int32_t>(i) + 1);
+    }
+    return size;
+}
+
+/**
+<summary>
+Tells whether an assumption was part of the refutation of the last unsatisfiable solve.
+</summary>
+<param name="solver">The handle.</param>
+<param name="literal">An assumption of that solve.</param>
+<returns>1 if it was, otherwise 0.</returns>
+*/
+int satsolver_failed(const satsolver *solver, int32_t literal)
+{
+    if (solver == nullptr)
+    {
+        return 0;
+    }
+    const std::vector<int> &failed = solver->sat.getFailedAssumptions();
+    return std::find(failed.begin(), failed.end(), literal) != failed.end() ? 1 : 0;
+}
+
+/**
+<summary>
+Reads the statistics of a solver.
+</summary>
+<param name="solver">The handle.</param>
+<param name="stats">Receives the totals.</param>
+*/
+void satsolver_get_stats(const satsolver *solver, satsolver_stats *stats)
+{
+    if (solver == nullptr || stats == nullptr)
+    {
+        return;
+    }
+    stats->variables = solver->sat.getVariableCount();
+    stats->clauses = solver->clauses;
+    stats->solves = solver->solves;
+    stats->decisions = solver->sat.getNumDecisions();
+    stats->conflicts = solver->sat.getNumConflicts();
+    stats->propagations = solver->sat.getNumPropagations();
+    stats->restarts = solver->sat.getNumRestarts();
+    stats->learned_clauses = solver->sat.getNumLearnedClauses();
+    stats->solve_microseconds = solver->solve_microseconds;
+}
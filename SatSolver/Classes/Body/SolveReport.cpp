@@ -0,0 +1,256 @@
+#include "SolveReport.h"
+#include "BacktrackSolver.h"
+#include "CdclSolver.h"
+#include "PortfolioSolver.h"
+#include "LookaheadSolver.h"
+#include "TwoSatSolver.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <sstream>
+
+/**
+<summary>
+Solves a formula with the engine the options name, or the one picked from its features, and records the outcome.
+</summary>
+<param name="formula">The formula to solve.</param>
+<param name="options">The engine and its settings.</param>
+<param name="workspace">The backtracking engine's storage; nullptr uses one kept per calling thread.</param>
+<param name="cpus">The CPUs portfolio threads are bound to; empty leaves them unbound.</param>
+<returns>The report of the solve.</returns>
+<remarks>
+Each calling thread keeps one workspace, so the daemon's pool threads and the
+batch workers reuse their buffers from one formula to the next. Only the
+backtracking engine builds a BacktrackSolver, and only it takes checkpoints.
+</remarks>
+*/
+SolveReport SolveReport::solve(const BooleanFormula &formula, const EngineOptions &options, SolverWorkspace *workspace, const std::vector<int> &cpus)
+{
+    static thread_local SolverWorkspace thread_workspace;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    SolveReport report;
+    std::ostringstream details;
+
+    // Pick the engine from the formula's features unless the caller named one
+    std::string engine = options.name;
+    if (engine == "auto" && !options.checkpoint_path.empty())
+    {
+        engine = "backtrack";
+    }
+    else if (engine == "auto")
+    {
+        FormulaFeatures features = EngineSelector::extractFeatures(formula);
+        engine = EngineSelector::select(features, options.thresholds);
+        details << "Engine: " << engine << " (selected for " << features.variables << " variables, ratio "
+                << std::round(features.ratio * 100) / 100 << ", max width " << features.max_width
+                << ", binary clauses " << std::round(features.binary_fraction * 100) << "%, cardinality variables "
+                << std::round(features.cardinality_fraction * 100) << "%)\n";
+    }
+    if (engine == "twosat" && formula.getMaxLiteralsInClause() > 2)
+    {
+        details << "Engine: cdcl (the 2-SAT engine needs clauses of at most two literals)\n";
+        engine = "cdcl";
+    }
+
+    if (engine == "twosat")
+    {
+        TwoSatSolver twosat(formula);
+        report.satisfiable = twosat.solve();
+        report.assignment = twosat.getAssignment();
+        details << "2-SAT implication graph components: " << twosat.getNumComponents() << "\n";
+    }
+    else if (engine == "cdcl")
+    {
+        CdclSolver cdcl(formula);
+        cdcl.setInprocessInterval(options.inprocess_interval);
+        report.satisfiable = cdcl.solve();
+        report.assignment = report.satisfiable ? cdcl.getAssignment() : std::vector<BoolValue>();
+        report.decisions = cdcl.getNumDecisions();
+        report.backtracks = cdcl.getNumConflicts();
+        report.unit_propagations = cdcl.getNumPropagations();
+        details << "CDCL conflicts: " << cdcl.getNumConflicts()
+                << ", decisions: " << cdcl.getNumDecisions()
+                << ", propagations: " << cdcl.getNumPropagations()
+                << ", restarts: " << cdcl.getNumRestarts() << "\n";
+        if (cdcl.getNumInprocessings() > 0)
+        {
+            details << "Inprocessing: " << cdcl.getNumInprocessings() << " passes, "
+                    << cdcl.getNumVivifiedClauses() << " clauses vivified, "
+                    << cdcl.getNumSubsumedClauses() << " subsumed, "
+                    << cdcl.getNumSatisfiedClausesRemoved() << " satisfied removed\n";
+        }
+    }
+    else if (engine == "portfolio")
+    {
+        PortfolioSolver portfolio(formula, options.portfolio_workers, options.share_clauses);
+        portfolio.setCpus(cpus);
+        portfolio.setDeterministic(options.round_conflicts);
+        portfolio.setInprocessInterval(options.inprocess_interval);
+        report.satisfiable = portfolio.solve();
+        report.assignment = portfolio.getAssignment();
+        report.decisions = portfolio.getNumDecisions();
+        report.backtracks = portfolio.getNumConflicts();
+        report.unit_propagations = portfolio.getNumPropagations();
+        details << "Portfolio winner: worker " << portfolio.getWinner()
+                << " (conflicts: " << portfolio.getNumConflicts()
+                << ", clauses shared: " << portfolio.getNumExportedClauses()
+                << ", imported: " << portfolio.getNumImportedClauses();
+        if (options.round_conflicts > 0)
+        {
+            details << ", decisions: " << portfolio.getNumDecisions()
+                    << ", propagations: " << portfolio.getNumPropagations()
+                    << ", rounds: " << portfolio.getNumRounds();
+        }
+        details << ")\n";
+    }
+    else if (engine == "lookahead")
+    {
+        LookaheadSolver lookahead(formula);
+        report.satisfiable = lookahead.solve();
+        report.assignment = lookahead.getAssignment();
+        report.decisions = lookahead.getNumDecisions();
+        report.unit_propagations = lookahead.getNumPropagations();
+        details << "Lookahead decisions: " << lookahead.getNumDecisions()
+                << ", lookaheads: " << lookahead.getNumLookaheads()
+                << ", propagations: " << lookahead.getNumPropagations()
+                << ", failed literals: " << lookahead.getNumFailedLiterals()
+                << ", autarkies: " << lookahead.getNumAutarkies()
+                << ", necessary assignments: " << lookahead.getNumNecessaryAssignments() << "\n";
+    }
+    else
+    {
+        BacktrackSolver solver(formula, workspace != nullptr ? workspace : &thread_workspace);
+        solver.setVerbose(options.verbose);
+        if (!options.checkpoint_path.empty() &&
+            solver.enableCheckpoints(options.checkpoint_path, std::chrono::milliseconds(static_cast<long long>(options.checkpoint_interval * 1000))))
+        {
+            details << "Resumed from checkpoint at depth " << solver.getResumedDepth() << "\n";
+        }
+        report.satisfiable = solver.solve();
+        report.assignment = solver.getAssignment();
+        report.decisions = solver.getNumDecisions();
+        report.backtracks = solver.getNumBacktracks();
+        report.unit_propagations = solver.getNumUnitPropagations();
+    }
+    report.assignment.resize(formula.getVariableCount(), BoolValue::UNASSIGNED);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    report.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    report.details = details.str();
+    return report;
+}
+
+/**
+<summary>
+Formats the options as KEY=VALUE lines, thresholds included, for sending to a worker.
+</summary>
+<returns>The options as text.</returns>
+*/
+std::string EngineOptions::toText() const
+{
+    std::ostringstream text;
+    text << "engine=" << name << "\n"
+         << "portfolio_workers=" << portfolio_workers << "\n"
+         << "share_clauses=" << (share_clauses ? 1 : 0) << "\n"
+         << "round_conflicts=" << round_conflicts << "\n"
+         << "inprocess_interval=" << inprocess_interval << "\n";
+    EngineSelector::writeThresholds(text, thresholds);
+    return text.str();
+}
+
+/**
+<summary>
+Parses options formatted by toText().
+</summary>
+<param name="text">The KEY=VALUE lines.</param>
+<param name="options">Receives the options; keys not in the text keep their values.</param>
+<returns>True if every line was valid, otherwise false.</returns>
+*/
+bool EngineOptions::fromText(const std::string &text, EngineOptions &options)
+{
+    std::istringstream lines(text);
+    std::string line, threshold_lines;
+    while (std::getline(lines, line))
+    {
+        size_t equals = line.find('=');
+        std::string key = line.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : line.substr(equals + 1);
+        if (key == "engine")
+        {
+            options.name = value;
+        }
+        else if (key == "portfolio_workers")
+        {
+            options.portfolio_workers = std::max(1, std::atoi(value.c_str()));
+        }
+        else if (key == "share_clauses")
+        {
+            options.share_clauses = value != "0";
+        }
+        else if (key == "round_conflicts")
+        {
+            options.round_conflicts = std::max(0LL, std::atoll(value.c_str()));
+        }
+        else if (key == "inprocess_interval")
+        {
+            options.inprocess_interval = std::max(0, std::atoi(value.c_str()));
+        }
+        else
+        {
+            threshold_lines += line + "\n"; // Everything else must be a threshold
+        }
+    }
+    std::istringstream thresholds(threshold_lines);
+    return EngineSelector::readThresholds(thresholds, options.thresholds);
+}
+
+/**
+<summary>
+Formats the report as a comma-separated row.
+</summary>
+<returns>The report as a row.</returns>
+*/
+std::string SolveReport::toRow() const
+{
+    std::ostringstream row;
+    row << (satisfiable ? "S," : "U,") << elapsed_us << "," << decisions << "," << backtracks << "," << unit_propagations;
+    for (BoolValue val : assignment)
+    {
+        row << (val == BoolValue::TRUE ? ",1" : val == BoolValue::FALSE ? ",0" : ",-1");
+    }
+    return row.str();
+}
+
+/**
+<summary>
+Parses a row produced by toRow().
+</summary>
+<param name="row">The row to parse.</param>
+<param name="report">Receives the parsed report.</param>
+<returns>True if the row was well formed, otherwise false.</returns>
+*/
+bool SolveReport::fromRow(const std::string &row, SolveReport &report)
+{
+    std::istringstream iss(row);
+    std::string token;
+    if (!std::getline(iss, token, ',') || (token != "S" && token != "U"))
+    {
+        return false;
+    }
+    report = SolveReport();
+    report.satisfiable = (token == "S");
+
+    char comma;
+    if (!(iss >> report.elapsed_us >> comma >> report.decisions >> comma >> report.backtracks >> comma >> report.unit_propagations))
+    {
+        return false;
+    }
+
+    int value;
+    while (iss >> comma >> value)
+    {
+        report.assignment.push_back(value == 1 ? BoolValue::TRUE : value == 0 ? BoolValue::FALSE : BoolValue::UNASSIGNED);
+    }
+    return true;
+}
@@ -0,0 +1,236 @@
+/**
+<summary>
+The SolverServer class keeps solver threads warm behind a Unix domain socket so
+that clients issuing many small queries pay neither process startup nor file
+I/O per query.
+</summary>
+*/
+#include "SolverServer.h"
+#include "FrameIO.h"
+#include "BooleanFormula.h"
+#include "SolveReport.h"
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// State shared between a connection's reader thread and the tasks solving its requests
+struct SolverServer::Connection
+{
+    int fd;
+    std::mutex write_mtx; // Serializes response frames from different workers
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t in_flight = 0;
+
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { ::close(fd); }
+};
+
+// Constructor for the SolverServer class
+SolverServer::SolverServer(const std::string &socket_path, size_t num_threads, size_t max_in_flight, ResultCache *cache,
+                           const EngineOptions &engine)
+    : socket_path(socket_path), max_in_flight(max_in_flight > 0 ? max_in_flight : 1), cache(cache), engine(engine), running(false),
+      pool(num_threads, num_threads * 2)
+{
+}
+
+// Destructor for the SolverServer class
+SolverServer::~SolverServer()
+{
+    requestStop();
+    {
+        std::unique_lock<std::mutex> lock(connections_mtx);
+        readers_done.wait(lock, [this]
+                          { return active_readers == 0; });
+    }
+    if (listen_fd >= 0)
+    {
+        ::close(listen_fd);
+        ::unlink(socket_path.c_str());
+    }
+}
+
+/**
+<summary>
+Binds the socket and accepts connections until requestStop() is called.
+</summary>
+*/
+void SolverServer::serve()
+{
+    listen_fd = FrameIO::listenOn("unix:" + socket_path);
+
+    running = true;
+    while (running)
+    {
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            break;
+        }
+
+        std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+        std::lock_guard<std::mutex> lock(connections_mtx);
+        connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                         [](const std::weak_ptr<Connection> &weak)
+                                         { return weak.expired(); }),
+                          connections.end());
+        connections.push_back(connection);
+        active_readers++;
+        std::thread(&SolverServer::handleConnection, this, connection).detach();
+    }
+    running = false;
+
+    // Unblock readers waiting for requests; responses still being solved are delivered
+    std::lock_guard<std::mutex> lock(connections_mtx);
+    for (const std::weak_ptr<Connection> &weak : connections)
+    {
+        std::shared_ptr<Connection> connection = weak.lock();
+        if (connection)
+        {
+            ::shutdown(connection->fd, SHUT_RD);
+        }
+    }
+}
+
+/**
+<summary>
+Asks serve() to return.
+</summary>
+*/
+void SolverServer::requestStop()
+{
+    running = false;
+    if (listen_fd >= 0)
+    {
+        ::shutdown(listen_fd, SHUT_RDWR);
+    }
+}
+
+/**
+<summary>
+Reads request frames from a connection and queues them on the pool.
+</summary>
+<param name="connection">The connection to serve.</param>
+*/
+void SolverServer::handleConnection(std::shared_ptr<Connection> connection)
+{
+    std::string payload;
+    while (FrameIO::readFrame(connection->fd, payload))
+    {
+        // Backpressure: stop reading until a request of this connection completes
+        {
+            std::unique_lock<std::mutex> lock(connection->mtx);
+            connection->cv.wait(lock, [&]
+                                { return connection->in_flight < max_in_flight; });
+            connection->in_flight++;
+        }
+
+        pool.submit([this, connection, payload]
+                    {
+                        handleRequest(connection, payload);
+                        std::lock_guard<std::mutex> lock(connection->mtx);
+                        connection->in_flight--;
+                        connection->cv.notify_one(); });
+    }
+
+    std::lock_guard<std::mutex> lock(connections_mtx);
+    active_readers--;
+    readers_done.notify_all();
+}
+
+/**
+<summary>
+Parses and solves one request, streaming a response frame per formula.
+</summary>
+<param name="connection">The connection the request arrived on.</param>
+<param name="payload">The request payload.</param>
+*/
+void SolverServer::handleRequest(const std::shared_ptr<Connection> &connection, const std::string &payload)
+{
+    size_t offset = 0;
+    uint32_t request_id = 0;
+    std::vector<BooleanFormula> formulas;
+    std::string error;
+
+    if (!FrameIO::readUint32(payload, offset, request_id) || offset >= payload.size())
+    {
+        error = "malformed request header";
+    }
+    else if (payload[offset] != 'D' && payload[offset] != 'B')
+    {
+        error = "unknown encoding";
+    }
+    else
+    {
+        // Out-of-range literals and malformed numbers throw; they are answered like any other bad request
+        try
+        {
+            if (payload[offset] == 'D')
+            {
+                std::istringstream input(payload.substr(offset + 1));
+                formulas = BooleanFormula::loadFromStream(input);
+            }
+            else
+            {
+                offset++;
+                std::vector<int32_t> literals;
+                uint32_t value;
+                while (FrameIO::readUint32(payload, offset, value))
+                {
+                    literals.push_back(static_cast<int32_t>(value));
+                }
+                formulas.push_back(BooleanFormula::fromLiterals(literals.data(), literals.size()));
+            }
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+    }
+
+    std::string header;
+    FrameIO::appendUint32(header, request_id);
+    if (!error.empty() || formulas.empty())
+    {
+        std::lock_guard<std::mutex> lock(connection->write_mtx);
+        FrameIO::writeFrame(connection->fd, header + "0/0,E," + (error.empty() ? "no formula" : error));
+        return;
+    }
+
+    for (size_t i = 0; i < formulas.size(); i++)
+    {
+        SolveReport report;
+        FormulaFingerprint fingerprint;
+        if (cache != nullptr)
+        {
+            fingerprint = ResultCache::fingerprint(formulas[i]);
+        }
+        if (cache == nullptr || !cache->lookup(formulas[i], fingerprint, report.satisfiable, report.assignment))
+        {
+            report = SolveReport::solve(formulas[i], engine);
+            if (cache != nullptr)
+            {
+                cache->store(formulas[i], fingerprint, report.satisfiable, report.assignment);
+            }
+        }
+        else if (!report.satisfiable)
+        {
+            report.assignment.assign(formulas[i].getVariableCount(), BoolValue::UNASSIGNED);
+        }
+        std::ostringstream row;
+        row << i + 1 << "/" << formulas.size() << "," << report.toRow();
+
+        std::lock_guard<std::mutex> lock(connection->write_mtx);
+        if (!FrameIO::writeFrame(connection->fd, header + row.str()))
+        {
+            return; // The client went away; skip the remaining formulas
+        }
+    }
+}
@@ -0,0 +1,651 @@
+/**
+<summary>
+The SymmetryBreaker class finds the automorphisms of a formula's clause graph
+and adds lex-leader clauses so that search visits one branch of each orbit.
+</summary>
+*/
+#include "SymmetryBreaker.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    // Partitions larger than this many entries over all levels of a path are not searched
+    const size_t MAX_PATH_ENTRIES = 64u << 20;
+
+    // Union-find over vertices: the orbits of the generators found so far
+    int findOrbit(std::vector<int> &parent, int vertex)
+    {
+        while (parent[vertex] != vertex)
+        {
+            parent[vertex] = parent[parent[vertex]];
+            vertex = parent[vertex];
+        }
+        return vertex;
+    }
+
+    void joinOrbits(std::vector<int> &parent, std::vector<int> &size, int a, int b)
+    {
+        a = findOrbit(parent, a);
+        b = findOrbit(parent, b);
+        if (a == b)
+        {
+            return;
+        }
+        if (size[a] < size[b])
+        {
+            std::swap(a, b);
+        }
+        parent[b] = a;
+        size[a] += size[b];
+    }
+}
+
+// Constructor for the SymmetryBreaker class
+SymmetryBreaker::SymmetryBreaker(const BooleanFormula &formula)
+    : formula(formula)
+{
+    int max_variable = 0;
+    for (const Clause &clause : formula.getClauses())
+    {
+        std::vector<int> lits;
+        for (const Literal &lit : clause.getLiterals())
+        {
+            lits.push_back(lit.getValue() == BoolValue::FALSE ? -lit.getVariable() : lit.getVariable());
+            max_variable = std::max(max_variable, lit.getVariable());
+        }
+        std::sort(lits.begin(), lits.end());
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+        bool tautology = false;
+        for (int lit : lits)
+        {
+            tautology |= lit > 0 && std::binary_search(lits.begin(), lits.end(), -lit);
+        }
+        if (!tautology)
+        {
+            clauses.push_back(lits);
+        }
+    }
+    // Repeated clauses would only add symmetries that move no literal
+    std::sort(clauses.begin(), clauses.end());
+    clauses.erase(std::unique(clauses.begin(), clauses.end()), clauses.end());
+
+    variable_index.assign(max_variable + 1, -1);
+    for (const std::vector<int> &lits : clauses)
+    {
+        for (int lit : lits)
+        {
+            variable_index[std::abs(lit)] = 0;
+        }
+    }
+    for (int var = 1; var <= max_variable; var++)
+    {
+        if (variable_index[var] == 0)
+        {
+            variable_index[var] = static_cast<int>(variables.size());
+            variables.push_back(var);
+        }
+    }
+
+    // Literal vertices first, each joined to its negation, then one vertex per clause
+    num_literal_vertices = 2 * static_cast<int>(variables.size());
+    adjacency.resize(num_literal_vertices + clauses.size());
+    for (int v = 0; v < num_literal_vertices; v += 2)
+    {
+        adjacency[v].push_back(v + 1);
+        adjacency[v + 1].push_back(v);
+    }
+    for (size_t c = 0; c < clauses.size(); c++)
+    {
+        int clause_vertex = num_literal_vertices + static_cast<int>(c);
+        for (int lit : clauses[c])
+        {
+            adjacency[clause_vertex].push_back(vertexOf(lit));
+            adjacency[vertexOf(lit)].push_back(clause_vertex);
+        }
+    }
+    for (std::vector<int> &neighbours : adjacency)
+    {
+        std::sort(neighbours.begin(), neighbours.end());
+    }
+}
+
+/**
+<summary>
+Gets the vertex of a DIMACS literal.
+</summary>
+<param name="literal">The literal.</param>
+<returns>The vertex, or -1 if its variable occurs in no clause.</returns>
+*/
+int SymmetryBreaker::vertexOf(int literal) const
+{
+    int var = std::abs(literal);
+    if (var >= static_cast<int>(variable_index.size()) || variable_index[var] < 0)
+    {
+        return -1;
+    }
+    return 2 * variable_index[var] + (literal < 0 ? 1 : 0);
+}
+
+/**
+<summary>
+Searches for generators of the formula's symmetry group.
+</summary>
+<returns>The number of generators found.</returns>
+<remarks>
+The left path individualizes the first vertex of the first smallest cell at each
+level until the partition is discrete. Going back up from its deepest level, each
+other vertex of the level's cell that is not yet in the orbit of the path's
+vertex is individualized instead, and the right subtree below it is searched for
+a leaf matching the left leaf. Generators found at a level fix the path above it,
+so the orbits of the generators found so far are orbits of the stabilizer of that
+path, and one match per orbit is enough.
+</remarks>
+*/
+int SymmetryBreaker::detect()
+{
+    generators.clear();
+    search_nodes = 0;
+    budget_exhausted = false;
+    group_size_log10 = 0;
+    int num_vertices = static_cast<int>(adjacency.size());
+    if (num_literal_vertices == 0)
+    {
+        return 0;
+    }
+
+    counts.assign(num_vertices, 0);
+    queued.assign(num_vertices, 0);
+    cell_back.assign(num_vertices, -1);
+
+    // Literal vertices and clause vertices start in different cells
+    Partition current;
+    current.lab.resize(num_vertices);
+    current.pos.resize(num_vertices);
+    current.cell_of.resize(num_vertices);
+    current.cell_end.assign(num_vertices, 0);
+    for (int v = 0; v < num_vertices; v++)
+    {
+        current.lab[v] = v;
+        current.pos[v] = v;
+        current.cell_of[v] = v < num_literal_vertices ? 0 : num_literal_vertices;
+    }
+    current.cell_end[0] = num_literal_vertices;
+    current.num_cells = 1;
+    std::vector<int> splitters = {0};
+    if (num_vertices > num_literal_vertices)
+    {
+        current.cell_end[num_literal_vertices] = num_vertices;
+        current.num_cells = 2;
+        splitters.push_back(num_literal_vertices);
+    }
+    refine(current, splitters);
+
+    // The left path, with the partition before each individualization
+    std::vector<Partition> levels;
+    std::vector<int> targets, path;
+    std::vector<uint64_t> hashes;
+    while (current.num_cells < num_vertices)
+    {
+        if (search_nodes >= search_budget || (levels.size() + 1) * static_cast<size_t>(num_vertices) > MAX_PATH_ENTRIES)
+        {
+            budget_exhausted = true;
+            return 0;
+        }
+        int target = -1;
+        for (int start = 0; start < num_vertices; start = current.cell_end[start])
+        {
+            int size = current.cell_end[start] - start;
+            if (size > 1 && (target < 0 || size < current.cell_end[target] - target))
+            {
+                target = start;
+            }
+        }
+        levels.push_back(current);
+        targets.push_back(target);
+        path.push_back(current.lab[target]);
+        hashes.push_back(individualize(current, current.lab[target]));
+    }
+    const Partition &left_leaf = current;
+
+    std::vector<int> orbit_parent(num_vertices), orbit_size(num_vertices, 1);
+    for (int v = 0; v < num_vertices; v++)
+    {
+        orbit_parent[v] = v;
+    }
+    std::vector<int> automorphism, failed;
+    for (size_t level = levels.size(); level-- > 0 && !budget_exhausted;)
+    {
+        TraceScope trace("symmetry level", static_cast<long long>(level));
+        const Partition &partition = levels[level];
+        int target = targets[level];
+        failed.clear();
+        for (int k = target + 1; k < partition.cell_end[target] && !budget_exhausted; k++)
+        {
+            int candidate = partition.lab[k];
+            int root = findOrbit(orbit_parent, candidate);
+            bool known = root == findOrbit(orbit_parent, path[level]);
+            for (int other : failed)
+            {
+                known |= root == findOrbit(orbit_parent, other);
+            }
+            if (known)
+            {
+                continue;
+            }
+            Partition right = partition;
+            if (individualize(right, candidate) == hashes[level] &&
+                searchRight(right, level, left_leaf, targets, path, hashes, automorphism))
+            {
+                for (int v = 0; v < num_vertices; v++)
+                {
+                    joinOrbits(orbit_parent, orbit_size, v, automorphism[v]);
+                }
+                std::vector<int> generator(variables.size());
+                for (size_t i = 0; i < variables.size(); i++)
+                {
+                    int image = automorphism[2 * i];
+                    generator[i] = (image & 1) ? -variables[image >> 1] : variables[image >> 1];
+                }
+                generators.push_back(generator);
+            }
+            else
+            {
+                failed.push_back(candidate);
+            }
+        }
+        group_size_log10 += std::log10(static_cast<double>(orbit_size[findOrbit(orbit_parent, path[level])]));
+    }
+    return static_cast<int>(generators.size());
+}
+
+/**
+<summary>
+Refines a partition until every cell has the same number of neighbours in each cell.
+</summary>
+<param name="partition">The partition to refine.</param>
+<param name="splitters">The cells whose neighbours may not be counted yet.</param>
+<returns>A hash of the splits made, equal for two partitions related by an automorphism.</returns>
+<remarks>
+Cells are split by the number of neighbours their vertices have in a splitter
+cell, fragments ordered by that number. Only the touched vertices of a cell are
+sorted, and a split cell that is not queued already queues every fragment but its
+largest, as in Hopcroft's minimization. The order of splits depends only on cell
+positions, which is what makes the hash comparable between two partitions.
+</remarks>
+*/
+uint64_t SymmetryBreaker::refine(Partition &partition, const std::vector<int> &splitters)
+{
+    search_nodes++;
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value)
+    {
+        hash = (hash ^ value) * 1099511628211ull;
+    };
+
+    for (int splitter : splitters)
+    {
+        if (!queued[splitter])
+        {
+            queued[splitter] = 1;
+            queue.push_back(splitter);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        int splitter = queue[head];
+        queued[splitter] = 0;
+
+        // Count the neighbours in the splitter and move them to the back of their cells
+        touched.clear();
+        split_cells.clear();
+        for (int k = splitter; k < partition.cell_end[splitter]; k++)
+        {
+            for (int u : adjacency[partition.lab[k]])
+            {
+                if (counts[u]++ == 0)
+                {
+                    touched.push_back(u);
+                }
+            }
+        }
+        for (int u : touched)
+        {
+            int cell = partition.cell_of[u];
+            if (partition.cell_end[cell] - cell == 1)
+            {
+                continue;
+            }
+            if (cell_back[cell] < 0)
+            {
+                cell_back[cell] = partition.cell_end[cell];
+                split_cells.push_back(cell);
+            }
+            int back = --cell_back[cell];
+            int displaced = partition.lab[back];
+            int from = partition.pos[u];
+            partition.lab[from] = displaced;
+            partition.pos[displaced] = from;
+            partition.lab[back] = u;
+            partition.pos[u] = back;
+        }
+        std::sort(split_cells.begin(), split_cells.end());
+        mix(splitter);
+        mix(touched.size());
+
+        for (int cell : split_cells)
+        {
+            int end = partition.cell_end[cell];
+            int back = cell_back[cell];
+            cell_back[cell] = -1;
+            std::sort(partition.lab.begin() + back, partition.lab.begin() + end, [&](int a, int b)
+                      { return counts[a] < counts[b]; });
+            for (int k = back; k < end; k++)
+            {
+                partition.pos[partition.lab[k]] = k;
+            }
+
+            // Fragments: the untouched vertices, then the touched ones by count
+            std::vector<int> &starts = fragment_starts;
+            starts.clear();
+            if (back > cell)
+            {
+                starts.push_back(cell);
+            }
+            for (int k = back; k < end; k++)
+            {
+                if (k == back || counts[partition.lab[k]] != counts[partition.lab[k - 1]])
+                {
+                    starts.push_back(k);
+                }
+            }
+            mix(cell);
+            for (int start : starts)
+            {
+                mix(counts[partition.lab[start]]);
+                mix(start);
+            }
+            if (starts.size() == 1)
+            {
+                continue;
+            }
+
+            starts.push_back(end);
+            int largest = 0;
+            for (size_t f = 0; f + 1 < starts.size(); f++)
+            {
+                partition.cell_end[starts[f]] = starts[f + 1];
+                for (int k = starts[f]; f > 0 && k < starts[f + 1]; k++)
+                {
+                    partition.cell_of[partition.lab[k]] = starts[f];
+                }
+                if (starts[f + 1] - starts[f] > starts[largest + 1] - starts[largest])
+                {
+                    largest = static_cast<int>(f);
+                }
+            }
+            partition.num_cells += static_cast<int>(starts.size()) - 2;
+            bool whole = queued[cell] != 0;
+            for (size_t f = 0; f + 1 < starts.size(); f++)
+            {
+                if ((whole || static_cast<int>(f) != largest) && !queued[starts[f]])
+                {
+                    queued[starts[f]] = 1;
+                    queue.push_back(starts[f]);
+                }
+            }
+        }
+        for (int u : touched)
+        {
+            counts[u] = 0;
+        }
+    }
+    queue.clear();
+    mix(partition.num_cells);
+    return hash;
+}
+
+/**
+<summary>
+Moves a vertex into a cell of its own at the start of its cell and refines.
+</summary>
+<param name="partition">The partition.</param>
+<param name="vertex">The vertex, in a cell of two or more.</param>
+<returns>The hash of the refinement.</returns>
+*/
+uint64_t SymmetryBreaker::individualize(Partition &partition, int vertex)
+{
+    int cell = partition.cell_of[vertex];
+    int first = partition.lab[cell];
+    int from = partition.pos[vertex];
+    partition.lab[from] = first;
+    partition.pos[first] = from;
+    partition.lab[cell] = vertex;
+    partition.pos[vertex] = cell;
+
+    int end = partition.cell_end[cell];
+    partition.cell_end[cell] = cell + 1;
+    partition.cell_end[cell + 1] = end;
+    for (int k = cell + 1; k < end; k++)
+    {
+        partition.cell_of[partition.lab[k]] = cell + 1;
+    }
+    partition.num_cells++;
+    return refine(partition, {cell});
+}
+
+/**
+<summary>
+Searches the right partition's subtree for a leaf matching the left path.
+</summary>
+<param name="right">The right partition after individualizing at the given level.</param>
+<param name="level">The level of the last individualization.</param>
+<param name="left_leaf">The discrete partition at the end of the left path.</param>
+<param name="targets">The cell the left path individualized at each level.</param>
+<param name="path">The vertex the left path individualized at each level.</param>
+<param name="hashes">The refinement hash of the left path after each level.</param>
+<param name="automorphism">Receives the automorphism found.</param>
+<returns>True if an automorphism was found.</returns>
+<remarks>
+The left path's own vertex is tried first at each level, since most symmetries
+of a formula move few of its variables.
+</remarks>
+*/
+bool SymmetryBreaker::searchRight(const Partition &right, size_t level, const Partition &left_leaf, const std::vector<int> &targets,
+                                  const std::vector<int> &path, const std::vector<uint64_t> &hashes, std::vector<int> &automorphism)
+{
+    int num_vertices = static_cast<int>(adjacency.size());
+    if (level + 1 == targets.size())
+    {
+        if (right.num_cells != num_vertices)
+        {
+            return false;
+        }
+        automorphism.resize(num_vertices);
+        for (int k = 0; k < num_vertices; k++)
+        {
+            automorphism[left_leaf.lab[k]] = right.lab[k];
+        }
+        return isAutomorphism(automorphism);
+    }
+
+    int target = targets[level + 1];
+    int end = right.cell_end[target];
+    if (right.cell_of[right.lab[target]] != target || end - target < 2)
+    {
+        return false;
+    }
+    std::vector<int> candidates(right.lab.begin() + target, right.lab.begin() + end);
+    if (right.cell_of[path[level + 1]] == target)
+    {
+        std::iter_swap(candidates.begin(), std::find(candidates.begin(), candidates.end(), path[level + 1]));
+    }
+    for (int candidate : candidates)
+    {
+        if (search_nodes >= search_budget)
+        {
+            budget_exhausted = true;
+            return false;
+        }
+        Partition next = right;
+        if (individualize(next, candidate) == hashes[level + 1] &&
+            searchRight(next, level + 1, left_leaf, targets, path, hashes, automorphism))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+<summary>
+Tells whether a vertex permutation maps every edge to an edge.
+</summary>
+<param name="permutation">The image of each vertex.</param>
+<returns>True if it is an automorphism of the graph.</returns>
+*/
+bool SymmetryBreaker::isAutomorphism(const std::vector<int> &permutation) const
+{
+    for (size_t v = 0; v < adjacency.size(); v++)
+    {
+        const std::vector<int> &image = adjacency[permutation[v]];
+        if (image.size() != adjacency[v].size())
+        {
+            return false;
+        }
+        for (int u : adjacency[v])
+        {
+            if (!std::binary_search(image.begin(), image.end(), permutation[u]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+<summary>
+Writes the lex-leader clauses of one generator.
+</summary>
+<param name="generator">The image of each variable's positive literal.</param>
+<param name="next_variable">The next free auxiliary variable; advanced past those used.</param>
+<param name="output">Receives the clauses as DIMACS literals.</param>
+<remarks>
+With x1, x2, ... the variables the generator moves, in ascending order, and y1,
+y2, ... their images, the clauses state x1 y1 <= ... lexicographically, FALSE
+before TRUE: x1 <= y1, and for each i an auxiliary e(i+1) that is forced TRUE
+when e(i) holds and xi equals yi, and under which x(i+1) <= y(i+1). An auxiliary
+is never forced otherwise, so any assignment that is no larger than its image
+extends to the auxiliaries. A variable mapped to its own negation ends the chain,
+since it can only equal its image by being FALSE.
+</remarks>
+*/
+void SymmetryBreaker::breakGenerator(const std::vector<int> &generator, int &next_variable, std::vector<std::vector<int>> &output) const
+{
+    std::vector<size_t> support;
+    for (size_t i = 0; i < variables.size() && static_cast<int>(support.size()) < max_breaking_size; i++)
+    {
+        if (generator[i] != variables[i])
+        {
+            support.push_back(i);
+        }
+    }
+
+    int equal = 0; // 0 while the prefix is empty
+    for (size_t s = 0; s < support.size(); s++)
+    {
+        int x = variables[support[s]], y = generator[support[s]];
+        std::vector<int> prefix;
+        if (equal != 0)
+        {
+            prefix.push_back(-equal);
+        }
+        if (y == -x)
+        {
+            prefix.push_back(-x);
+            output.push_back(prefix);
+            return;
+        }
+        std::vector<int> below = prefix;
+        below.push_back(-x);
+        below.push_back(y);
+        output.push_back(below);
+        if (s + 1 == support.size())
+        {
+            return;
+        }
+
+        int next_equal = next_variable++;
+        std::vector<int> both_true = prefix, both_false = prefix;
+        both_true.insert(both_true.end(), {-x, -y, next_equal});
+        both_false.insert(both_false.end(), {x, y, next_equal});
+        output.push_back(both_true);
+        output.push_back(both_false);
+        equal = next_equal;
+    }
+}
+
+/**
+<summary>
+Builds the formula with the lex-leader clauses of every generator added.
+</summary>
+<param name="num_vars">The variable count of the original formula; auxiliary variables are numbered after it.</param>
+<returns>The clauses of the formula and the breaking clauses, with the answer of the formula.</returns>
+*/
+BooleanFormula SymmetryBreaker::getBrokenFormula(int num_vars) const
+{
+    BooleanFormula broken = formula;
+    int next_variable = num_vars + 1;
+    std::vector<std::vector<int>> breaking;
+    for (const std::vector<int> &generator : generators)
+    {
+        breakGenerator(generator, next_variable, breaking);
+    }
+    for (const std::vector<int> &lits : breaking)
+    {
+        Clause clause;
+        for (int lit : lits)
+        {
+            clause.addLiteral(Literal(std::abs(lit), lit < 0 ? BoolValue::FALSE : BoolValue::TRUE));
+        }
+        broken.addClause(clause);
+    }
+    return broken;
+}
+
+/**
+<summary>
+Gets the number of clauses getBrokenFormula() adds.
+</summary>
+<returns>The number of breaking clauses.</returns>
+*/
+int SymmetryBreaker::getNumBreakingClauses() const
+{
+    int next_variable = 1;
+    std::vector<std::vector<int>> breaking;
+    for (const std::vector<int> &generator : generators)
+    {
+        breakGenerator(generator, next_variable, breaking);
+    }
+    return static_cast<int>(breaking.size());
+}
+
+/**
+<summary>
+Gets the number of auxiliary variables getBrokenFormula() adds.
+</summary>
+<returns>The number of auxiliary variables.</returns>
+*/
+int SymmetryBreaker::getNumAuxiliaryVariables() const
+{
+    int next_variable = 1;
+    std::vector<std::vector<int>> breaking;
+    for (const std::vector<int> &generator : generators)
+    {
+        breakGenerator(generator, next_variable, breaking);
+    }
+    return next_variable - 1;
+}
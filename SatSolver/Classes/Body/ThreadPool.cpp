@@ -0,0 +1,73 @@
+/**
+<summary>
+The ThreadPool class keeps a fixed set of warm worker threads that run queued
+tasks, with a bounded queue that applies backpressure to producers.
+</summary>
+*/
+#include "ThreadPool.h"
+
+// Constructor for the ThreadPool class
+ThreadPool::ThreadPool(size_t num_threads, size_t max_queued)
+    : max_queued(max_queued > 0 ? max_queued : 1)
+{
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+// Destructor for the ThreadPool class
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    not_empty.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+<summary>
+Queues a task. Blocks while the queue is full.
+</summary>
+<param name="task">The task to run on a worker thread.</param>
+*/
+void ThreadPool::submit(std::function<void()> task)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    not_full.wait(lock, [this]
+                  { return tasks.size() < max_queued; });
+    tasks.push_back(std::move(task));
+    lock.unlock();
+    not_empty.notify_one();
+}
+
+/**
+<summary>
+Runs queued tasks until the pool is stopped and the queue is empty.
+</summary>
+*/
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            not_empty.wait(lock, [this]
+                           { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+            {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        not_full.notify_one();
+        task();
+    }
+}
@@ -0,0 +1,138 @@
+#include "Tracer.h"
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+
+bool Tracer::enabled = false;
+size_t Tracer::capacity = 0;
+std::chrono::steady_clock::time_point Tracer::epoch = std::chrono::steady_clock::now();
+std::mutex Tracer::registry_mtx;
+std::vector<std::shared_ptr<Tracer::ThreadBuffer>> Tracer::registry;
+
+/**
+<summary>
+Turns tracing on.
+</summary>
+<param name="events_per_thread">The capacity of each thread's ring buffer.</param>
+*/
+void Tracer::enable(size_t events_per_thread)
+{
+    capacity = std::max<size_t>(1, events_per_thread);
+    epoch = std::chrono::steady_clock::now();
+    enabled = true;
+}
+
+/**
+<summary>
+Names the calling thread in the exported trace.
+</summary>
+<param name="name">The name of the thread.</param>
+*/
+void Tracer::setThreadName(const std::string &name)
+{
+    if (enabled)
+    {
+        threadBuffer().name = name;
+    }
+}
+
+/**
+<summary>
+Records an event on the calling thread.
+</summary>
+<param name="name">The name of the event, a string literal.</param>
+<param name="start">The start time from now().</param>
+<param name="duration">The duration in nanoseconds, or -1 for an instant event.</param>
+<param name="arg">A value shown with the event, or -1 for none.</param>
+*/
+void Tracer::record(const char *name, int64_t start, int64_t duration, long long arg)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    if (buffer.events.size() < capacity)
+    {
+        // Grow up to the capacity, so short-lived threads stay small
+        buffer.events.push_back({name, start, duration, arg});
+        return;
+    }
+    buffer.events[buffer.next] = {name, start, duration, arg};
+    if (++buffer.next == buffer.events.size())
+    {
+        buffer.next = 0;
+    }
+}
+
+/**
+<summary>
+Gets the calling thread's buffer, registering it on first use.
+</summary>
+<returns>The buffer.</returns>
+*/
+Tracer::ThreadBuffer &Tracer::threadBuffer()
+{
+    static thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer)
+    {
+        buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(registry_mtx);
+        buffer->id = static_cast<int>(registry.size()) + 1;
+        buffer->name = "thread " + std::to_string(buffer->id);
+        registry.push_back(buffer);
+    }
+    return *buffer;
+}
+
+/**
+<summary>
+Writes the events of every thread as Chrome trace JSON.
+</summary>
+<param name="path">The file to write.</param>
+<returns>True if the file was written, otherwise false.</returns>
+<remarks>
+Complete events use phase "X" and instant events phase "i"; times are in
+microseconds as the format requires. A thread whose buffer wrapped keeps only
+its most recent events.
+</remarks>
+*/
+bool Tracer::writeChromeTrace(const std::string &path)
+{
+    std::ofstream output(path);
+    if (!output.is_open())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mtx);
+    output << std::fixed << std::setprecision(3);
+    output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto &buffer : registry)
+    {
+        output << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+               << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+        first = false;
+
+        // Once full, the oldest event is the one to be overwritten next
+        size_t begin = buffer->next;
+        for (size_t i = 0; i < buffer->events.size(); i++)
+        {
+            const Event &event = buffer->events[(begin + i) % buffer->events.size()];
+            output << ",\n{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << buffer->id
+                   << ",\"ts\":" << event.start / 1000.0;
+            if (event.duration < 0)
+            {
+                output << ",\"ph\":\"i\",\"s\":\"t\"";
+            }
+            else
+            {
+                output << ",\"ph\":\"X\",\"dur\":" << event.duration / 1000.0;
+            }
+            if (event.arg >= 0)
+            {
+                output << ",\"args\":{\"value\":" << event.arg << "}";
+            }
+            output << "}";
+        }
+    }
+    output << "\n]}\n";
+    return static_cast<bool>(output);
+}
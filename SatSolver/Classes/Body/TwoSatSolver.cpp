@@ -0,0 +1,121 @@
+/**
+<summary>
+The TwoSatSolver class decides 2-CNF formulas in linear time from the strongly
+connected components of their implication graph.
+</summary>
+*/
+#include "TwoSatSolver.h"
+#include <algorithm>
+
+// Constructor for the TwoSatSolver class
+TwoSatSolver::TwoSatSolver(const BooleanFormula &formula)
+    : num_vars(formula.getVariableCount()), edges(2 * num_vars), model(num_vars, BoolValue::UNASSIGNED)
+{
+    for (const Clause &clause : formula.getClauses())
+    {
+        const std::vector<Literal> &literals = clause.getLiterals();
+        if (literals.empty())
+        {
+            consistent = false;
+            continue;
+        }
+        int a = 2 * (literals[0].getVariable() - 1) + (literals[0].getValue() == BoolValue::FALSE ? 1 : 0);
+        int b = literals.size() > 1 ? 2 * (literals[1].getVariable() - 1) + (literals[1].getValue() == BoolValue::FALSE ? 1 : 0) : a;
+        edges[a ^ 1].push_back(b);
+        if (b != a)
+        {
+            edges[b ^ 1].push_back(a);
+        }
+    }
+}
+
+/**
+<summary>
+Searches for a model.
+</summary>
+<returns>True if the formula is satisfiable, otherwise false.</returns>
+<remarks>
+Tarjan's algorithm runs with an explicit stack so that long implication chains
+cannot overflow the call stack. It numbers the components in reverse
+topological order, so a literal whose component has the smaller number is
+implied by, never implies, its negation's component and can be made TRUE.
+</remarks>
+*/
+bool TwoSatSolver::solve()
+{
+    if (!consistent)
+    {
+        return false;
+    }
+    int num_lits = 2 * num_vars;
+    std::vector<int> order(num_lits, -1), low(num_lits, 0), component_of(num_lits, -1);
+    std::vector<char> on_stack(num_lits, 0);
+    std::vector<int> component;
+    std::vector<std::pair<int, size_t>> calls;
+    int counter = 0;
+    num_components = 0;
+
+    for (int root = 0; root < num_lits; root++)
+    {
+        if (order[root] != -1)
+        {
+            continue;
+        }
+        order[root] = low[root] = counter++;
+        component.push_back(root);
+        on_stack[root] = 1;
+        calls.push_back(std::make_pair(root, 0));
+
+        while (!calls.empty())
+        {
+            int node = calls.back().first;
+            size_t &next_edge = calls.back().second;
+            if (next_edge < edges[node].size())
+            {
+                int target = edges[node][next_edge++];
+                if (order[target] == -1)
+                {
+                    order[target] = low[target] = counter++;
+                    component.push_back(target);
+                    on_stack[target] = 1;
+                    calls.push_back(std::make_pair(target, 0));
+                }
+                else if (on_stack[target])
+                {
+                    low[node] = std::min(low[node], order[target]);
+                }
+                continue;
+            }
+
+            calls.pop_back();
+            if (!calls.empty())
+            {
+                int parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[node]);
+            }
+            if (low[node] == order[node])
+            {
+                int lit;
+                do
+                {
+                    lit = component.back();
+                    component.pop_back();
+                    on_stack[lit] = 0;
+                    component_of[lit] = num_components;
+                } while (lit != node);
+                num_components++;
+            }
+        }
+    }
+
+    for (int var = 0; var < num_vars; var++)
+    {
+        if (component_of[2 * var] == component_of[2 * var + 1])
+        {
+            model.assign(num_vars, BoolValue::UNASSIGNED);
+            return false;
+        }
+        model[var] = component_of[2 * var] < component_of[2 * var + 1] ? BoolValue::TRUE : BoolValue::FALSE;
+    }
+    return true;
+}
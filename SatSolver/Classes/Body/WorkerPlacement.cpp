@@ -0,0 +1,282 @@
+#include "WorkerPlacement.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef __linux__
+namespace
+{
+    // Parses a kernel CPU list such as "0-3,8-11"
+    std::vector<int> parseCpuList(const std::string &text)
+    {
+        std::vector<int> cpus;
+        std::istringstream iss(text);
+        std::string range;
+        while (std::getline(iss, range, ','))
+        {
+            int first, last;
+            char dash;
+            std::istringstream parts(range);
+            if (!(parts >> first))
+            {
+                continue;
+            }
+            last = (parts >> dash >> last) ? last : first;
+            for (int cpu = first; cpu <= last; cpu++)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    std::string readLine(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+}
+#endif
+
+// Constructor for the WorkerPlacement class
+WorkerPlacement::WorkerPlacement(const std::vector<NumaNode> &nodes, int num_workers, size_t num_items)
+    : nodes(nodes), worker_nodes(num_workers), worker_cpus(num_workers, -1), ranges(new NodeRange[nodes.size()]), steal_orders(nodes.size())
+{
+    // Workers per node in proportion to its CPUs, largest remainders first
+    size_t total_cpus = 0;
+    for (const NumaNode &node : nodes)
+    {
+        total_cpus += std::max<size_t>(1, node.cpus.size());
+    }
+    std::vector<int> node_workers(nodes.size());
+    std::vector<std::pair<size_t, int>> remainders;
+    int placed = 0;
+    for (size_t n = 0; n < nodes.size(); n++)
+    {
+        size_t share = std::max<size_t>(1, nodes[n].cpus.size()) * num_workers;
+        node_workers[n] = static_cast<int>(share / total_cpus);
+        placed += node_workers[n];
+        remainders.push_back({share % total_cpus, -static_cast<int>(n)});
+    }
+    std::sort(remainders.rbegin(), remainders.rend());
+    for (size_t r = 0; placed < num_workers; r++, placed++)
+    {
+        node_workers[-remainders[r].second]++;
+    }
+
+    // Workers in node order, each on the next core of its node
+    int worker = 0;
+    for (size_t n = 0; n < nodes.size(); n++)
+    {
+        for (int k = 0; k < node_workers[n]; k++, worker++)
+        {
+            worker_nodes[worker] = static_cast<int>(n);
+            if (!nodes[n].cpus.empty())
+            {
+                worker_cpus[worker] = nodes[n].cpus[k % nodes[n].cpus.size()];
+            }
+        }
+    }
+
+    // Contiguous item ranges in proportion to the workers of each node
+    size_t begin = 0;
+    int workers_before = 0;
+    for (size_t n = 0; n < nodes.size(); n++)
+    {
+        workers_before += node_workers[n];
+        size_t end = num_workers > 0 ? num_items * workers_before / num_workers : num_items;
+        ranges[n].begin = begin;
+        ranges[n].end = end;
+        ranges[n].cursor.store(begin);
+        begin = end;
+    }
+
+    // Steal from the nearest nodes first; unknown distances count as far
+    for (size_t n = 0; n < nodes.size(); n++)
+    {
+        auto distance = [&](size_t other)
+        {
+            size_t id = static_cast<size_t>(nodes[other].id);
+            return id < nodes[n].distances.size() ? nodes[n].distances[id] : 1 << 20;
+        };
+        for (size_t other = 0; other < nodes.size(); other++)
+        {
+            if (other != n)
+            {
+                steal_orders[n].push_back(static_cast<int>(other));
+            }
+        }
+        std::stable_sort(steal_orders[n].begin(), steal_orders[n].end(), [&](int a, int b)
+                         { return distance(a) < distance(b); });
+    }
+}
+
+/**
+<summary>
+Reads the NUMA nodes of the machine from sysfs.
+</summary>
+<param name="root">The sysfs node directory.</param>
+<returns>The online nodes with CPUs this process may use; one node holding every allowed CPU if sysfs has none.</returns>
+<remarks>
+CPUs outside the process's affinity mask, as set by taskset or a cgroup, are
+left out, and so are nodes left without CPUs. Outside Linux there is one node
+without CPUs, so nothing is pinned.
+</remarks>
+*/
+std::vector<NumaNode> WorkerPlacement::detectNodes(const std::string &root)
+{
+#ifndef __linux__
+    (void)root;
+    return std::vector<NumaNode>(1, NumaNode{0, {}, {}});
+#else
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    auto isAllowed = [&](int cpu)
+    {
+        return !have_mask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed));
+    };
+
+    std::vector<NumaNode> nodes;
+    for (int id : parseCpuList(readLine(root + "/online")))
+    {
+        std::string directory = root + "/node" + std::to_string(id);
+        NumaNode node;
+        node.id = id;
+        for (int cpu : parseCpuList(readLine(directory + "/cpulist")))
+        {
+            if (isAllowed(cpu))
+            {
+                node.cpus.push_back(cpu);
+            }
+        }
+        std::istringstream distances(readLine(directory + "/distance"));
+        for (int distance; distances >> distance;)
+        {
+            node.distances.push_back(distance);
+        }
+        if (!node.cpus.empty())
+        {
+            nodes.push_back(node);
+        }
+    }
+
+    if (nodes.empty())
+    {
+        NumaNode node;
+        node.id = 0;
+        for (int cpu = 0; have_mask && cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                node.cpus.push_back(cpu);
+            }
+        }
+        nodes.push_back(node);
+    }
+    return nodes;
+#endif
+}
+
+/**
+<summary>
+Binds the calling thread to a set of CPUs.
+</summary>
+<param name="cpus">The CPUs; empty leaves the thread unbound.</param>
+<returns>True if the thread was bound, otherwise false; always false outside Linux.</returns>
+*/
+bool WorkerPlacement::pinCurrentThread(const std::vector<int> &cpus)
+{
+#ifndef __linux__
+    (void)cpus;
+    return false;
+#else
+    if (cpus.empty())
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+/**
+<summary>
+Binds the calling thread to the core of a worker.
+</summary>
+<param name="worker">The worker index.</param>
+<returns>True if the thread was bound, otherwise false.</returns>
+*/
+bool WorkerPlacement::pin(int worker) const
+{
+    return worker_cpus[worker] >= 0 && pinCurrentThread({worker_cpus[worker]});
+}
+
+/**
+<summary>
+Takes the next item for a worker: from its own node's range, else from the nearest node with items left.
+</summary>
+<param name="worker">The worker index.</param>
+<param name="item">Receives the item.</param>
+<returns>False once every item has been handed out, otherwise true.</returns>
+*/
+bool WorkerPlacement::next(int worker, size_t &item)
+{
+    int home = worker_nodes[worker];
+    NodeRange &own = ranges[home];
+    if (own.cursor.load(std::memory_order_relaxed) < own.end && (item = own.cursor++) < own.end)
+    {
+        return true;
+    }
+    for (int other : steal_orders[home])
+    {
+        NodeRange &range = ranges[other];
+        if (range.cursor.load(std::memory_order_relaxed) < range.end && (item = range.cursor++) < range.end)
+        {
+            num_stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+<summary>
+Gets the CPUs of a worker's node, starting with the worker's own core.
+</summary>
+<param name="worker">The worker index.</param>
+<returns>The CPUs, for threads the worker starts; empty if the node lists none.</returns>
+*/
+std::vector<int> WorkerPlacement::getNodeCpus(int worker) const
+{
+    std::vector<int> cpus = nodes[worker_nodes[worker]].cpus;
+    auto own = std::find(cpus.begin(), cpus.end(), worker_cpus[worker]);
+    std::rotate(cpus.begin(), own == cpus.end() ? cpus.begin() : own, cpus.end());
+    return cpus;
+}
+
+/**
+<summary>
+Gets the number of nodes that received workers.
+</summary>
+<returns>The number of nodes in use.</returns>
+*/
+int WorkerPlacement::getNumNodesUsed() const
+{
+    std::vector<int> used(worker_nodes);
+    return static_cast<int>(std::unique(used.begin(), used.end()) - used.begin());
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include "CdclSolver.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+/**
+<summary>
+Computes the backbone of a satisfiable formula: the literals that are TRUE in
+every model. The first model gives one candidate literal per variable, and every
+later model drops the candidates it falsifies.
+</summary>
+<remarks>
+Candidates are tested in chunks on incremental CdclSolvers: a clause saying that
+some literal of the chunk is FALSE is added behind a fresh activation literal
+and the solver is called assuming it. If that is unsatisfiable, the whole chunk
+is backbone and is fixed by unit clauses; otherwise the model found refutes at
+least one candidate and usually many. Each model also refutes every candidate
+it can flip without falsifying a clause, since every clause holding such a
+literal has another TRUE literal.
+</remarks>
+<remarks>
+Chunks are spread over several workers, each with its own solver. A refuted
+candidate and a backbone literal are facts about the formula, so every result
+holds whatever the other workers found meanwhile.
+</remarks>
+*/
+class BackboneExtractor
+{
+public:
+    /**
+    <summary>
+    Constructor for the BackboneExtractor class.
+    </summary>
+    <param name="formula">The Boolean formula; it must outlive the extractor.</param>
+    <param name="num_workers">The number of solvers testing chunks in parallel.</param>
+    */
+    BackboneExtractor(const BooleanFormula &formula, int num_workers = 1);
+
+    /**
+    <summary>
+    Decides the formula and, if it is satisfiable, computes its backbone.
+    </summary>
+    <returns>True if the formula is satisfiable, otherwise false.</returns>
+    */
+    bool compute();
+
+    /**
+    <summary>
+    Sets the number of candidates tested by one solver call.
+    </summary>
+    <param name="size">The chunk size.</param>
+    */
+    void setChunkSize(int size) { chunk_size = size > 0 ? size : 1; }
+
+    /**
+    <summary>
+    Gets the backbone found by compute().
+    </summary>
+    <returns>The backbone literals as DIMACS integers, by ascending variable; empty if the formula is unsatisfiable.</returns>
+    */
+    const std::vector<int> &getBackbone() const { return backbone; }
+
+    /**
+    <summary>
+    Gets the first model found.
+    </summary>
+    <returns>One BoolValue per variable; UNASSIGNED throughout if the formula is unsatisfiable.</returns>
+    */
+    const std::vector<BoolValue> &getAssignment() const { return model; }
+
+    /**
+    <summary>
+    Gets the number of calls to the SAT solvers.
+    </summary>
+    <returns>The number of calls.</returns>
+    */
+    unsigned long long getNumSatCalls() const { return num_sat_calls; }
+
+    /**
+    <summary>
+    Gets the number of chunks proven backbone by one unsatisfiable call.
+    </summary>
+    <returns>The number of unsatisfiable chunks.</returns>
+    */
+    unsigned long long getNumBackboneChunks() const { return num_backbone_chunks; }
+
+    /**
+    <summary>
+    Gets the number of candidates refuted because a model falsified them.
+    </summary>
+    <returns>The number of candidates refuted by models.</returns>
+    */
+    unsigned long long getNumFilteredByModels() const { return num_filtered; }
+
+    /**
+    <summary>
+    Gets the number of candidates refuted because a model could flip them.
+    </summary>
+    <returns>The number of candidates refuted by flipping.</returns>
+    */
+    unsigned long long getNumFilteredByFlips() const { return num_flipped; }
+
+private:
+    enum class Status
+    {
+        CANDIDATE,
+        BACKBONE,
+        REFUTED
+    };
+
+    // A solver of the formula and how many of the backbone literals it holds
+    struct Worker
+    {
+        std::unique_ptr<CdclSolver> sat;
+        size_t fixed_added = 0;
+    };
+
+    const BooleanFormula &formula;
+    int num_workers;
+    int num_vars;
+    int chunk_size = 16;
+    std::vector<std::vector<int>> clauses;     // Distinct DIMACS literals of each clause but tautologies
+    std::vector<std::vector<int>> occurrences; // Clauses of each internal literal 2 * (var - 1) + negative
+    std::vector<Worker> workers;
+
+    // Shared by the workers under mtx
+    std::mutex mtx;
+    std::condition_variable changed;
+    std::vector<Status> status;       // Per variable
+    std::vector<int> candidate;       // Per variable: the DIMACS literal of the first model
+    std::vector<char> in_flight;      // Per variable: in a chunk a worker is testing
+    std::vector<int> fixed;           // Backbone literals found so far, in order
+    size_t next_candidate = 0;        // Variables before it are decided
+    int num_in_flight = 0;
+    std::vector<int> true_counts;     // Scratch of filter(): TRUE literals of each clause
+
+    std::vector<int> backbone;
+    std::vector<BoolValue> model;
+    unsigned long long num_sat_calls = 0;
+    unsigned long long num_backbone_chunks = 0;
+    unsigned long long num_filtered = 0;
+    unsigned long long num_flipped = 0;
+
+    /**
+    <summary>
+    Tests chunks of candidates until every variable is decided.
+    </summary>
+    <param name="worker">The worker's solver.</param>
+    */
+    void probe(Worker &worker);
+
+    /**
+    <summary>
+    Refutes the candidates a model falsifies or can flip; the caller holds mtx.
+    </summary>
+    <param name="assignment">The model, one BoolValue per variable of the solver.</param>
+    */
+    void filter(const std::vector<BoolValue> &assignment);
+};
@@ -4,11 +4,18 @@
 #include "BooleanFormula.h"
 #include "Clause.h"
 #include "Literal.h"
+#include "ModelCount.h"
+#include "ClauseStore.h"
+#include "SolverWorkspace.h"
+#include "Checkpointer.h"
 #include <vector>
 #include <iostream>
-#include <set>
 #include <cstdlib>
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <chrono>
 
 class BacktrackSolver
 {
@@ -17,9 +24,14 @@ public:
     <summary>
     Constructor for the BacktrackSolver class.
     </summary>
-    <param name="formula">The Boolean formula to be solved.</param>
+    <param name="formula">The Boolean formula to be solved; it is only read.</param>
+    <param name="workspace">
+    Storage to reuse for the solve, typically owned by the calling worker; nullptr
+    gives the solver its own. It is reset here, so it must not be shared by two
+    live solvers.
+    </param>
     */
-    BacktrackSolver(BooleanFormula &formula);
+    BacktrackSolver(const BooleanFormula &formula, SolverWorkspace *workspace = nullptr);
 
     /**
     <summary>
@@ -29,11 +41,50 @@ public:
     */
     bool solve();
 
+    /**
+    <summary>
+    Makes solve() write snapshots of its search to a file, and resume from the
+    snapshot already in that file if it was written for the same formula. The
+    file is deleted once solve() finishes.
+    </summary>
+    <param name="path">The snapshot file.</param>
+    <param name="interval">The minimum time between two snapshots.</param>
+    <returns>True if a snapshot was loaded and the search will resume from it.</returns>
+    */
+    bool enableCheckpoints(const std::string &path, std::chrono::milliseconds interval);
+
+    /**
+    <summary>
+    Sets whether solve() prints the model it finds on the standard output.
+    </summary>
+    <param name="verbose">True to print the model; the daemon and the distributed workers leave it off.</param>
+    */
+    void setVerbose(bool verbose) { this->verbose = verbose; }
+
+    /**
+    <summary>
+    Enumerates the models of the formula projected onto a set of variables.
+    Every model found is blocked with a clause over its projected literals and
+    the search resumes from the node where it was found, so the solver state
+    is reused between models instead of restarting.
+    </summary>
+    <param name="projection">The 1-based variables to project onto; empty means all variables.</param>
+    <param name="limit">The maximum number of projected models to find; 0 means no limit.</param>
+    <param name="on_model">Called with the assignment of each model; returning false stops the enumeration.</param>
+    <returns>The number of distinct projected models found.</returns>
+    <remarks>
+    A model may leave projected variables UNASSIGNED; it then stands for every
+    completion of those variables, and all of them are included in the count.
+    </remarks>
+    */
+    ModelCount enumerate(const std::vector<int> &projection, unsigned long long limit,
+                         const std::function<bool(const std::vector<BoolValue> &)> &on_model);
+
     /**
     <summary>
     Gets the current assignment of variables.
     </summary>
-    <returns>A vector of BoolValue representing the current variable assignments.</returns>
+    <returns>A vector of BoolValue representing the current variable assignments, valid until the workspace is reused.</returns>
     */
     const std::vector<BoolValue> &getAssignment() const;
 
@@ -61,10 +112,61 @@ public:
     */
     unsigned long long getNumDecisions() const { return num_decisions; }
 
+    /**
+    <summary>
+    Gets the number of blocking clauses added during enumeration.
+    </summary>
+    <returns>The number of blocking clauses.</returns>
+    */
+    unsigned long long getNumBlockingClauses() const { return blocking_clauses.size(); }
+
+    /**
+    <summary>
+    Gets the depth of the decision stack the search resumed from.
+    </summary>
+    <returns>The number of decisions replayed from the snapshot, 0 if none was loaded.</returns>
+    */
+    size_t getResumedDepth() const { return resumed.decisions.size(); }
+
 private:
-    BooleanFormula &formula;
-    std::vector<BoolValue> current_assignment;
-    std::vector<int> variable_activity; // Activity of variables for decision order
+    const BooleanFormula &formula;
+    std::unique_ptr<SolverWorkspace> owned_workspace; // Only when the caller passed no workspace
+    SolverWorkspace &workspace;
+    std::vector<BoolValue> &current_assignment;
+    std::vector<int> &variable_activity; // Activity of variables for decision order
+    ClauseStore &clause_store;           // Formula and blocking clauses bucketed by width for evaluation
+    bool verbose = false;                // Print the model solve() finds
+
+    // Enumeration state
+    bool enumerating = false;
+    std::vector<int> projected_variables;
+    std::vector<Clause> blocking_clauses; // Kept apart from the formula so it stays untouched
+    ModelCount models_found;
+    unsigned long long model_limit = 0;
+    std::function<bool(const std::vector<BoolValue> &)> model_callback;
+
+    // Checkpoint state
+    std::unique_ptr<Checkpointer> checkpointer;
+    std::vector<SearchDecision> decisions; // Branches taken on the path to the current node
+    size_t unchanged_depth = 0;            // Decisions left untouched since the last snapshot
+    CheckpointState resumed;               // Loaded snapshot; its path is followed before deciding
+    size_t resume_depth = 0;
+
+    /**
+    <summary>
+    Hands the current decision stack and counters to the checkpointer.
+    </summary>
+    */
+    void saveCheckpoint();
+
+    /**
+    <summary>
+    Records the model at the current node: adds its blocking clause, updates the
+    count and notifies the callback.
+    </summary>
+    <returns>True if the enumeration should continue, otherwise false.</returns>
+    */
+    bool recordModel();
 
     /**
     <summary>
@@ -119,9 +221,58 @@ private:
     */
     bool isAllClausesSatisfied();
 
+    /**
+    <summary>
+    Builds the occurrence lists of the formula's literals and counts the TRUE
+    and FALSE literals of each clause under the current assignment.
+    </summary>
+    */
+    void initializeCounters();
+
+    /**
+    <summary>
+    Adds to the activity of every variable of a clause.
+    </summary>
+    <param name="clause">The index of the clause.</param>
+    <param name="delta">1 when the clause starts counting for decisions, -1 when it stops.</param>
+    */
+    void addClauseActivity(uint32_t clause, int delta);
+
+    /**
+    <summary>
+    Assigns a variable and updates the counters of the clauses it occurs in.
+    </summary>
+    <param name="variable">The 0-based variable.</param>
+    <param name="value">TRUE or FALSE.</param>
+    */
+    void assignVariable(int variable, BoolValue value);
+
+    /**
+    <summary>
+    Unassigns a variable and reverts the counters of the clauses it occurs in.
+    </summary>
+    <param name="variable">The 0-based variable.</param>
+    */
+    void unassignVariable(int variable);
+
+    /**
+    <summary>
+    Evaluates the formula and the blocking clauses under the current partial assignment.
+    </summary>
+    <returns>
+    TRUE if every clause is satisfied, FALSE if some clause has all of its literals
+    assigned false, otherwise UNASSIGNED.
+    </returns>
+    */
+    BoolValue evaluateClauses();
+
     unsigned long long num_backtracks = 0;
     unsigned long long num_unit_propagations = 0;
     unsigned long long num_decisions = 0;
+
+    // Maintained by assignVariable() and unassignVariable() once initializeCounters() has run
+    int num_satisfied_clauses = 0;
+    int num_falsified_clauses = 0;
 };
 
 #endif
@@ -0,0 +1,174 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "SolveReport.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <functional>
+
+/**
+<summary>
+Hands out the formulas of a batch to worker processes and collects their results.
+</summary>
+<remarks>
+Workers connect over FrameIO frames whose first byte gives the message type:
+  worker -> coordinator: 'H' name (hello), 'B' (heartbeat), 'R' unit_id rows (result)
+  coordinator -> worker: 'E' options (engine), 'T' unit_id formulas (task), 'Q' (quit)
+Every worker is sent the engine options as EngineOptions text when it connects,
+before its first task. A task carries the formulas themselves in the .cnf text
+format, so workers share nothing with the coordinator but the socket. A result holds one SolveReport row
+per formula of the task, separated by newlines. A worker that disconnects or
+misses heartbeats for longer than the timeout loses its task, which is queued
+again for the next idle worker. A task whose results keep failing to parse is
+given up after MAX_ATTEMPTS, and its formulas are left to the caller.
+</remarks>
+*/
+class BatchCoordinator
+{
+public:
+    static const int MAX_CUBE_DEPTH = 20; // Deepest split, 2^20 tasks per formula
+    static const int MAX_ATTEMPTS = 3;    // Malformed results a task may return before it is given up
+
+    /**
+    <summary>
+    Constructor for the BatchCoordinator class.
+    </summary>
+    <param name="address">The address to listen on, "unix:PATH" or "HOST:PORT".</param>
+    <param name="formulas">The formulas of the batch.</param>
+    <param name="chunk_size">The number of consecutive formulas handed out as one task.</param>
+    <param name="cube_depth">If positive, every formula is instead split into 2^cube_depth cubes, one task each.</param>
+    <param name="engine">The engine the workers solve with.</param>
+    */
+    BatchCoordinator(const std::string &address, const std::vector<BooleanFormula> &formulas, int chunk_size, int cube_depth,
+                     const EngineOptions &engine);
+
+    /**
+    <summary>
+    Destructor for the BatchCoordinator class. Closes all sockets.
+    </summary>
+    */
+    ~BatchCoordinator();
+
+    /**
+    <summary>
+    Starts listening, so that workers may be launched before run() is called.
+    </summary>
+    <remarks>
+    Throws std::runtime_error if the socket cannot be bound.
+    </remarks>
+    */
+    void listen();
+
+    /**
+    <summary>
+    Distributes the tasks until every formula has a result, then tells the workers to quit.
+    </summary>
+    <param name="on_result">Called once per formula with its index and merged report.</param>
+    <returns>True if every formula has a result, false if some were given up or no worker was connected for the connect timeout.</returns>
+    */
+    bool run(const std::function<void(int, const SolveReport &)> &on_result);
+
+    /**
+    <summary>
+    Sets how long a worker may stay silent before it is presumed dead.
+    </summary>
+    <param name="milliseconds">The heartbeat timeout.</param>
+    */
+    void setHeartbeatTimeout(int milliseconds) { heartbeat_timeout = std::chrono::milliseconds(milliseconds); }
+
+    /**
+    <summary>
+    Sets how long run() waits without any worker connected before giving up.
+    </summary>
+    <param name="milliseconds">The connect timeout.</param>
+    */
+    void setConnectTimeout(int milliseconds) { connect_timeout = std::chrono::milliseconds(milliseconds); }
+
+    /**
+    <summary>
+    Gets the number of tasks that were reassigned after their worker died.
+    </summary>
+    <returns>The number of reassigned tasks.</returns>
+    */
+    int getNumReassignments() const { return num_reassignments; }
+
+private:
+    // A task: a range of formulas, or one cube of a single formula
+    struct WorkUnit
+    {
+        int first_index;
+        int count;
+        std::vector<int> cube; // Signed literals fixed by the cube; empty for ranges
+        bool done = false;
+        int attempts = 0;      // Results that did not parse
+    };
+
+    struct Worker
+    {
+        int fd;
+        std::string name;
+        std::string buffer; // Bytes received but not yet forming a whole frame
+        int unit = -1;      // The task being solved, -1 when idle
+        std::chrono::steady_clock::time_point last_seen;
+        bool alive = true;
+    };
+
+    // Results of the cubes of one formula merged so far
+    struct CubeProgress
+    {
+        int remaining = 0;
+        bool reported = false;
+        SolveReport merged;
+    };
+
+    std::string address;
+    const std::vector<BooleanFormula> &formulas;
+    EngineOptions engine;
+    int listen_fd = -1;
+    std::vector<WorkUnit> units;
+    std::deque<int> pending;
+    std::vector<Worker> workers;
+    std::vector<CubeProgress> cubes;
+    std::chrono::milliseconds heartbeat_timeout;
+    std::chrono::milliseconds connect_timeout;
+    int formulas_reported = 0;
+    int formulas_abandoned = 0; // Counted in formulas_reported, but without a result
+    int num_reassignments = 0;
+
+    /**
+    <summary>
+    Builds the cubes of a formula over its most frequently occurring variables.
+    </summary>
+    <param name="index">The index of the formula.</param>
+    <param name="depth">The number of variables to split on.</param>
+    */
+    void addCubes(int index, int depth);
+
+    /**
+    <summary>
+    Serializes a task for sending to a worker.
+    </summary>
+    <param name="unit_id">The task to serialize.</param>
+    <returns>The task frame payload.</returns>
+    */
+    std::string taskPayload(int unit_id) const;
+
+    /**
+    <summary>
+    Handles one frame received from a worker.
+    </summary>
+    <param name="worker">The worker that sent the frame.</param>
+    <param name="payload">The frame payload.</param>
+    <param name="on_result">The result callback passed to run().</param>
+    */
+    void handleMessage(Worker &worker, const std::string &payload, const std::function<void(int, const SolveReport &)> &on_result);
+
+    /**
+    <summary>
+    Closes a worker's socket and queues its task again if it was not finished.
+    </summary>
+    <param name="worker">The worker to drop.</param>
+    */
+    void dropWorker(Worker &worker);
+};
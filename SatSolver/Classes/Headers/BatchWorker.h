@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <mutex>
+#include <condition_variable>
+
+/**
+<summary>
+A worker process of a distributed batch. Connects to a BatchCoordinator, solves
+the tasks it is handed with the engine options the coordinator sends, and sends
+back one SolveReport row per formula, while a background thread keeps sending
+heartbeats.
+</summary>
+*/
+class BatchWorker
+{
+public:
+    /**
+    <summary>
+    Constructor for the BatchWorker class.
+    </summary>
+    <param name="address">The coordinator address, "unix:PATH" or "HOST:PORT".</param>
+    */
+    BatchWorker(const std::string &address);
+
+    /**
+    <summary>
+    Connects to the coordinator and solves tasks until told to quit.
+    </summary>
+    <returns>True if the coordinator ended the session, false if it could not be reached or went away.</returns>
+    */
+    bool run();
+
+    /**
+    <summary>
+    Sets the interval between heartbeats.
+    </summary>
+    <param name="milliseconds">The heartbeat interval.</param>
+    */
+    void setHeartbeatInterval(int milliseconds) { heartbeat_interval_ms = milliseconds; }
+
+private:
+    std::string address;
+    int fd = -1;
+    int heartbeat_interval_ms = 1000;
+    std::mutex write_mtx; // Heartbeats and results share the socket
+    std::mutex stop_mtx;
+    std::condition_variable stop_cv;
+    bool stopping = false;
+
+    /**
+    <summary>
+    Sends a heartbeat frame every interval until the worker stops.
+    </summary>
+    */
+    void heartbeatLoop();
+
+    /**
+    <summary>
+    Sends a frame to the coordinator.
+    </summary>
+    <param name="payload">The frame payload.</param>
+    <returns>True if the frame was sent, otherwise false.</returns>
+    */
+    bool send(const std::string &payload);
+};
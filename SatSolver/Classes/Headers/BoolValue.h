@@ -1,7 +1,10 @@
 #pragma once
+#include <cstdint>
 
-// Boolean value with an additional UNASSIGNED state
-enum class BoolValue {
+// Boolean value with an additional UNASSIGNED state, stored in one byte so that an
+// assignment takes one byte per variable. TRUE and FALSE are 0 and 1, the sign bit
+// of a Literal, which lets Literal::evaluate() work without branches.
+enum class BoolValue : uint8_t {
     TRUE,
     FALSE,
     UNASSIGNED
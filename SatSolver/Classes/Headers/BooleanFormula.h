@@ -1,6 +1,11 @@
 #pragma once
 #include "Clause.h"
 #include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
 
 class BooleanFormula
 {
@@ -13,6 +18,15 @@ public:
     */
     void addClause(const Clause &clause);
 
+    /**
+    <summary>
+    Adds a weighted clause, making the formula a weighted one.
+    </summary>
+    <param name="clause">The clause to be added.</param>
+    <param name="weight">The cost of leaving the clause unsatisfied.</param>
+    */
+    void addWeightedClause(const Clause &clause, unsigned long long weight);
+
     /**
     <summary>
     Evaluates the formula with the given variable assignments.
@@ -24,13 +38,56 @@ public:
 
     /**
     <summary>
-    Loads a collection of Boolean formulas from a file.
+    Loads a collection of Boolean formulas from a file, which may be compressed
+    with gzip, xz or zstd.
     </summary>
     <param name="filename">The name of the file to be read.</param>
     <returns>A vector of Boolean formulas read from the file.</returns>
     */
     std::vector<BooleanFormula> loadFromFile(const std::string &filename);
 
+    /**
+    <summary>
+    Loads a collection of Boolean formulas from an input stream.
+    </summary>
+    <param name="input">The stream to be read.</param>
+    <param name="verbose">Whether every line, clause and literal read is echoed to the console.</param>
+    <returns>A vector of Boolean formulas read from the stream.</returns>
+    */
+    static std::vector<BooleanFormula> loadFromStream(std::istream &input, bool verbose = false);
+
+    /**
+    <summary>
+    Builds a formula from a flat buffer of signed variable numbers.
+    </summary>
+    <param name="literals">The literals, each clause terminated by a zero.</param>
+    <param name="count">The number of entries in the buffer.</param>
+    <returns>The formula described by the buffer.</returns>
+    */
+    static BooleanFormula fromLiterals(const int32_t *literals, size_t count);
+
+    /**
+    <summary>
+    Writes the formula in the comma-separated .cnf format read by loadFromStream.
+    </summary>
+    <param name="output">The stream to write to.</param>
+    <param name="number">The formula number written on the 'c' line.</param>
+    */
+    void writeToStream(std::ostream &output, int number) const;
+
+    /**
+    <summary>
+    Writes the formula in standard DIMACS, which loadFromStream also reads.
+    </summary>
+    <param name="output">The stream to write to.</param>
+    <param name="number">The formula number written on the 'c' line.</param>
+    <remarks>
+    The 'c' line keeps the number, variable count and answer, space-separated,
+    so the file round-trips; other DIMACS tools treat it as a comment.
+    </remarks>
+    */
+    void writeDimacs(std::ostream &output, int number) const;
+
     /**
     <summary>
     Retrieves the number of variables in the formula.
@@ -106,7 +163,42 @@ public:
     */
     int getClauseCount() const { return clauses.size(); };
 
+    /**
+    <summary>
+    Tells whether the formula was read from a "p wcnf" problem and has clause weights.
+    </summary>
+    <returns>True if the formula is weighted.</returns>
+    */
+    bool isWeighted() const { return weighted; }
+
+    /**
+    <summary>
+    Gets the clause weights of a weighted formula.
+    </summary>
+    <returns>One weight per clause, empty if the formula is not weighted.</returns>
+    */
+    const std::vector<unsigned long long> &getWeights() const { return weights; }
+
+    /**
+    <summary>
+    Gets the weight from which clauses are hard.
+    </summary>
+    <returns>The "top" weight of the problem line, 0 if every clause is soft.</returns>
+    */
+    unsigned long long getHardWeight() const { return hard_weight; }
+
+    /**
+    <summary>
+    Sets the weight from which clauses are hard.
+    </summary>
+    <param name="weight">The "top" weight, 0 if every clause is soft.</param>
+    */
+    void setHardWeight(unsigned long long weight) { hard_weight = weight; }
+
 private:
     std::vector<Clause> clauses;
-    char answer;
+    char answer = '?';
+    bool weighted = false;
+    std::vector<unsigned long long> weights; // Parallel to clauses when weighted
+    unsigned long long hard_weight = 0;
 };
@@ -0,0 +1,698 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include "ClauseExchange.h"
+#include <vector>
+#include <atomic>
+#include <unordered_set>
+#include <cstdint>
+
+/**
+<summary>
+A conflict-driven clause learning solver: two watched literals, first-UIP
+learning with clause minimization, VSIDS decisions with phase saving, Luby
+restarts and LBD-based cleaning of the learned clauses.
+</summary>
+<remarks>
+Clauses are stored by width. Binary clauses live only in implication lists,
+ternary clauses in inline three-literal records, and longer clauses in the
+general store; the watch visit is a template instantiated for the ternary
+width and for the general case. Learned ternary and long clauses are cleaned
+together; learned binary clauses are kept for good.
+</remarks>
+<remarks>
+Literals are DIMACS integers at the interface. The solver is incremental:
+clauses may be added between calls to solveLimited(), which also accepts
+assumptions and stops early on a conflict budget or an interrupt. A solve
+stopped by its budget keeps its trail and its place in the restart schedule,
+so a following solve under the same assumptions continues the same search
+rather than restarting it. Solvers
+working on the same variables can share short learned clauses through a
+ClauseExchange; imports happen at restarts, when the solver is at level 0.
+</remarks>
+<remarks>
+Every so many conflicts a restart also inprocesses the clauses: those satisfied
+at level 0 are removed and falsified literals stripped, newly learned clauses
+are checked for subsumption, and clauses are vivified by propagating the
+negations of their literals. A budget in propagations and literal visits keeps
+inprocessing to a bounded share of the search.
+</remarks>
+*/
+class CdclSolver
+{
+public:
+    /**
+    <summary>
+    Constructor for an empty CdclSolver.
+    </summary>
+    */
+    CdclSolver() = default;
+
+    /**
+    <summary>
+    Constructor for the CdclSolver class.
+    </summary>
+    <param name="formula">The Boolean formula to be solved; its clauses are copied.</param>
+    */
+    explicit CdclSolver(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Adds a fresh variable.
+    </summary>
+    <returns>The 1-based number of the new variable.</returns>
+    */
+    int newVariable();
+
+    /**
+    <summary>
+    Adds a clause, creating any variables it mentions. Must be called between solves.
+    </summary>
+    <param name="literals">The DIMACS literals of the clause; zeros are ignored.</param>
+    <returns>False if the clauses are now known to be unsatisfiable, otherwise true.</returns>
+    */
+    bool addClause(const std::vector<int> &literals);
+
+    /**
+    <summary>
+    Adds a clause read straight from a caller's buffer. Must be called between solves.
+    </summary>
+    <param name="literals">The DIMACS literals of the clause; zeros are ignored.</param>
+    <param name="count">The number of literals.</param>
+    <returns>False if the clauses are now known to be unsatisfiable, otherwise true.</returns>
+    */
+    bool addClause(const int32_t *literals, size_t count);
+
+    /**
+    <summary>
+    Attempts to solve the formula.
+    </summary>
+    <returns>True if a solution is found, otherwise false.</returns>
+    */
+    bool solve();
+
+    /**
+    <summary>
+    Solves under assumptions, within the conflict budget and until interrupted.
+    </summary>
+    <param name="assumptions">DIMACS literals assumed true for this call only.</param>
+    <returns>
+    TRUE if satisfiable, FALSE if unsatisfiable under the assumptions, UNASSIGNED
+    if the budget ran out or the solver was interrupted.
+    </returns>
+    */
+    BoolValue solveLimited(const std::vector<int> &assumptions = std::vector<int>());
+
+    /**
+    <summary>
+    Gets the model found by the last satisfiable solve.
+    </summary>
+    <returns>One BoolValue per variable, empty if the last solve found no model.</returns>
+    */
+    const std::vector<BoolValue> &getAssignment() const { return model; }
+
+    /**
+    <summary>
+    Gets the assumptions responsible for the last unsatisfiable solve.
+    </summary>
+    <returns>A subset of the assumptions that cannot all hold; empty if the clauses alone are unsatisfiable.</returns>
+    */
+    const std::vector<int> &getFailedAssumptions() const { return failed_assumptions; }
+
+    /**
+    <summary>
+    Limits the number of conflicts of each following solve.
+    </summary>
+    <param name="conflicts">The conflicts allowed per solve; negative means no limit.</param>
+    */
+    void setConflictBudget(long long conflicts) { conflict_budget = conflicts; }
+
+    /**
+    <summary>
+    Asks a running solve to stop as soon as possible; safe to call from any thread.
+    </summary>
+    */
+    void interrupt() { interrupted.store(true, std::memory_order_relaxed); }
+
+    /**
+    <summary>
+    Clears an earlier interrupt so the solver can be used again.
+    </summary>
+    */
+    void clearInterrupt() { interrupted.store(false, std::memory_order_relaxed); }
+
+    /**
+    <summary>
+    Seeds the generator behind random decisions.
+    </summary>
+    <param name="seed">The seed; zero is replaced by a fixed non-zero value.</param>
+    */
+    void setSeed(uint64_t seed) { random_state = seed != 0 ? seed : 0x2545f4914f6cdd1dull; }
+
+    /**
+    <summary>
+    Sets how often a decision picks a random variable instead of the most active one.
+    </summary>
+    <param name="frequency">The probability of a random decision.</param>
+    */
+    void setRandomDecisionFrequency(double frequency) { random_decision_frequency = frequency; }
+
+    /**
+    <summary>
+    Sets the polarity tried first for variables that were never assigned.
+    </summary>
+    <param name="positive">True to try TRUE first, false to try FALSE first.</param>
+    */
+    void setDefaultPhase(bool positive);
+
+    /**
+    <summary>
+    Sets the number of conflicts the Luby restart sequence is scaled by.
+    </summary>
+    <param name="conflicts">The restart unit.</param>
+    */
+    void setRestartInterval(int conflicts) { restart_interval = conflicts > 0 ? conflicts : 1; }
+
+    /**
+    <summary>
+    Sets the conflicts before the first inprocessing; the gaps then grow by half each time.
+    </summary>
+    <param name="conflicts">The conflicts; 0 disables inprocessing.</param>
+    */
+    void setInprocessInterval(int conflicts)
+    {
+        inprocess_gap = conflicts > 0 ? conflicts : 0;
+        next_inprocess = num_conflicts + conflicts;
+    }
+
+    /**
+    <summary>
+    Connects the solver to an exchange shared with solvers of the same formula.
+    </summary>
+    <param name="exchange">The exchange, or nullptr to stop sharing.</param>
+    <param name="worker_id">The id of this solver among the sharers.</param>
+    */
+    void setClauseExchange(ClauseExchange *exchange, int worker_id);
+
+    /**
+    <summary>
+    Collects the learned clauses worth sharing in a buffer, for a caller that
+    hands them to other solvers at points of its choosing, instead of an exchange.
+    </summary>
+    <param name="outbox">The buffer clauses are appended to, in internal encoding, or nullptr to stop collecting.</param>
+    <param name="max_size">Clauses longer than this are not collected.</param>
+    <param name="max_lbd">Clauses with a larger LBD are not collected.</param>
+    */
+    void setClauseOutbox(std::vector<std::vector<int>> *outbox, int max_size = 8, int max_lbd = 4);
+
+    /**
+    <summary>
+    Adds clauses collected from other solvers' outboxes, in order. Must be called between solves.
+    </summary>
+    <param name="shared">The clauses, in internal encoding; this solver's own are recognized and skipped.</param>
+    <returns>False if the clauses are now known to be unsatisfiable, otherwise true.</returns>
+    <remarks>After a solve stopped by its budget, the clauses wait for the next restart.</remarks>
+    */
+    bool importSharedClauses(const std::vector<std::vector<int>> &shared);
+
+    /**
+    <summary>
+    Gets the number of variables.
+    </summary>
+    <returns>The number of variables.</returns>
+    */
+    int getVariableCount() const { return num_vars; }
+
+    /**
+    <summary>
+    Gets the number of decisions made during solving.
+    </summary>
+    <returns>The number of decisions.</returns>
+    */
+    unsigned long long getNumDecisions() const { return num_decisions; }
+
+    /**
+    <summary>
+    Gets the number of conflicts met during solving.
+    </summary>
+    <returns>The number of conflicts.</returns>
+    */
+    unsigned long long getNumConflicts() const { return num_conflicts; }
+
+    /**
+    <summary>
+    Gets the number of literals propagated during solving.
+    </summary>
+    <returns>The number of propagations.</returns>
+    */
+    unsigned long long getNumPropagations() const { return num_propagations; }
+
+    /**
+    <summary>
+    Gets the number of restarts performed during solving.
+    </summary>
+    <returns>The number of restarts.</returns>
+    */
+    unsigned long long getNumRestarts() const { return num_restarts; }
+
+    /**
+    <summary>
+    Gets the number of learned clauses currently kept.
+    </summary>
+    <returns>The number of learned clauses.</returns>
+    */
+    unsigned long long getNumLearnedClauses() const { return num_learned; }
+
+    /**
+    <summary>
+    Gets the number of learned clauses published to the exchange.
+    </summary>
+    <returns>The number of exported clauses.</returns>
+    */
+    unsigned long long getNumExportedClauses() const { return num_exported; }
+
+    /**
+    <summary>
+    Gets the number of clauses taken from the exchange.
+    </summary>
+    <returns>The number of imported clauses.</returns>
+    */
+    unsigned long long getNumImportedClauses() const { return num_imported; }
+
+    /**
+    <summary>
+    Gets the number of inprocessing passes.
+    </summary>
+    <returns>The number of passes.</returns>
+    */
+    unsigned long long getNumInprocessings() const { return num_inprocessings; }
+
+    /**
+    <summary>
+    Gets the number of clauses vivification shortened.
+    </summary>
+    <returns>The number of vivified clauses.</returns>
+    */
+    unsigned long long getNumVivifiedClauses() const { return num_vivified; }
+
+    /**
+    <summary>
+    Gets the number of clauses removed because a newly learned clause subsumed them, or a binary clause subsumed a new one.
+    </summary>
+    <returns>The number of subsumed clauses.</returns>
+    */
+    unsigned long long getNumSubsumedClauses() const { return num_subsumed; }
+
+    /**
+    <summary>
+    Gets the number of clauses removed because they were satisfied at level 0.
+    </summary>
+    <returns>The number of satisfied clauses removed.</returns>
+    */
+    unsigned long long getNumSatisfiedClausesRemoved() const { return num_satisfied_removed; }
+
+private:
+    struct ClauseRecord
+    {
+        std::vector<int> literals; // Internal literals; the first two are watched
+        bool learned = false;
+        bool deleted = false;
+        bool vivified = false; // Tried once by vivification
+        int lbd = 0;
+        double activity = 0;
+    };
+
+    struct TernaryClause
+    {
+        int literals[3];
+        float activity;
+        uint8_t lbd;
+        bool learned;
+        bool deleted;
+    };
+
+    struct Watcher
+    {
+        int clause;  // Reference to a ternary or long clause
+        int blocker; // Another literal of the clause; when TRUE the clause is skipped
+    };
+
+    // A clause reference is the index in its store shifted left by two, tagged
+    // with the width class. A binary reference holds the falsified partner
+    // literal instead of an index, since binary clauses are not stored.
+    enum ClauseKind
+    {
+        LONG_CLAUSE = 0,
+        TERNARY_CLAUSE = 1,
+        BINARY_CLAUSE = 2
+    };
+
+    // Outcomes of visiting one watcher.
+    enum WatchResult
+    {
+        WATCH_KEPT,
+        WATCH_MOVED,
+        WATCH_UNIT,
+        WATCH_CONFLICT
+    };
+
+    // Internal literals are 2 * (variable - 1) plus 1 when negative.
+    int num_vars = 0;
+    bool consistent = true; // False once the clauses are unsatisfiable at level 0
+    std::vector<int> added; // Scratch for the clause being added
+    std::vector<ClauseRecord> clauses;
+    std::vector<int> free_clauses; // Slots of deleted clauses for reuse
+    std::vector<TernaryClause> ternaries;
+    std::vector<int> free_ternaries; // Slots of deleted ternary clauses for reuse
+    std::vector<std::vector<int>> implications; // Binary partners of each literal, implied when it turns FALSE
+    std::vector<std::vector<Watcher>> watches;  // Indexed by the watched literal
+    int conflict_literal = -1;                  // Falsified literal of a binary conflict
+    int binary_literals[2];                     // Scratch view of a binary clause
+    std::vector<signed char> assigns;           // 1 TRUE, -1 FALSE, 0 unassigned
+    std::vector<int> level;
+    std::vector<int> reason; // Reference to the clause that implied the variable, -1 for decisions
+    std::vector<int> trail;
+    std::vector<int> trail_limits; // Trail size at the start of each decision level
+    size_t propagate_head = 0;
+    std::vector<BoolValue> model;
+    std::vector<int> failed_assumptions;
+    std::vector<int> assumptions; // Internal literals of the current solve
+
+    // Decision heuristic
+    std::vector<double> activity;
+    std::vector<signed char> saved_phase;
+    std::vector<int> heap;       // Binary max-heap of variables by activity
+    std::vector<int> heap_index; // Position in the heap, -1 when absent
+    double var_increment = 1;
+    double clause_increment = 1;
+    double random_decision_frequency = 0;
+    uint64_t random_state = 0x2545f4914f6cdd1dull;
+    signed char default_phase = -1;
+    int restart_interval = 100;
+
+    // Conflict analysis scratch space
+    std::vector<char> seen;
+    std::vector<int> analyze_stack;
+    std::vector<int> analyze_clear;
+    std::vector<uint64_t> level_stamp;
+    uint64_t stamp = 0;
+
+    // Learned clause database
+    unsigned long long num_learned = 0;
+    unsigned long long num_reducible = 0; // Learned ternary and long clauses, the only ones ever deleted
+    double max_learned = 0;
+
+    // Budget and interruption
+    long long conflict_budget = -1;
+    unsigned long long conflict_limit = 0;
+    int restart_position = 0; // Luby index a solve stopped by the budget resumes from
+    int segment_conflicts = 0; // Conflicts already spent in that Luby segment
+    bool stopped_early = false;
+    std::atomic<bool> interrupted{false};
+
+    // Clause sharing
+    ClauseExchange *exchange = nullptr;
+    int worker_id = 0;
+    uint64_t exchange_cursor = 0;
+    std::unordered_set<uint64_t> shared_hashes; // Clauses already exported or imported
+    std::vector<std::vector<int>> incoming; // Clauses to import at the next restart
+    std::vector<std::vector<int>> *outbox = nullptr;
+    int outbox_max_size = 0;
+    int outbox_max_lbd = 0;
+
+    unsigned long long num_decisions = 0;
+    unsigned long long num_conflicts = 0;
+    unsigned long long num_propagations = 0;
+    unsigned long long num_restarts = 0;
+    unsigned long long num_exported = 0;
+    unsigned long long num_imported = 0;
+
+    // Inprocessing
+    double inprocess_gap = 2000;             // Conflicts until the next pass after this one; 0 disables
+    unsigned long long next_inprocess = 2000;
+    unsigned long long inprocess_propagations = 0; // Propagations when the last pass ended
+    size_t root_cleaned = 0;                 // Level-0 trail entries whose clauses were cleaned up
+    std::vector<int> recent_learned;         // Long learned clauses since the last pass
+    std::vector<int> pending_free;           // Deleted long clauses still watched
+    std::vector<int> pending_free_ternaries; // Deleted ternary clauses still watched
+    std::vector<char> literal_marks;
+    std::vector<std::vector<int>> occurrences; // Long clauses of each literal, during subsumption
+    unsigned long long num_inprocessings = 0;
+    unsigned long long num_vivified = 0;
+    unsigned long long num_subsumed = 0;
+    unsigned long long num_satisfied_removed = 0;
+
+    /**
+    <summary>
+    Gets the value of an internal literal.
+    </summary>
+    <param name="lit">The literal.</param>
+    <returns>1 if TRUE, -1 if FALSE, 0 if unassigned.</returns>
+    */
+    int value(int lit) const { return (lit & 1) ? -assigns[lit >> 1] : assigns[lit >> 1]; }
+
+    /**
+    <summary>
+    Gets the current decision level.
+    </summary>
+    <returns>The number of open decision levels.</returns>
+    */
+    int decisionLevel() const { return static_cast<int>(trail_limits.size()); }
+
+    /**
+    <summary>
+    Stores a clause of at least two literals in the store of its width.
+    </summary>
+    <param name="literals">The internal literals.</param>
+    <param name="learned">Whether the clause was learned.</param>
+    <param name="lbd">The literal block distance of a learned clause.</param>
+    <returns>The reference of the clause, usable as the reason of its first literal.</returns>
+    */
+    int attachClause(const std::vector<int> &literals, bool learned, int lbd);
+
+    /**
+    <summary>
+    Assigns a literal TRUE at the current decision level.
+    </summary>
+    <param name="lit">The literal to assign.</param>
+    <param name="from">The implying clause, or -1 for a decision.</param>
+    */
+    void assign(int lit, int from);
+
+    /**
+    <summary>
+    Undoes every assignment above a decision level, saving the phases.
+    </summary>
+    <param name="target">The decision level to return to.</param>
+    <param name="save_phases">Whether the undone values become the saved phases.</param>
+    */
+    void cancelUntil(int target, bool save_phases = true);
+
+    /**
+    <summary>
+    Propagates the assignments on the trail through the implication lists and watched literals.
+    </summary>
+    <returns>The reference of a falsified clause, or -1 if there is no conflict.</returns>
+    */
+    int propagate();
+
+    /**
+    <summary>
+    Visits one watcher of a falsified literal.
+    </summary>
+    <param name="literals">The clause literals.</param>
+    <param name="size">The number of literals, used only when Width is 0.</param>
+    <param name="false_lit">The falsified literal.</param>
+    <param name="watcher">The watcher; its blocker is updated when the watcher stays.</param>
+    <returns>The outcome; on WATCH_UNIT the blocker is the implied literal.</returns>
+    */
+    template <int Width>
+    WatchResult visitWatch(int *literals, int size, int false_lit, Watcher &watcher);
+
+    /**
+    <summary>
+    Gets the literals of a referenced clause.
+    </summary>
+    <param name="ref">The clause reference.</param>
+    <param name="first">For a binary clause, the literal to put first.</param>
+    <param name="size">Receives the number of literals.</param>
+    <returns>The literals; the view of a binary clause is valid until the next call.</returns>
+    */
+    const int *literalsOf(int ref, int first, int &size);
+
+    /**
+    <summary>
+    Derives the first-UIP clause of a conflict and minimizes it.
+    </summary>
+    <param name="conflict">The reference of the falsified clause.</param>
+    <param name="learned">Receives the clause, asserting literal first.</param>
+    <param name="backtrack_level">Receives the level to backjump to.</param>
+    <param name="lbd">Receives the literal block distance of the clause.</param>
+    */
+    void analyze(int conflict, std::vector<int> &learned, int &backtrack_level, int &lbd);
+
+    /**
+    <summary>
+    Checks whether a literal of a learned clause is implied by the others.
+    </summary>
+    <param name="lit">The literal to check.</param>
+    <param name="levels">Bit set of the levels in the learned clause.</param>
+    <returns>True if the literal can be removed.</returns>
+    */
+    bool isRedundant(int lit, uint32_t levels);
+
+    /**
+    <summary>
+    Collects the assumptions that imply the negation of a failed assumption.
+    </summary>
+    <param name="lit">The assumption found FALSE.</param>
+    */
+    void analyzeFinal(int lit);
+
+    /**
+    <summary>
+    Searches until a model, a refutation, the restart limit or the end of the budget.
+    </summary>
+    <param name="max_conflicts">The conflicts of the current Luby segment, counting those of earlier calls.</param>
+    <returns>TRUE, FALSE, or UNASSIGNED to restart or when the budget runs out.</returns>
+    */
+    BoolValue search(int max_conflicts);
+
+    /**
+    <summary>
+    Picks the next decision literal.
+    </summary>
+    <returns>The literal, or -1 if every variable is assigned.</returns>
+    */
+    int pickBranchLiteral();
+
+    /**
+    <summary>
+    Deletes the less useful half of the learned clauses.
+    </summary>
+    */
+    void reduceLearned();
+
+    /**
+    <summary>
+    Runs one inprocessing pass. Called at level 0.
+    </summary>
+    <returns>False if the clauses were found unsatisfiable, otherwise true.</returns>
+    */
+    bool inprocess();
+
+    /**
+    <summary>
+    Removes the clauses satisfied by the level-0 assignments and strips their falsified literals from the rest.
+    </summary>
+    */
+    void removeSatisfied();
+
+    /**
+    <summary>
+    Removes the clauses a newly learned clause subsumes, and new clauses a binary clause subsumes.
+    </summary>
+    <param name="ticks">The work done so far, in literal visits; increased.</param>
+    <param name="budget">The work allowed.</param>
+    */
+    void subsumeLearned(unsigned long long &ticks, unsigned long long budget);
+
+    /**
+    <summary>
+    Shortens clauses by assigning the negations of their literals in turn:
+    literals found FALSE are dropped, and a conflict or a literal found TRUE ends the clause there.
+    </summary>
+    <param name="ticks">The work done so far, in literal visits; increased by the propagations.</param>
+    <param name="budget">The work allowed.</param>
+    <returns>False if a shortened unit clause is falsified, otherwise true.</returns>
+    */
+    bool vivify(unsigned long long &ticks, unsigned long long budget);
+
+    /**
+    <summary>
+    Marks a long clause deleted; its watchers go at the end of the pass.
+    </summary>
+    <param name="index">The index of the clause in the store.</param>
+    */
+    void deleteClause(int index);
+
+    /**
+    <summary>
+    Marks a ternary clause deleted; its watchers go at the end of the pass.
+    </summary>
+    <param name="index">The index of the clause in the ternary store.</param>
+    */
+    void deleteTernary(int index);
+
+    /**
+    <summary>
+    Drops the watchers of deleted clauses and frees their slots.
+    </summary>
+    */
+    void collectDeleted();
+
+    /**
+    <summary>
+    Publishes a learned clause to the exchange if it passes the filters.
+    </summary>
+    <param name="learned">The clause.</param>
+    <param name="lbd">Its literal block distance.</param>
+    */
+    void exportClause(const std::vector<int> &learned, int lbd);
+
+    /**
+    <summary>
+    Adds the clauses other solvers published since the last import, and those
+    importSharedClauses() held back. Called at level 0.
+    </summary>
+    <returns>-1 if an imported clause is falsified, 1 if units were assigned, otherwise 0.</returns>
+    */
+    int importClauses();
+
+    /**
+    <summary>
+    Adds one clause learned by another solver. Called at level 0.
+    </summary>
+    <param name="clause">The clause in internal encoding; simplified in place.</param>
+    <returns>-1 if it is falsified, 1 if it assigned a unit, otherwise 0.</returns>
+    */
+    int importClause(std::vector<int> &clause);
+
+    /**
+    <summary>
+    Checks whether the solve must stop on the budget or an interrupt.
+    </summary>
+    <returns>True if the solve may continue.</returns>
+    */
+    bool withinBudget() const;
+
+    /**
+    <summary>
+    Raises the activity of a variable met in a conflict.
+    </summary>
+    <param name="var">The 0-based variable.</param>
+    */
+    void bumpVariable(int var);
+
+    /**
+    <summary>
+    Raises the activity of a learned clause used in a conflict.
+    </summary>
+    <param name="ref">The reference of a ternary or long clause.</param>
+    */
+    void bumpClause(int ref);
+
+    /**
+    <summary>
+    Draws from the xorshift generator behind random decisions.
+    </summary>
+    <returns>A number in [0, 1).</returns>
+    */
+    double nextRandom();
+
+    // Activity heap operations; variables are 0-based.
+    void heapInsert(int var);
+    int heapRemoveMax();
+    void heapUp(int position);
+    void heapDown(int position);
+};
@@ -0,0 +1,165 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// A branch taken by the search: the 0-based variable and the value it was given.
+struct SearchDecision
+{
+    int variable;
+    BoolValue value;
+};
+
+// The resumable state of a search: the path to the node being explored and the counters so far.
+struct CheckpointState
+{
+    std::vector<SearchDecision> decisions;
+    unsigned long long num_decisions = 0;
+    unsigned long long num_backtracks = 0;
+    unsigned long long num_unit_propagations = 0;
+};
+
+/**
+<summary>
+Writes snapshots of a running search to a file so that it can be resumed after
+the process is killed. The search thread hands over only the part of its
+decision stack that changed since the previous snapshot; a background thread
+appends it to the file as a checksummed journal record and rewrites the file
+compactly once the journal has grown well past the size of the stack.
+</summary>
+<remarks>
+File layout, in host byte order: an 8-byte magic, the formula hash, then
+records of [length, checksum, kept depth, counters, decisions], where a
+decision is a signed 1-based variable. A record cut short by a kill fails its
+checksum and is ignored, so the file always resumes from the last complete one.
+</remarks>
+*/
+class Checkpointer
+{
+public:
+    /**
+    <summary>
+    Constructor for the Checkpointer class. Writes the initial state to the file
+    and starts the writer thread.
+    </summary>
+    <param name="path">The snapshot file.</param>
+    <param name="formula_hash">The hash of the formula being solved, from hashFormula().</param>
+    <param name="interval">The minimum time between two snapshots.</param>
+    <param name="initial">The state the search starts from, such as a loaded snapshot.</param>
+    */
+    Checkpointer(const std::string &path, uint64_t formula_hash, std::chrono::milliseconds interval, const CheckpointState &initial);
+
+    /**
+    <summary>
+    Destructor for the Checkpointer class. Writes the pending snapshot and joins the writer.
+    </summary>
+    */
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer &) = delete;
+    Checkpointer &operator=(const Checkpointer &) = delete;
+
+    /**
+    <summary>
+    Tells whether a snapshot should be taken now. Cheap enough to call at every
+    decision: the clock is only read once every few hundred calls.
+    </summary>
+    <returns>True if the interval has elapsed since the last snapshot.</returns>
+    */
+    bool due()
+    {
+        return (++calls & 255) == 0 && std::chrono::steady_clock::now() >= next_due;
+    }
+
+    /**
+    <summary>
+    Hands a snapshot to the writer thread without waiting for it to be written.
+    If the previous snapshot is still pending, the two are merged.
+    </summary>
+    <param name="kept_depth">The number of leading decisions unchanged since the previous snapshot.</param>
+    <param name="decisions">The full decision stack of the search.</param>
+    <param name="state">The counters of the search; its decisions are ignored.</param>
+    */
+    void submit(size_t kept_depth, const std::vector<SearchDecision> &decisions, const CheckpointState &state);
+
+    /**
+    <summary>
+    Stops taking snapshots and deletes the file, for a search that ran to completion.
+    </summary>
+    */
+    void discard();
+
+    /**
+    <summary>
+    Loads the last complete snapshot from a file.
+    </summary>
+    <param name="path">The snapshot file.</param>
+    <param name="formula_hash">The hash of the formula about to be solved.</param>
+    <param name="state">Receives the snapshot.</param>
+    <returns>True if the file exists, was written for the same formula and holds a snapshot.</returns>
+    */
+    static bool load(const std::string &path, uint64_t formula_hash, CheckpointState &state);
+
+    /**
+    <summary>
+    Hashes the variable count and clauses of a formula, so that a snapshot is
+    never resumed against a different formula.
+    </summary>
+    <param name="formula">The formula.</param>
+    <returns>The hash.</returns>
+    */
+    static uint64_t hashFormula(const BooleanFormula &formula);
+
+private:
+    std::string path;
+    uint64_t formula_hash;
+    std::chrono::milliseconds interval;
+    std::chrono::steady_clock::time_point next_due;
+    unsigned int calls = 0;
+
+    // Handed over by the search thread
+    std::mutex mtx;
+    std::condition_variable wake;
+    bool has_pending = false;
+    bool stopping = false;
+    size_t pending_kept = 0;
+    std::vector<SearchDecision> pending_suffix;
+    CheckpointState pending_counters;
+
+    // Owned by the writer thread
+    int fd = -1;
+    std::vector<SearchDecision> stack; // The decision stack as of the last record written
+    size_t journal_bytes = 0;
+    std::thread writer;
+
+    /**
+    <summary>
+    Writes pending snapshots until the checkpointer is stopped.
+    </summary>
+    */
+    void writerLoop();
+
+    /**
+    <summary>
+    Appends one record to the journal, or rewrites the whole file if the journal has grown too long.
+    </summary>
+    <param name="kept">The number of leading decisions kept from the previous record.</param>
+    <param name="suffix">The decisions after the kept ones.</param>
+    <param name="counters">The counters of the search.</param>
+    */
+    void writeRecord(size_t kept, const std::vector<SearchDecision> &suffix, const CheckpointState &counters);
+
+    /**
+    <summary>
+    Replaces the file with one holding a single record of the full stack.
+    </summary>
+    <param name="counters">The counters of the search.</param>
+    */
+    void rewrite(const CheckpointState &counters);
+};
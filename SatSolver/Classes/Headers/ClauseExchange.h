@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+<summary>
+Lock-free multi-producer, multi-consumer broadcast ring of short learned clauses
+shared between solver threads working on the same variables.
+</summary>
+<remarks>
+Producers claim a position with one fetch_add and publish the slot with a
+sequence number; readers keep a private cursor and validate every slot they read
+against its sequence number, seqlock style. A reader that falls more than the
+capacity behind skips the overwritten clauses, and a producer that finds its
+slot still being written by a lapped producer drops its clause. Both losses are
+acceptable because sharing is only a heuristic.
+</remarks>
+*/
+class ClauseExchange
+{
+public:
+    // Longest clause the exchange can carry; longer clauses are never shared.
+    static const int MAX_SHARED_SIZE = 16;
+
+    /**
+    <summary>
+    Constructor for the ClauseExchange class.
+    </summary>
+    <param name="capacity">The number of slots, rounded up to a power of two.</param>
+    <param name="max_size">Clauses longer than this are not exported.</param>
+    <param name="max_lbd">Clauses with a larger LBD are not exported.</param>
+    */
+    ClauseExchange(size_t capacity = 4096, int max_size = 8, int max_lbd = 4);
+
+    /**
+    <summary>
+    Checks whether a learned clause passes the size and LBD filters.
+    </summary>
+    <param name="size">The number of literals.</param>
+    <param name="lbd">The literal block distance.</param>
+    <returns>True if the clause should be exported.</returns>
+    */
+    bool accepts(int size, int lbd) const { return size <= max_size && lbd <= max_lbd; }
+
+    /**
+    <summary>
+    Publishes a clause for the other workers.
+    </summary>
+    <param name="source">The id of the publishing worker.</param>
+    <param name="literals">The clause literals in the solvers' internal encoding.</param>
+    <param name="size">The number of literals.</param>
+    <param name="lbd">The literal block distance.</param>
+    <returns>True if the clause was published, false if it was filtered or dropped.</returns>
+    */
+    bool publish(int source, const int *literals, int size, int lbd);
+
+    /**
+    <summary>
+    Reads every clause published by other workers since the reader's cursor.
+    </summary>
+    <param name="reader">The id of the reading worker, whose own clauses are skipped.</param>
+    <param name="cursor">The reader's position; advanced past everything read.</param>
+    <param name="clauses">Receives the clauses read.</param>
+    */
+    void collect(int reader, uint64_t &cursor, std::vector<std::vector<int>> &clauses) const;
+
+    /**
+    <summary>
+    Gets the position the next clause will be published at, to start a reader's cursor.
+    </summary>
+    <returns>The current head position.</returns>
+    */
+    uint64_t head() const { return next_position.load(std::memory_order_acquire); }
+
+    /**
+    <summary>
+    Hashes a clause independently of the order of its literals.
+    </summary>
+    <param name="literals">The clause literals.</param>
+    <param name="size">The number of literals.</param>
+    <returns>The clause hash.</returns>
+    */
+    static uint64_t hashClause(const int *literals, int size);
+
+private:
+    struct Slot
+    {
+        // 2 * position + 1 while being written, 2 * position + 2 once published
+        std::atomic<uint64_t> sequence;
+        std::atomic<int> source;
+        std::atomic<int> size;
+        std::atomic<int> literals[MAX_SHARED_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    int max_size;
+    int max_lbd;
+    std::atomic<uint64_t> next_position;
+};
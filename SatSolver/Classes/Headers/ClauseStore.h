@@ -0,0 +1,166 @@
+#pragma once
+#include "Clause.h"
+#include "BoolValue.h"
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+/**
+<summary>
+Clauses bucketed by width for fast evaluation: binary and ternary clauses are
+kept as fixed-size inline records, longer clauses in one flat literal array.
+</summary>
+<remarks>
+Literals are stored as 2 * (variable - 1), plus 1 when negative. Because
+BoolValue has TRUE = 0 and FALSE = 1, a literal is satisfied exactly when the
+value of its variable equals its low bit, which keeps the kernels free of
+branches on the polarity.
+</remarks>
+*/
+class ClauseStore
+{
+public:
+    /**
+    <summary>
+    Constructor for an empty ClauseStore.
+    </summary>
+    */
+    ClauseStore() = default;
+
+    /**
+    <summary>
+    Constructor for the ClauseStore class.
+    </summary>
+    <param name="clauses">The clauses to store.</param>
+    */
+    explicit ClauseStore(const std::vector<Clause> &clauses);
+
+    /**
+    <summary>
+    Replaces the stored clauses, keeping the capacity of the buckets.
+    </summary>
+    <param name="clauses">The clauses to store.</param>
+    */
+    void assign(const std::vector<Clause> &clauses);
+
+    /**
+    <summary>
+    Adds a clause to the bucket of its width.
+    </summary>
+    <param name="clause">The clause to add.</param>
+    */
+    void add(const Clause &clause);
+
+    /**
+    <summary>
+    Evaluates every stored clause under a partial assignment.
+    </summary>
+    <param name="assignment">The value of each variable, indexed from 0.</param>
+    <returns>
+    TRUE if every clause is satisfied, FALSE if some clause has all of its literals
+    assigned false, otherwise UNASSIGNED.
+    </returns>
+    */
+    BoolValue evaluate(const std::vector<BoolValue> &assignment) const;
+
+    /**
+    <summary>
+    Checks that an assignment satisfies every stored clause.
+    </summary>
+    <param name="assignment">The value of each variable, indexed from 0.</param>
+    <returns>True if every clause has a literal assigned TRUE, otherwise false.</returns>
+    */
+    bool verify(const std::vector<BoolValue> &assignment) const;
+
+    /**
+    <summary>
+    Gets the number of stored clauses.
+    </summary>
+    <returns>The number of clauses of every width.</returns>
+    */
+    size_t size() const { return units.size() + binaries.size() + ternaries.size() + long_offsets.size() - 1 + num_empty; }
+
+private:
+    std::vector<std::array<int, 1>> units;
+    std::vector<std::array<int, 2>> binaries;
+    std::vector<std::array<int, 3>> ternaries;
+    std::vector<int> long_literals;
+    std::vector<uint32_t> long_offsets = std::vector<uint32_t>(1, 0); // Clause i spans [offsets[i], offsets[i + 1])
+    size_t num_empty = 0;
+
+    /**
+    <summary>
+    Evaluates a run of literals, with the length fixed at compile time when Width is non-zero.
+    </summary>
+    <param name="literals">The first literal.</param>
+    <param name="size">The number of literals, used only when Width is 0.</param>
+    <param name="assignment">The variable values.</param>
+    <returns>1 if satisfied, 0 if undecided, -1 if falsified.</returns>
+    */
+    template <int Width>
+    static int evaluateLiterals(const int *literals, int size, const BoolValue *assignment)
+    {
+        const int count = Width != 0 ? Width : size;
+        int unassigned = 0;
+        for (int i = 0; i < count; i++)
+        {
+            int value = static_cast<int>(assignment[literals[i] >> 1]);
+            if (value == (literals[i] & 1))
+            {
+                return 1;
+            }
+            unassigned |= (value == static_cast<int>(BoolValue::UNASSIGNED));
+        }
+        return unassigned - 1;
+    }
+
+    /**
+    <summary>
+    Checks every clause of one fixed-width bucket without early exits, so the
+    compiler can vectorize the loop.
+    </summary>
+    <param name="bucket">The clauses.</param>
+    <param name="assignment">The variable values.</param>
+    <returns>1 if all are satisfied, otherwise 0.</returns>
+    */
+    template <size_t Width>
+    static unsigned verifyBucket(const std::vector<std::array<int, Width>> &bucket, const BoolValue *assignment)
+    {
+        unsigned all = 1;
+        for (const std::array<int, Width> &clause : bucket)
+        {
+            unsigned satisfied = 0;
+            for (size_t i = 0; i < Width; i++)
+            {
+                satisfied |= static_cast<unsigned>(static_cast<int>(assignment[clause[i] >> 1]) == (clause[i] & 1));
+            }
+            all &= satisfied;
+        }
+        return all;
+    }
+
+    /**
+    <summary>
+    Evaluates every clause of one fixed-width bucket.
+    </summary>
+    <param name="bucket">The clauses.</param>
+    <param name="assignment">The variable values.</param>
+    <returns>1 if all are satisfied, 0 if some are undecided, -1 if one is falsified.</returns>
+    */
+    template <size_t Width>
+    static int evaluateBucket(const std::vector<std::array<int, Width>> &bucket, const BoolValue *assignment)
+    {
+        int status = 1;
+        for (const std::array<int, Width> &clause : bucket)
+        {
+            int result = evaluateLiterals<Width>(clause.data(), Width, assignment);
+            if (result < 0)
+            {
+                return -1;
+            }
+            status &= result;
+        }
+        return status;
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <sys/types.h>
+
+/**
+<summary>
+A stream buffer that reads a compressed file through an external decompressor
+(gzip, xz or zstd). The decompressor runs as a child process writing to a pipe,
+and a reader thread moves its output into a small ring of chunks, so parsing
+overlaps with decompression and the uncompressed file is never stored whole.
+</summary>
+*/
+class DecompressingStreamBuf : public std::streambuf
+{
+public:
+    /**
+    <summary>
+    Picks the decompressor for a file from its first bytes.
+    </summary>
+    <param name="magic">The first bytes of the file.</param>
+    <param name="size">The number of bytes available, up to six.</param>
+    <returns>"gzip", "xz" or "zstd", or nullptr if the file is not compressed in a known format.</returns>
+    */
+    static const char *detectDecompressor(const unsigned char *magic, size_t size);
+
+    /**
+    <summary>
+    Constructor for the DecompressingStreamBuf class. Starts the decompressor and
+    the reader thread.
+    </summary>
+    <param name="tool">The decompressor returned by detectDecompressor.</param>
+    <param name="filename">The compressed file.</param>
+    <remarks>
+    Throws std::runtime_error if the pipe or the child process cannot be created.
+    </remarks>
+    */
+    DecompressingStreamBuf(const std::string &tool, const std::string &filename);
+
+    /**
+    <summary>
+    Destructor for the DecompressingStreamBuf class. Stops the decompressor if it
+    is still running.
+    </summary>
+    */
+    ~DecompressingStreamBuf();
+
+    DecompressingStreamBuf(const DecompressingStreamBuf &) = delete;
+    DecompressingStreamBuf &operator=(const DecompressingStreamBuf &) = delete;
+
+    /**
+    <summary>
+    Stops reading and waits for the decompressor to exit.
+    </summary>
+    <returns>True if the decompressor read the whole file without error, otherwise false.</returns>
+    */
+    bool close();
+
+protected:
+    /**
+    <summary>
+    Makes the next decompressed chunk the get area, waiting for the reader thread if needed.
+    </summary>
+    <returns>The next character, or EOF once the decompressor's output is exhausted.</returns>
+    */
+    int_type underflow() override;
+
+private:
+    static const size_t CHUNK_SIZE = 256 * 1024;
+    static const size_t MAX_CHUNKS = 4; // Bounds how far decompression runs ahead of parsing
+
+    pid_t child = -1;
+    int pipe_fd = -1;
+    bool closed = false;
+    std::thread reader;
+
+    std::mutex mtx;
+    std::condition_variable chunk_ready;
+    std::condition_variable chunk_free;
+    std::deque<std::vector<char>> filled; // Decompressed chunks waiting to be parsed
+    std::vector<std::vector<char>> spare; // Parsed chunks kept for reuse
+    size_t allocated_chunks = 0;
+    bool end_of_input = false;
+    bool stopping = false;
+    std::vector<char> current; // The chunk under the get area
+
+    /**
+    <summary>
+    Reads the decompressor's output into chunks until it ends or the buffer is closed.
+    </summary>
+    */
+    void readerLoop();
+};
@@ -0,0 +1,183 @@
+#pragma once
+#include "BooleanFormula.h"
+#include <string>
+#include <iostream>
+#include <vector>
+
+/**
+<summary>
+Cheap features of a formula that tell the engines apart, computed in one pass
+over the clauses.
+</summary>
+*/
+struct FormulaFeatures
+{
+    int variables = 0;
+    int clauses = 0;
+    int max_width = 0;                 // Literals in the longest clause
+    double ratio = 0;                  // Clauses per variable
+    double density = 0;                // Ratio over the satisfiability threshold of random clauses of max_width literals
+    double binary_fraction = 0;        // Fraction of the clauses with two literals
+    double cardinality_fraction = 0;   // Fraction of the variables in at-most-one constraints over three or more variables
+};
+
+/**
+<summary>
+Thresholds of the engine selection, with the keys of a thresholds file.
+</summary>
+*/
+struct EngineThresholds
+{
+    double backtrack_max_vars = 12;             // backtrack_max_vars: largest formula left to the backtracking engine
+    double lookahead_min_density = 0.9;         // lookahead_min_density: least density for lookahead
+    double lookahead_max_vars = 400;            // lookahead_max_vars: largest formula for lookahead
+    double lookahead_max_binary_fraction = 0.1; // lookahead_max_binary_fraction: most binary clauses for lookahead
+    double lookahead_max_cardinality = 0.2;     // lookahead_max_cardinality: most cardinality structure for lookahead
+    double portfolio_min_clauses = 1000000;     // portfolio_min_clauses: least clauses for the portfolio
+};
+
+/**
+<summary>
+The measured solve time of every engine on one formula.
+</summary>
+*/
+struct EngineRecord
+{
+    FormulaFeatures features;
+    std::vector<double> times; // Microseconds per engine of EngineSelector::engineNames(), -1 if not measured
+};
+
+/**
+<summary>
+Picks the engine for a formula from its features. A formula with no clause
+longer than two goes to the linear 2-SAT engine; otherwise tiny formulas go to
+backtracking, small dense formulas without binary or cardinality structure to
+lookahead, very large ones to the portfolio and the rest to CDCL.
+</summary>
+<remarks>
+The thresholds can be tuned on benchmark records: every engine is timed on a
+batch of formulas, and the thresholds are set to the values, among those the
+features of the records take, that minimize the total time of the engines
+selected.
+</remarks>
+*/
+class EngineSelector
+{
+public:
+    /**
+    <summary>
+    Gets the names of the engines the selector chooses from.
+    </summary>
+    <returns>The names, in the order of EngineRecord::times.</returns>
+    */
+    static const std::vector<std::string> &engineNames();
+
+    /**
+    <summary>
+    Computes the features of a formula.
+    </summary>
+    <param name="formula">The formula.</param>
+    <returns>The features.</returns>
+    */
+    static FormulaFeatures extractFeatures(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Picks the engine for a formula.
+    </summary>
+    <param name="features">The features of the formula.</param>
+    <param name="thresholds">The thresholds.</param>
+    <returns>The name of the engine.</returns>
+    */
+    static std::string select(const FormulaFeatures &features, const EngineThresholds &thresholds);
+
+    /**
+    <summary>
+    Times every engine that can solve a formula in reasonable time.
+    </summary>
+    <param name="formula">The formula.</param>
+    <param name="portfolio_workers">The solver threads of the portfolio.</param>
+    <returns>The record of the formula.</returns>
+    <remarks>Backtracking and lookahead are only timed on formulas small enough for them.</remarks>
+    */
+    static EngineRecord measure(const BooleanFormula &formula, int portfolio_workers);
+
+    /**
+    <summary>
+    Sets the thresholds that minimize the total time of the selected engines on some records.
+    </summary>
+    <param name="records">The benchmark records.</param>
+    <param name="thresholds">The thresholds to start from; receives the tuned ones.</param>
+    <returns>The total time of the selected engines, in microseconds.</returns>
+    */
+    static double tune(const std::vector<EngineRecord> &records, EngineThresholds &thresholds);
+
+    /**
+    <summary>
+    Computes the total time of the engines a selection picks on some records.
+    </summary>
+    <param name="records">The benchmark records.</param>
+    <param name="thresholds">The thresholds.</param>
+    <returns>The total time in microseconds; an engine not measured on a record costs ten times its slowest engine.</returns>
+    */
+    static double totalTime(const std::vector<EngineRecord> &records, const EngineThresholds &thresholds);
+
+    /**
+    <summary>
+    Reads thresholds from a file of KEY=VALUE lines; lines starting with # are comments.
+    </summary>
+    <param name="path">The file.</param>
+    <param name="thresholds">Receives the values; keys not in the file keep theirs.</param>
+    <returns>True if the file was read and every key and value is valid, otherwise false.</returns>
+    */
+    static bool loadThresholds(const std::string &path, EngineThresholds &thresholds);
+
+    /**
+    <summary>
+    Writes thresholds in the format loadThresholds() reads.
+    </summary>
+    <param name="path">The file, replaced.</param>
+    <param name="thresholds">The thresholds.</param>
+    <returns>True if the file was written, otherwise false.</returns>
+    */
+    static bool saveThresholds(const std::string &path, const EngineThresholds &thresholds);
+
+    /**
+    <summary>
+    Reads thresholds as KEY=VALUE lines; lines starting with # are comments.
+    </summary>
+    <param name="input">The lines, read to the end.</param>
+    <param name="thresholds">Receives the values; keys not read keep theirs.</param>
+    <returns>True if every key and value is valid, otherwise false.</returns>
+    */
+    static bool readThresholds(std::istream &input, EngineThresholds &thresholds);
+
+    /**
+    <summary>
+    Writes thresholds as the KEY=VALUE lines readThresholds() reads.
+    </summary>
+    <param name="output">The stream written to.</param>
+    <param name="thresholds">The thresholds.</param>
+    */
+    static void writeThresholds(std::ostream &output, const EngineThresholds &thresholds);
+
+    /**
+    <summary>
+    Reads benchmark records from a CSV file written by appendRecords().
+    </summary>
+    <param name="path">The file.</param>
+    <param name="records">Receives the records; rows that do not parse are skipped.</param>
+    <returns>True if the file was opened, otherwise false.</returns>
+    */
+    static bool loadRecords(const std::string &path, std::vector<EngineRecord> &records);
+
+    /**
+    <summary>
+    Appends benchmark records to a CSV file, writing its header if it is new.
+    </summary>
+    <param name="path">The file.</param>
+    <param name="records">The records.</param>
+    <returns>True if the records were written, otherwise false.</returns>
+    */
+    static bool appendRecords(const std::string &path, const std::vector<EngineRecord> &records);
+};
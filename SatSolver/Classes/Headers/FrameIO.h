@@ -0,0 +1,92 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+/**
+<summary>
+Helpers for the length-prefixed framing used on solver sockets. A frame is a
+32-bit payload length in network byte order followed by the payload bytes.
+</summary>
+*/
+namespace FrameIO
+{
+    // Frames larger than this are rejected to bound memory use per connection.
+    const uint32_t MAX_FRAME_SIZE = 256u * 1024u * 1024u;
+
+    /**
+    <summary>
+    Reads one frame from a socket, retrying on short reads and interrupts.
+    </summary>
+    <param name="fd">The socket to read from.</param>
+    <param name="payload">Receives the payload of the frame.</param>
+    <returns>True if a complete frame was read, false on end of stream or error.</returns>
+    */
+    bool readFrame(int fd, std::string &payload);
+
+    /**
+    <summary>
+    Writes one frame to a socket, retrying on short writes and interrupts.
+    </summary>
+    <param name="fd">The socket to write to.</param>
+    <param name="payload">The payload of the frame.</param>
+    <returns>True if the whole frame was written, otherwise false.</returns>
+    */
+    bool writeFrame(int fd, const std::string &payload);
+
+    /**
+    <summary>
+    Appends a 32-bit value in network byte order to a buffer.
+    </summary>
+    <param name="buffer">The buffer to append to.</param>
+    <param name="value">The value to append.</param>
+    */
+    void appendUint32(std::string &buffer, uint32_t value);
+
+    /**
+    <summary>
+    Reads a 32-bit value in network byte order from a buffer.
+    </summary>
+    <param name="buffer">The buffer to read from.</param>
+    <param name="offset">The position of the value; advanced past it on success.</param>
+    <param name="value">Receives the value.</param>
+    <returns>True if the buffer held four more bytes, otherwise false.</returns>
+    */
+    bool readUint32(const std::string &buffer, size_t &offset, uint32_t &value);
+
+    /**
+    <summary>
+    Removes one complete frame from the front of a receive buffer, for callers
+    that read sockets without blocking.
+    </summary>
+    <param name="buffer">The bytes received so far.</param>
+    <param name="payload">Receives the payload of the frame.</param>
+    <returns>True if a complete frame was extracted, false if more bytes are needed.</returns>
+    <remarks>
+    Throws std::runtime_error if the frame announces more than MAX_FRAME_SIZE bytes.
+    </remarks>
+    */
+    bool extractFrame(std::string &buffer, std::string &payload);
+
+    /**
+    <summary>
+    Creates a listening socket for an address of the form "unix:PATH" or "HOST:PORT".
+    </summary>
+    <param name="address">The address to listen on.</param>
+    <returns>The listening socket.</returns>
+    <remarks>
+    A stale Unix socket file at PATH is removed first. Throws std::runtime_error
+    if PATH holds anything other than a socket, or if the socket cannot be
+    created or bound.
+    </remarks>
+    */
+    int listenOn(const std::string &address);
+
+    /**
+    <summary>
+    Connects to an address of the form "unix:PATH" or "HOST:PORT".
+    </summary>
+    <param name="address">The address to connect to.</param>
+    <returns>The connected socket, or -1 if the connection failed.</returns>
+    */
+    int connectTo(const std::string &address);
+}
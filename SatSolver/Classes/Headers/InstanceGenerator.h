@@ -0,0 +1,99 @@
+#pragma once
+#include "BooleanFormula.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+<summary>
+Parameters of a batch of generated formulas, written on the command line as
+FAMILY[:KEY=VALUE,...], for example "random:vars=10000,ratio=4.26,count=5".
+</summary>
+*/
+struct GeneratorSpec
+{
+    std::string family = "random"; // random, planted or sudoku
+    int variables = 100;           // vars: variables of a random or planted formula
+    int k = 3;                     // k: literals per clause
+    double ratio = 4.26;           // ratio: clauses per variable; 4.26 is the 3-SAT phase transition
+    int order = 9;                 // order: side of a Sudoku grid, a perfect square
+    double givens = 0.4;           // givens: fraction of Sudoku cells filled in
+    int count = 1;                 // count: formulas in the batch
+    double growth = 1;             // growth: factor applied to vars (or order) from one formula to the next
+    uint64_t seed = 1;             // seed: formula i is generated from seed and i alone
+};
+
+/**
+<summary>
+Generates benchmark formulas: uniform random k-SAT, random k-SAT with a
+planted solution, and Sudoku puzzles. The same spec always produces the same
+formulas, on any platform, so scaling curves can be reproduced.
+</summary>
+<remarks>
+Random numbers come from a SplitMix64 generator with rejection sampling
+instead of the standard distributions, whose output differs between library
+implementations.
+</remarks>
+*/
+class InstanceGenerator
+{
+public:
+    /**
+    <summary>
+    Parses a generator spec.
+    </summary>
+    <param name="text">The spec, FAMILY[:KEY=VALUE,...].</param>
+    <param name="spec">Receives the parameters; keys not given keep their defaults.</param>
+    <returns>True if the family, every key and every value are valid, otherwise false.</returns>
+    */
+    static bool parseSpec(const std::string &text, GeneratorSpec &spec);
+
+    /**
+    <summary>
+    Generates the formulas of a spec.
+    </summary>
+    <param name="spec">The parameters.</param>
+    <returns>The formulas, in order.</returns>
+    */
+    static std::vector<BooleanFormula> generate(const GeneratorSpec &spec);
+
+    /**
+    <summary>
+    Generates a uniform random k-SAT formula: each clause has k distinct variables with random signs.
+    </summary>
+    <param name="variables">The number of variables.</param>
+    <param name="k">The literals per clause, at most the number of variables.</param>
+    <param name="ratio">The clauses per variable.</param>
+    <param name="seed">The random seed.</param>
+    <returns>The formula, with an unknown ('?') answer.</returns>
+    */
+    static BooleanFormula randomKSat(int variables, int k, double ratio, uint64_t seed);
+
+    /**
+    <summary>
+    Generates a random k-SAT formula satisfied by a hidden random assignment:
+    clauses that assignment falsifies are drawn again.
+    </summary>
+    <param name="variables">The number of variables.</param>
+    <param name="k">The literals per clause, at most the number of variables.</param>
+    <param name="ratio">The clauses per variable.</param>
+    <param name="seed">The random seed.</param>
+    <returns>The formula, with answer 'S'.</returns>
+    */
+    static BooleanFormula plantedKSat(int variables, int k, double ratio, uint64_t seed);
+
+    /**
+    <summary>
+    Generates a Sudoku puzzle: a shuffled complete grid with some cells given.
+    </summary>
+    <param name="order">The side of the grid, a perfect square such as 4, 9 or 16.</param>
+    <param name="givens">The fraction of cells given as unit clauses.</param>
+    <param name="seed">The random seed.</param>
+    <returns>The formula, with answer 'S'; variable (r * order + c) * order + v + 1 puts value v + 1 in row r, column c.</returns>
+    <remarks>
+    Uses the minimal encoding: every cell has a value and no value repeats in a
+    row, column or box. Together they leave each cell exactly one value.
+    </remarks>
+    */
+    static BooleanFormula sudoku(int order, double givens, uint64_t seed);
+};
@@ -1,15 +1,18 @@
 #pragma once
 #include "BoolValue.h"
+#include <cstdint>
 
 class Literal
 {
 public:
+    static const int MAX_VARIABLE = 1 << 25; // Largest variable number accepted from input, which bounds the per-variable arrays
+
     /**
     <summary>
     Constructor for the Literal class.
     </summary>
     <param name="var">The variable number for the literal.</param>
-    <param name="val">The BoolValue representing the value of the literal (TRUE, FALSE, or UNASSIGNED).</param>
+    <param name="val">TRUE for the positive literal of the variable, FALSE for the negative one.</param>
     */
     Literal(int var, BoolValue val);
 
@@ -18,7 +21,7 @@ public:
     Default constructor for the Literal class.
     </summary>
     */
-    Literal() : variable(0), value(BoolValue::UNASSIGNED) {} // Default constructor
+    Literal() : code(0) {} // Default constructor
 
     /**
     <summary>
@@ -39,9 +42,9 @@ public:
 
     /**
     <summary>
-    Gets the value of the literal (TRUE, FALSE, or UNASSIGNED).
+    Gets the sign of the literal.
     </summary>
-    <returns>The value of the literal as BoolValue.</returns>
+    <returns>TRUE for a positive literal, FALSE for a negative one.</returns>
     */
     BoolValue getValue() const;
 
@@ -64,6 +67,5 @@ public:
     friend bool operator<(const Literal &lhs, const Literal &rhs);
 
 private:
-    int variable;    // Variable number
-    BoolValue value; // TRUE, FALSE, or UNASSIGNED
+    uint32_t code; // 2 * variable + 1 if negative, so the low bit is the sign
 };
@@ -0,0 +1,223 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include <vector>
+
+/**
+<summary>
+A lookahead DPLL solver in the style of march, for small formulas with many
+clauses per variable such as dense random k-SAT. At every node it pre-selects
+the most promising free variables, propagates both polarities of each and
+measures how much each shrinks the formula, then branches on the variable whose
+two sides shrink it most evenly.
+</summary>
+<remarks>
+Lookahead also simplifies the node: a polarity whose propagation conflicts is a
+failed literal and its negation is fixed, a polarity whose propagation satisfies
+every clause it touches is an autarky and is kept, and literals implied by both
+polarities of a variable are fixed.
+</remarks>
+<remarks>
+Clauses are counted rather than watched: every assignment updates the number of
+TRUE and FALSE literals of the clauses it occurs in, which is what lets a
+lookahead see each clause it reduces. That is cheap on the short clauses and
+few variables this engine is meant for.
+</remarks>
+*/
+class LookaheadSolver
+{
+public:
+    /**
+    <summary>
+    Constructor for the LookaheadSolver class.
+    </summary>
+    <param name="formula">The Boolean formula to be solved; its clauses are copied.</param>
+    */
+    explicit LookaheadSolver(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Searches for a model.
+    </summary>
+    <returns>True if the formula is satisfiable, otherwise false.</returns>
+    */
+    bool solve();
+
+    /**
+    <summary>
+    Gets the model found by solve().
+    </summary>
+    <returns>One BoolValue per variable; variables the model leaves free are FALSE.</returns>
+    */
+    const std::vector<BoolValue> &getAssignment() const { return model; }
+
+    /**
+    <summary>
+    Limits the variables looked ahead on at each node.
+    </summary>
+    <param name="min_candidates">Variables always looked ahead on when free.</param>
+    <param name="fraction">Fraction of the free variables looked ahead on, when more than the minimum.</param>
+    */
+    void setPreselection(int min_candidates, double fraction)
+    {
+        this->min_candidates = min_candidates;
+        candidate_fraction = fraction;
+    }
+
+    /**
+    <summary>
+    Gets the number of branching decisions.
+    </summary>
+    <returns>The number of decisions.</returns>
+    */
+    unsigned long long getNumDecisions() const { return num_decisions; }
+
+    /**
+    <summary>
+    Gets the number of literals looked ahead on.
+    </summary>
+    <returns>The number of lookaheads.</returns>
+    */
+    unsigned long long getNumLookaheads() const { return num_lookaheads; }
+
+    /**
+    <summary>
+    Gets the number of literals assigned, by decisions, lookaheads and propagation.
+    </summary>
+    <returns>The number of propagations.</returns>
+    */
+    unsigned long long getNumPropagations() const { return num_propagations; }
+
+    /**
+    <summary>
+    Gets the number of failed literals found.
+    </summary>
+    <returns>The number of failed literals.</returns>
+    */
+    unsigned long long getNumFailedLiterals() const { return num_failed_literals; }
+
+    /**
+    <summary>
+    Gets the number of autarkies found.
+    </summary>
+    <returns>The number of autarkies.</returns>
+    */
+    unsigned long long getNumAutarkies() const { return num_autarkies; }
+
+    /**
+    <summary>
+    Gets the number of literals fixed because both polarities of a variable imply them.
+    </summary>
+    <returns>The number of necessary assignments.</returns>
+    */
+    unsigned long long getNumNecessaryAssignments() const { return num_necessary; }
+
+private:
+    int num_vars = 0;
+    bool consistent = true;
+    std::vector<int> literals;               // Clause literals, internal 2 * var + sign, clause after clause
+    std::vector<int> clause_start;           // Start of each clause in literals, plus one past the last
+    std::vector<std::vector<int>> occurrences; // Clauses of each literal
+    std::vector<int> num_true;               // TRUE literals of each clause
+    std::vector<int> num_false;              // FALSE literals of each clause
+    std::vector<signed char> values;         // Per variable: 1 TRUE, -1 FALSE, 0 free
+    std::vector<int> trail;                  // Assigned literals, oldest first
+    size_t propagated = 0;                   // Trail entries whose clauses are counted
+    int num_satisfied = 0;
+    std::vector<BoolValue> model;
+
+    int min_candidates = 10;
+    double candidate_fraction = 0.1;
+
+    // Scratch of lookahead() and chooseBranch()
+    std::vector<int> reduced;                // Clauses a lookahead put a FALSE literal in
+    std::vector<int> implied;                // Literals the last lookahead assigned
+    std::vector<unsigned> clause_stamp;      // Per clause: the last lookahead that scored it
+    std::vector<unsigned> implied_stamp;     // Per literal: the last positive lookahead that implied it
+    unsigned stamp = 0;
+
+    unsigned long long num_decisions = 0;
+    unsigned long long num_lookaheads = 0;
+    unsigned long long num_propagations = 0;
+    unsigned long long num_failed_literals = 0;
+    unsigned long long num_autarkies = 0;
+    unsigned long long num_necessary = 0;
+
+    /**
+    <summary>
+    Gets the value of an internal literal.
+    </summary>
+    <param name="lit">The literal.</param>
+    <returns>1 if TRUE, -1 if FALSE, 0 if free.</returns>
+    */
+    int value(int lit) const { return (lit & 1) ? -values[lit >> 1] : values[lit >> 1]; }
+
+    /**
+    <summary>
+    Gets the number of clauses.
+    </summary>
+    <returns>The number of clauses.</returns>
+    */
+    int numClauses() const { return static_cast<int>(clause_start.size()) - 1; }
+
+    /**
+    <summary>
+    Assigns a literal TRUE; propagate() counts it into its clauses.
+    </summary>
+    <param name="lit">A free literal.</param>
+    */
+    void assign(int lit);
+
+    /**
+    <summary>
+    Counts the pending trail literals into their clauses and assigns the last free
+    literal of every clause left with one.
+    </summary>
+    <param name="scored">Whether to collect the clauses a FALSE literal reduced.</param>
+    <returns>False on a clause with every literal FALSE, otherwise true.</returns>
+    */
+    bool propagate(bool scored);
+
+    /**
+    <summary>
+    Unassigns the trail back to a given length, uncounting what was counted.
+    </summary>
+    <param name="length">The trail length to keep.</param>
+    */
+    void backtrackTo(size_t length);
+
+    /**
+    <summary>
+    Propagates one literal and measures the reduction, then undoes it.
+    </summary>
+    <param name="lit">A free literal.</param>
+    <param name="score">Receives the weighted count of the clauses it shortened without satisfying.</param>
+    <returns>1 if propagation conflicts, 2 if the propagation is an autarky and was kept, otherwise 0 and implied holds the literals it assigned.</returns>
+    */
+    int lookahead(int lit, double &score);
+
+    /**
+    <summary>
+    Ranks the free variables by the clauses their literals occur in and keeps the best.
+    </summary>
+    <returns>The candidates, best first.</returns>
+    */
+    std::vector<int> preselect() const;
+
+    /**
+    <summary>
+    Looks ahead on the candidates until no more literals are forced, then picks the branch.
+    </summary>
+    <param name="branch">Receives the literal to try first, or -1 if every clause is satisfied.</param>
+    <returns>False if the node was refuted, otherwise true.</returns>
+    */
+    bool chooseBranch(int &branch);
+
+    /**
+    <summary>
+    Recursive search below the current node.
+    </summary>
+    <returns>True if a model was found, otherwise false.</returns>
+    */
+    bool search();
+};
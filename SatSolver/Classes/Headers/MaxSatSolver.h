@@ -0,0 +1,216 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include "CdclSolver.h"
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+
+/**
+<summary>
+Finds an assignment of least total weight of violated soft clauses while
+satisfying every hard clause, by core-guided search (OLL, as in RC2) on an
+incremental CdclSolver.
+</summary>
+<remarks>
+Each soft clause is relaxed by a selector variable that is assumed true. An
+unsatisfiable solve yields a core of assumptions: its least weight is added to
+the lower bound and a totalizer over the core's violations lets the next solves
+pay for one violation but no more. A satisfiable solve gives an upper bound;
+when it includes every assumption its cost meets the lower bound and is optimal.
+</remarks>
+<remarks>
+With stratification, only the assumptions of the heaviest weights are passed
+at first and lighter ones are added each time the solver finds a model, so
+good models of the weighty clauses are found early.
+</remarks>
+*/
+class MaxSatSolver
+{
+public:
+    // Receives the cost, the lower bound and the model of each improvement
+    typedef std::function<void(unsigned long long, unsigned long long, const std::vector<BoolValue> &)> ImprovementCallback;
+
+    /**
+    <summary>
+    Constructor for the MaxSatSolver class.
+    </summary>
+    <param name="formula">The formula; without weights every clause is soft with weight 1.</param>
+    <param name="stratify">Whether to add assumptions by decreasing weight.</param>
+    */
+    MaxSatSolver(const BooleanFormula &formula, bool stratify = true);
+
+    /**
+    <summary>
+    Searches for an optimal assignment.
+    </summary>
+    <param name="on_improvement">Called with the cost, the lower bound and the model each time a better model is found.</param>
+    <returns>True if some assignment satisfies the hard clauses, otherwise false.</returns>
+    */
+    bool solve(const ImprovementCallback &on_improvement = ImprovementCallback());
+
+    /**
+    <summary>
+    Limits the time solve() may run; the best model found so far is then kept.
+    </summary>
+    <param name="limit">The time allowed; zero means no limit.</param>
+    */
+    void setTimeLimit(std::chrono::milliseconds limit) { time_limit = limit; }
+
+    /**
+    <summary>
+    Gets the best assignment found.
+    </summary>
+    <returns>One BoolValue per variable; UNASSIGNED throughout if the hard clauses are unsatisfiable.</returns>
+    */
+    const std::vector<BoolValue> &getAssignment() const { return best_model; }
+
+    /**
+    <summary>
+    Gets the total weight of the soft clauses the best assignment violates.
+    </summary>
+    <returns>The cost.</returns>
+    */
+    unsigned long long getCost() const { return best_cost; }
+
+    /**
+    <summary>
+    Gets the proven lower bound on the cost.
+    </summary>
+    <returns>The lower bound; equal to the cost once it is optimal.</returns>
+    */
+    unsigned long long getLowerBound() const { return lower_bound; }
+
+    /**
+    <summary>
+    Tells whether the best assignment is proven optimal.
+    </summary>
+    <returns>False if the time limit stopped the search first.</returns>
+    */
+    bool isOptimal() const { return optimal; }
+
+    /**
+    <summary>
+    Gets the number of unsatisfiable cores relaxed.
+    </summary>
+    <returns>The number of cores.</returns>
+    */
+    unsigned long long getNumCores() const { return num_cores; }
+
+    /**
+    <summary>
+    Gets the number of calls to the SAT solver.
+    </summary>
+    <returns>The number of calls.</returns>
+    */
+    unsigned long long getNumSatCalls() const { return num_sat_calls; }
+
+    /**
+    <summary>
+    Gets the number of soft clauses.
+    </summary>
+    <returns>The number of soft clauses.</returns>
+    */
+    int getNumSoftClauses() const { return static_cast<int>(soft_clauses.size()); }
+
+private:
+    // A node of a totalizer tree: outputs[j] is true when more than j of the inputs below it are
+    struct TotalizerNode
+    {
+        int left;                 // Child nodes, -1 for an input
+        int right;
+        int size;                 // Inputs below the node
+        std::vector<int> outputs; // Encoded so far; an input is its own single output
+    };
+
+    const BooleanFormula &formula;
+    CdclSolver sat;
+    bool stratify;
+    std::chrono::milliseconds time_limit{0};
+    bool hard_consistent = true;
+
+    std::vector<std::pair<size_t, unsigned long long>> soft_clauses; // Clause index and weight
+    unsigned long long base_cost = 0;                                // Weight of empty soft clauses
+    std::map<int, unsigned long long> weights;                       // Assumption literal -> weight still to be paid
+    std::vector<TotalizerNode> totalizer_nodes;
+    std::unordered_map<int, std::pair<int, int>> bounds;             // Assumption -outputs[k] -> (root node, k)
+
+    bool found = false;
+    std::vector<BoolValue> best_model;
+    unsigned long long best_cost = 0;
+    unsigned long long lower_bound = 0;
+    bool optimal = false;
+    unsigned long long num_cores = 0;
+    unsigned long long num_sat_calls = 0;
+
+    /**
+    <summary>
+    Runs the core-guided search until it proves optimality or is interrupted.
+    </summary>
+    <param name="on_improvement">Called each time a better model is found.</param>
+    */
+    void search(const ImprovementCallback &on_improvement);
+
+    /**
+    <summary>
+    Keeps a model of the SAT solver if it is the best so far.
+    </summary>
+    <param name="on_improvement">Called if the model is kept.</param>
+    */
+    void considerModel(const ImprovementCallback &on_improvement);
+
+    /**
+    <summary>
+    Computes the weight of the soft clauses a model violates.
+    </summary>
+    <param name="model">One BoolValue per variable of the formula.</param>
+    <returns>The cost.</returns>
+    */
+    unsigned long long costOf(const std::vector<BoolValue> &model) const;
+
+    /**
+    <summary>
+    Pays for an unsatisfiable core and relaxes it.
+    </summary>
+    <param name="core">The failed assumptions.</param>
+    */
+    void relaxCore(const std::vector<int> &core);
+
+    /**
+    <summary>
+    Shrinks a core by solving again under its own assumptions.
+    </summary>
+    <param name="core">The core, replaced by the smaller cores found.</param>
+    */
+    void trimCore(std::vector<int> &core);
+
+    /**
+    <summary>
+    Builds the tree of a totalizer counting how many of the inputs are true.
+    </summary>
+    <param name="inputs">The DIMACS literals to count.</param>
+    <returns>The index of the root node; its outputs are added by extendTotalizer().</returns>
+    */
+    int buildTotalizer(const std::vector<int> &inputs);
+
+    /**
+    <summary>
+    Makes sure a totalizer node has its first outputs, encoding them on demand.
+    </summary>
+    <param name="node">The index of the node.</param>
+    <param name="count">The number of outputs needed.</param>
+    <returns>False if the node counts fewer inputs than that, otherwise true.</returns>
+    */
+    bool extendTotalizer(int node, int count);
+
+    /**
+    <summary>
+    Gets the next lower weight among the assumptions.
+    </summary>
+    <param name="stratum">The current weight threshold.</param>
+    <returns>The largest assumption weight below the threshold, or 0 if there is none.</returns>
+    */
+    unsigned long long nextStratum(unsigned long long stratum) const;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class ModelCount
+{
+public:
+    /**
+    <summary>
+    Constructor for the ModelCount class.
+    </summary>
+    <param name="value">The initial value of the count.</param>
+    */
+    ModelCount(unsigned long long value = 0);
+
+    /**
+    <summary>
+    Creates a count equal to two raised to the given power.
+    </summary>
+    <param name="exponent">The power of two.</param>
+    <returns>The count 2^exponent.</returns>
+    */
+    static ModelCount powerOfTwo(int exponent);
+
+    /**
+    <summary>
+    Adds another count to this one.
+    </summary>
+    <param name="other">The count to add.</param>
+    <returns>A reference to this count.</returns>
+    */
+    ModelCount &operator+=(const ModelCount &other);
+
+    /**
+    <summary>
+    Multiplies this count by another one.
+    </summary>
+    <param name="other">The count to multiply by.</param>
+    <returns>A reference to this count.</returns>
+    */
+    ModelCount &operator*=(const ModelCount &other);
+
+    /**
+    <summary>
+    Checks whether the count is zero.
+    </summary>
+    <returns>True if the count is zero, otherwise false.</returns>
+    */
+    bool isZero() const { return limbs.empty(); }
+
+    /**
+    <summary>
+    Compares the count against a machine-sized value.
+    </summary>
+    <param name="value">The value to compare against.</param>
+    <returns>True if the count is greater than or equal to the value.</returns>
+    */
+    bool atLeast(unsigned long long value) const;
+
+    /**
+    <summary>
+    Converts the count to its decimal representation.
+    </summary>
+    <returns>The count as a decimal string.</returns>
+    */
+    std::string toString() const;
+
+private:
+    std::vector<uint32_t> limbs; // Little-endian base 2^32 digits, no leading zeros
+
+    void trim();
+};
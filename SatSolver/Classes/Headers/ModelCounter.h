@@ -0,0 +1,103 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "ModelCount.h"
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+class ModelCounter
+{
+public:
+    /**
+    <summary>
+    Constructor for the ModelCounter class.
+    </summary>
+    <param name="formula">The Boolean formula whose models are counted.</param>
+    */
+    ModelCounter(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Computes the exact number of models of the formula over all of its variables.
+    </summary>
+    <returns>The number of satisfying assignments.</returns>
+    */
+    ModelCount count();
+
+    /**
+    <summary>
+    Gets the number of branching decisions made while counting.
+    </summary>
+    <returns>The number of decisions.</returns>
+    */
+    unsigned long long getNumDecisions() const { return num_decisions; }
+
+    /**
+    <summary>
+    Gets the number of residual components whose count was served from the cache.
+    </summary>
+    <returns>The number of cache hits.</returns>
+    */
+    unsigned long long getNumCacheHits() const { return num_cache_hits; }
+
+    /**
+    <summary>
+    Gets the number of times a residual formula split into independent components.
+    </summary>
+    <returns>The number of component splits.</returns>
+    */
+    unsigned long long getNumComponentSplits() const { return num_component_splits; }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const std::vector<int> &key) const;
+    };
+
+    std::vector<std::vector<int>> clauses; // Clauses as signed variable numbers
+    std::vector<signed char> values;       // 1 = TRUE, -1 = FALSE, 0 = UNASSIGNED, indexed by variable
+    std::vector<int> trail;                // Variables assigned, in order, for undoing
+    std::vector<int> parent;               // Union-find forest used for component detection
+    std::vector<unsigned> occurrence_stamp;
+    unsigned current_stamp = 0;
+    std::unordered_map<std::vector<int>, ModelCount, KeyHash> cache;
+    size_t max_cache_entries = 1 << 20;
+
+    /**
+    <summary>
+    Counts the models of a residual component under the current partial assignment.
+    </summary>
+    <param name="clause_ids">The clauses belonging to the component.</param>
+    <param name="vars">The unassigned variables belonging to the component.</param>
+    <returns>The number of assignments to vars that satisfy the clauses.</returns>
+    */
+    ModelCount countComponent(const std::vector<int> &clause_ids, const std::vector<int> &vars);
+
+    /**
+    <summary>
+    Runs unit propagation restricted to the given clauses.
+    </summary>
+    <param name="clause_ids">The clauses to propagate over.</param>
+    <returns>True if no clause became falsified, otherwise false.</returns>
+    */
+    bool propagate(const std::vector<int> &clause_ids);
+
+    /**
+    <summary>
+    Builds the cache key of a component: its residual clauses with literals and
+    clauses sorted.
+    </summary>
+    <param name="clause_ids">The clauses belonging to the component.</param>
+    <returns>The canonical residual formula, clauses separated by zeros.</returns>
+    */
+    std::vector<int> residualKey(const std::vector<int> &clause_ids) const;
+
+    int literalValue(int literal) const { return literal > 0 ? values[literal] : -values[-literal]; }
+    void assign(int literal);
+    void undo(size_t trail_mark);
+    int findRoot(int var);
+
+    unsigned long long num_decisions = 0;
+    unsigned long long num_cache_hits = 0;
+    unsigned long long num_component_splits = 0;
+};
@@ -0,0 +1,200 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include "CdclSolver.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+/**
+<summary>
+Extracts a minimal unsatisfiable subset (MUS) of the clauses of an
+unsatisfiable formula: a subset that is unsatisfiable and becomes satisfiable
+without any one of its clauses. Each clause is relaxed by a selector variable
+on incremental CdclSolvers, so a subset is solved by assuming its selectors.
+</summary>
+<remarks>
+The clauses are first narrowed to the core of failed assumptions until it stops
+shrinking (clause-set refinement). Deletion-based trimming then tests each
+remaining clause by solving without it: if that is unsatisfiable the clause is
+dropped, together with every clause outside the new core; if it is satisfiable
+the clause is critical and belongs to the MUS. Model rotation flips the model of
+a critical clause one variable at a time, and a flip that falsifies exactly one
+other clause proves that clause critical without a SAT call.
+</remarks>
+<remarks>
+Trimming runs on several workers, each with its own solver, which test
+different clauses at once. Critical clauses stay critical as the set shrinks,
+so those results always hold. A dropped clause only holds while every clause of
+its core is still in the set; otherwise the clause is tested again. Decided
+clauses are fixed in every worker's solver as unit selectors.
+</remarks>
+*/
+class MusExtractor
+{
+public:
+    /**
+    <summary>
+    Constructor for the MusExtractor class.
+    </summary>
+    <param name="formula">The Boolean formula; its clauses are copied.</param>
+    <param name="num_workers">The number of solvers trimming in parallel.</param>
+    */
+    MusExtractor(const BooleanFormula &formula, int num_workers = 1);
+
+    /**
+    <summary>
+    Decides the formula and, if it is unsatisfiable, extracts an MUS.
+    </summary>
+    <returns>True if the formula is unsatisfiable, otherwise false.</returns>
+    */
+    bool extract();
+
+    /**
+    <summary>
+    Gets the MUS found by extract().
+    </summary>
+    <returns>The indices of its clauses in the formula, ascending; empty if the formula is satisfiable.</returns>
+    */
+    const std::vector<int> &getMus() const { return mus; }
+
+    /**
+    <summary>
+    Gets the model found when the formula is satisfiable.
+    </summary>
+    <returns>One BoolValue per variable; UNASSIGNED throughout if the formula is unsatisfiable.</returns>
+    */
+    const std::vector<BoolValue> &getAssignment() const { return model; }
+
+    /**
+    <summary>
+    Gets the number of calls to the SAT solvers.
+    </summary>
+    <returns>The number of calls.</returns>
+    */
+    unsigned long long getNumSatCalls() const { return num_sat_calls; }
+
+    /**
+    <summary>
+    Gets the number of clauses proven critical by model rotation rather than a SAT call.
+    </summary>
+    <returns>The number of rotated clauses.</returns>
+    */
+    unsigned long long getNumRotated() const { return num_rotated; }
+
+    /**
+    <summary>
+    Gets the number of clauses dropped for lying outside a core.
+    </summary>
+    <returns>The number of refined clauses.</returns>
+    */
+    unsigned long long getNumRefined() const { return num_refined; }
+
+    /**
+    <summary>
+    Gets the number of clause tests repeated because the set shrank under them.
+    </summary>
+    <returns>The number of repeated tests.</returns>
+    */
+    unsigned long long getNumRetests() const { return num_retests; }
+
+    /**
+    <summary>
+    Gets the size of the core clause-set refinement settled on, before trimming.
+    </summary>
+    <returns>The number of clauses in the core.</returns>
+    */
+    int getInitialCoreSize() const { return initial_core_size; }
+
+private:
+    enum class Status
+    {
+        UNKNOWN,
+        CRITICAL,
+        REMOVED
+    };
+
+    // A solver of the relaxed clauses and how many of the fixed selectors it holds
+    struct Worker
+    {
+        std::unique_ptr<CdclSolver> sat;
+        size_t fixed_added = 0;
+    };
+
+    int num_workers;
+    int num_vars;
+    std::vector<std::vector<int>> clauses;     // DIMACS literals of each clause
+    std::vector<std::vector<int>> occurrences; // Clauses of each internal literal 2 * (var - 1) + negative
+    std::vector<Worker> workers;
+
+    // Shared by the workers under mtx
+    std::mutex mtx;
+    std::condition_variable changed;
+    std::vector<Status> status;
+    std::vector<char> in_flight;     // Clauses a worker is testing
+    std::vector<int> remaining;      // Clauses of the set when trimming started, ascending
+    std::vector<int> fixed;          // Selector literals decided so far, in order
+    size_t next_candidate = 0;       // Entries of remaining before it are decided
+    int num_in_flight = 0;
+
+    std::vector<int> mus;
+    std::vector<BoolValue> model;
+    unsigned long long num_sat_calls = 0;
+    unsigned long long num_rotated = 0;
+    unsigned long long num_refined = 0;
+    unsigned long long num_retests = 0;
+    int initial_core_size = 0;
+
+    /**
+    <summary>
+    Gets the selector variable of a clause.
+    </summary>
+    <param name="clause">The clause index.</param>
+    <returns>The selector, numbered after the formula's variables.</returns>
+    */
+    int selectorOf(int clause) const { return num_vars + 1 + clause; }
+
+    /**
+    <summary>
+    Builds a solver of the formula with every clause relaxed by its selector.
+    </summary>
+    <returns>The solver.</returns>
+    */
+    std::unique_ptr<CdclSolver> buildSolver() const;
+
+    /**
+    <summary>
+    Tests clauses until every clause is decided.
+    </summary>
+    <param name="worker">The worker's solver.</param>
+    */
+    void trim(Worker &worker);
+
+    /**
+    <summary>
+    Marks the undecided clauses of the set outside a core REMOVED; the caller holds mtx.
+    </summary>
+    <param name="core">The failed selector literals.</param>
+    */
+    void refine(const std::vector<int> &core);
+
+    /**
+    <summary>
+    Proves further clauses critical by flipping a model of a critical clause; the caller holds mtx.
+    </summary>
+    <param name="critical">The clause the model falsifies, alone in the set.</param>
+    <param name="assignment">The model over the formula's variables, modified and restored.</param>
+    */
+    void rotate(int critical, std::vector<BoolValue> &assignment);
+
+    /**
+    <summary>
+    Tells whether an assignment satisfies a clause.
+    </summary>
+    <param name="clause">The clause index.</param>
+    <param name="assignment">The assignment over the formula's variables.</param>
+    <returns>True if some literal of the clause is TRUE.</returns>
+    */
+    bool satisfies(int clause, const std::vector<BoolValue> &assignment) const;
+};
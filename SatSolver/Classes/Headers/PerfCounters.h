@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+
+/**
+<summary>
+Hardware counter values, each -1 when its counter could not be opened.
+</summary>
+*/
+struct PerfSample
+{
+    static const int NUM_EVENTS = 5;
+    long long values[NUM_EVENTS] = {-1, -1, -1, -1, -1};
+
+    /**
+    <summary>
+    Computes the counts between two samples.
+    </summary>
+    <param name="earlier">The sample taken first.</param>
+    <returns>The difference, with -1 kept where either sample lacks a value.</returns>
+    */
+    PerfSample operator-(const PerfSample &earlier) const;
+
+    /**
+    <summary>
+    Formats the values as CSV columns, each followed by a comma.
+    </summary>
+    <returns>The columns.</returns>
+    */
+    std::string toColumns() const;
+};
+
+/**
+<summary>
+Counts cycles, instructions, L1 data cache read misses, last-level cache misses
+and branch misses of the calling thread through perf_event_open. Threads it
+starts later, such as portfolio workers, are included once they have exited.
+</summary>
+<remarks>
+Counters that cannot be opened, because the kernel forbids it or the CPU lacks
+the event, read as -1; the others still work. Counts are scaled up when the
+kernel had to multiplex the counters. Only user-space events are counted.
+Outside Linux every counter reads as -1.
+</remarks>
+*/
+class PerfCounters
+{
+public:
+    /**
+    <summary>
+    Constructor for the PerfCounters class. Opens and starts the counters for the calling thread.
+    </summary>
+    */
+    PerfCounters();
+
+    /**
+    <summary>
+    Destructor for the PerfCounters class. Closes the counters.
+    </summary>
+    */
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /**
+    <summary>
+    Tells whether at least one counter could be opened.
+    </summary>
+    <returns>True if some counter works.</returns>
+    */
+    bool isAvailable() const;
+
+    /**
+    <summary>
+    Gets the reason the first counter that failed could not be opened.
+    </summary>
+    <returns>The error message, empty if every counter was opened.</returns>
+    */
+    const std::string &getError() const { return error; }
+
+    /**
+    <summary>
+    Reads the counters.
+    </summary>
+    <returns>The counts since the counters were opened.</returns>
+    */
+    PerfSample read() const;
+
+    /**
+    <summary>
+    Gets the CSV header of the columns written by PerfSample::toColumns().
+    </summary>
+    <returns>The column names, each followed by a comma.</returns>
+    */
+    static std::string csvHeader();
+
+    /**
+    <summary>
+    Gets the name of a counter.
+    </summary>
+    <param name="event">The index of the counter in a PerfSample.</param>
+    <returns>The name.</returns>
+    */
+    static const char *eventName(int event);
+
+private:
+    int fds[PerfSample::NUM_EVENTS];
+    std::string error;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include <vector>
+
+/**
+<summary>
+Races several differently configured CdclSolvers on one formula, one thread
+each. The first to finish wins and interrupts the others. Unless disabled, the
+workers share short, low-LBD learned clauses through a ClauseExchange.
+</summary>
+<remarks>
+In deterministic mode the workers instead run in rounds of a fixed number of
+conflicts separated by a barrier. Learned clauses are collected per worker and
+handed out, in worker order, only at the barrier, and the lowest-numbered worker
+that finished in a round wins. The winner, the model and every counter then
+depend only on the formula and the number of workers, not on thread timing.
+</remarks>
+*/
+class PortfolioSolver
+{
+public:
+    /**
+    <summary>
+    Constructor for the PortfolioSolver class.
+    </summary>
+    <param name="formula">The Boolean formula to be solved.</param>
+    <param name="num_workers">The number of solver threads.</param>
+    <param name="share_clauses">Whether the workers exchange learned clauses.</param>
+    */
+    PortfolioSolver(const BooleanFormula &formula, int num_workers, bool share_clauses = true);
+
+    /**
+    <summary>
+    Attempts to solve the formula.
+    </summary>
+    <returns>True if a solution is found, otherwise false.</returns>
+    */
+    bool solve();
+
+    /**
+    <summary>
+    Binds the worker threads to CPUs, one each in turn; each worker then builds its solver on its own CPU.
+    </summary>
+    <param name="cpus">The CPUs; empty, the default, leaves the threads unbound.</param>
+    */
+    void setCpus(const std::vector<int> &cpus) { this->cpus = cpus; }
+
+    /**
+    <summary>
+    Makes the search reproducible by running it in barrier-delimited rounds.
+    </summary>
+    <param name="round_conflicts">The conflicts of each worker per round; 0, the default, races the workers freely.</param>
+    */
+    void setDeterministic(long long round_conflicts) { this->round_conflicts = round_conflicts; }
+
+    /**
+    <summary>
+    Sets the conflicts before each worker's first inprocessing.
+    </summary>
+    <param name="conflicts">The conflicts; 0 disables inprocessing.</param>
+    */
+    void setInprocessInterval(int conflicts) { inprocess_interval = conflicts; }
+
+    /**
+    <summary>
+    Gets the number of rounds of a deterministic search.
+    </summary>
+    <returns>The number of rounds; 0 if the search was not deterministic.</returns>
+    */
+    unsigned long long getNumRounds() const { return num_rounds; }
+
+    /**
+    <summary>
+    Gets the model of the winning worker.
+    </summary>
+    <returns>One BoolValue per variable; UNASSIGNED throughout if unsatisfiable.</returns>
+    */
+    const std::vector<BoolValue> &getAssignment() const { return assignment; }
+
+    /**
+    <summary>
+    Gets the worker that finished first.
+    </summary>
+    <returns>The worker index.</returns>
+    */
+    int getWinner() const { return winner; }
+
+    /**
+    <summary>
+    Gets the number of conflicts of all workers.
+    </summary>
+    <returns>The total number of conflicts.</returns>
+    */
+    unsigned long long getNumConflicts() const { return num_conflicts; }
+
+    /**
+    <summary>
+    Gets the number of decisions of all workers.
+    </summary>
+    <returns>The total number of decisions.</returns>
+    */
+    unsigned long long getNumDecisions() const { return num_decisions; }
+
+    /**
+    <summary>
+    Gets the number of propagations of all workers.
+    </summary>
+    <returns>The total number of propagations.</returns>
+    */
+    unsigned long long getNumPropagations() const { return num_propagations; }
+
+    /**
+    <summary>
+    Gets the number of clauses the workers published to the exchange.
+    </summary>
+    <returns>The total number of exported clauses.</returns>
+    */
+    unsigned long long getNumExportedClauses() const { return num_exported; }
+
+    /**
+    <summary>
+    Gets the number of clauses the workers took from the exchange.
+    </summary>
+    <returns>The total number of imported clauses.</returns>
+    */
+    unsigned long long getNumImportedClauses() const { return num_imported; }
+
+private:
+    const BooleanFormula &formula;
+    int num_workers;
+    bool share_clauses;
+    std::vector<int> cpus;
+    long long round_conflicts = 0;
+    int inprocess_interval = 2000;
+    std::vector<BoolValue> assignment;
+    int winner = -1;
+
+    unsigned long long num_conflicts = 0;
+    unsigned long long num_decisions = 0;
+    unsigned long long num_propagations = 0;
+    unsigned long long num_exported = 0;
+    unsigned long long num_imported = 0;
+    unsigned long long num_rounds = 0;
+};
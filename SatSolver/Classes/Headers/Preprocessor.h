@@ -0,0 +1,153 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include <vector>
+
+/**
+<summary>
+Simplifies a formula before search using its binary implication graph:
+top-level unit propagation, substitution of equivalent literals found as
+strongly connected components, and failed-literal probing that also adds
+hyper-binary resolvents. Models of the simplified formula are extended back
+to the original variables.
+</summary>
+<remarks>
+Variables keep their numbers. Fixed and substituted variables no longer occur
+in the simplified formula; extendModel() gives them their values.
+</remarks>
+*/
+class Preprocessor
+{
+public:
+    /**
+    <summary>
+    Constructor for the Preprocessor class.
+    </summary>
+    <param name="formula">The Boolean formula to simplify; it is not modified.</param>
+    */
+    Preprocessor(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Runs rounds of simplification until nothing changes or the round limit is reached.
+    </summary>
+    <returns>False if the formula was found unsatisfiable, otherwise true.</returns>
+    */
+    bool simplify();
+
+    /**
+    <summary>
+    Builds the simplified formula.
+    </summary>
+    <returns>The remaining clauses, with the answer of the original formula.</returns>
+    */
+    BooleanFormula getSimplifiedFormula() const;
+
+    /**
+    <summary>
+    Extends a model of the simplified formula to a model of the original one.
+    </summary>
+    <param name="model">A model of the simplified formula; it may be shorter than the original variable count.</param>
+    <returns>One BoolValue per original variable, none of them UNASSIGNED.</returns>
+    */
+    std::vector<BoolValue> extendModel(const std::vector<BoolValue> &model) const;
+
+    /**
+    <summary>
+    Limits the clause visits spent on probing in each round.
+    </summary>
+    <param name="visits">The budget.</param>
+    */
+    void setProbeBudget(unsigned long long visits) { probe_budget = visits; }
+
+    /**
+    <summary>
+    Gets the number of variables fixed at the top level.
+    </summary>
+    <returns>The number of fixed variables.</returns>
+    */
+    int getNumFixed() const { return num_fixed; }
+
+    /**
+    <summary>
+    Gets the number of variables replaced by an equivalent literal.
+    </summary>
+    <returns>The number of substituted variables.</returns>
+    */
+    int getNumSubstituted() const { return static_cast<int>(substitution_order.size()); }
+
+    /**
+    <summary>
+    Gets the number of literals whose probe ended in a conflict.
+    </summary>
+    <returns>The number of failed literals.</returns>
+    */
+    int getNumFailedLiterals() const { return num_failed_literals; }
+
+    /**
+    <summary>
+    Gets the number of hyper-binary resolvents added.
+    </summary>
+    <returns>The number of resolvents.</returns>
+    */
+    int getNumHyperBinaryResolvents() const { return num_hyper_binary; }
+
+private:
+    int num_vars;
+    char answer;
+    bool consistent = true;
+    std::vector<std::vector<int>> clauses; // Internal literals 2 * var + sign; empty once removed
+    std::vector<signed char> fixed;        // 1 TRUE, -1 FALSE, 0 free
+    std::vector<int> substitution;         // Literal equal to the variable's positive literal, -1 if none
+    std::vector<int> substitution_order;
+    unsigned long long probe_budget = 20000000;
+
+    int num_fixed = 0;
+    int num_failed_literals = 0;
+    int num_hyper_binary = 0;
+
+    /**
+    <summary>
+    Gets the top-level value of an internal literal.
+    </summary>
+    <param name="lit">The literal.</param>
+    <returns>1 if TRUE, -1 if FALSE, 0 if free.</returns>
+    */
+    int value(int lit) const { return (lit & 1) ? -fixed[lit >> 1] : fixed[lit >> 1]; }
+
+    /**
+    <summary>
+    Fixes a literal TRUE at the top level.
+    </summary>
+    <param name="lit">The literal.</param>
+    */
+    void fix(int lit);
+
+    /**
+    <summary>
+    Propagates the fixed literals and unit clauses, then removes satisfied
+    clauses and false literals.
+    </summary>
+    <returns>True if some variable was fixed.</returns>
+    */
+    bool propagateUnits();
+
+    /**
+    <summary>
+    Finds the strongly connected components of the binary implication graph and
+    replaces every literal by the representative of its component.
+    </summary>
+    <returns>True if some variable was substituted.</returns>
+    */
+    bool substituteEquivalences();
+
+    /**
+    <summary>
+    Probes both polarities of the variables in binary clauses. Failed literals
+    and literals implied by both polarities are fixed, and clauses that became
+    unit under a probe give hyper-binary resolvents.
+    </summary>
+    <returns>True if a literal was fixed or a resolvent added.</returns>
+    */
+    bool probeLiterals();
+};
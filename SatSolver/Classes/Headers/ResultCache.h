@@ -0,0 +1,106 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// A 128-bit hash of a formula that does not depend on the order of its clauses or literals.
+struct FormulaFingerprint
+{
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const FormulaFingerprint &other) const { return high == other.high && low == other.low; }
+
+    struct Hash
+    {
+        size_t operator()(const FormulaFingerprint &fingerprint) const { return static_cast<size_t>(fingerprint.low); }
+    };
+};
+
+/**
+<summary>
+Remembers the verdict and model of solved formulas by fingerprint, optionally
+in a file that persists between runs. A cached model is checked against the
+formula before it is returned, so a stale or colliding entry is never reused
+for a satisfiable formula.
+</summary>
+<remarks>
+The file holds one line per entry: the fingerprint in hex, the variable and
+clause counts, S or U, and the model as one character per variable ('1', '0'
+or '-' for unassigned). Entries are appended as they are stored. Safe to use
+from several threads.
+</remarks>
+*/
+class ResultCache
+{
+public:
+    /**
+    <summary>
+    Computes the fingerprint of a formula. Each clause is hashed as the multiset
+    of its literals and the formula as the multiset of its clause hashes, so
+    reordering clauses or the literals within them gives the same fingerprint.
+    </summary>
+    <param name="formula">The formula.</param>
+    <returns>The fingerprint.</returns>
+    */
+    static FormulaFingerprint fingerprint(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Constructor for the ResultCache class. Loads the entries already in the file.
+    </summary>
+    <param name="path">The cache file; it is created if missing.</param>
+    */
+    explicit ResultCache(const std::string &path);
+
+    /**
+    <summary>
+    Looks up the result of a formula.
+    </summary>
+    <param name="formula">The formula.</param>
+    <param name="key">The fingerprint of the formula.</param>
+    <param name="satisfiable">Receives the cached verdict.</param>
+    <param name="model">Receives the cached model, one value per variable.</param>
+    <returns>True if an entry matches the formula and, when satisfiable, its model satisfies every clause.</returns>
+    */
+    bool lookup(const BooleanFormula &formula, const FormulaFingerprint &key, bool &satisfiable, std::vector<BoolValue> &model);
+
+    /**
+    <summary>
+    Stores the result of a formula and appends it to the file.
+    </summary>
+    <param name="formula">The formula.</param>
+    <param name="key">The fingerprint of the formula.</param>
+    <param name="satisfiable">The verdict.</param>
+    <param name="model">The model when satisfiable.</param>
+    */
+    void store(const BooleanFormula &formula, const FormulaFingerprint &key, bool satisfiable, const std::vector<BoolValue> &model);
+
+    /**
+    <summary>
+    Gets the number of lookups answered from the cache.
+    </summary>
+    <returns>The number of hits.</returns>
+    */
+    unsigned long long getNumHits() const { return num_hits; }
+
+private:
+    struct Entry
+    {
+        int num_vars;
+        int num_clauses;
+        bool satisfiable;
+        std::vector<BoolValue> model;
+    };
+
+    std::mutex mtx;
+    std::unordered_map<FormulaFingerprint, Entry, FormulaFingerprint::Hash> entries;
+    std::ofstream file;
+    unsigned long long num_hits = 0;
+};
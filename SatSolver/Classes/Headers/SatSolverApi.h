@@ -0,0 +1,160 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * C interface of libsatsolver, for embedding the CDCL engine in other
+ * programs without spawning a process or writing files.
+ *
+ * Literals are DIMACS integers: variable v is v, its negation -v. Clauses are
+ * passed as zero-terminated runs in a caller-owned int32_t buffer, read in
+ * place. The solver is incremental: clauses may be added between solves, and
+ * each solve may take assumptions that hold for that solve only.
+ *
+ * A handle must not be used from two threads at once, except that
+ * satsolver_interrupt may be called while another thread is in satsolver_solve.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Bumped whenever a function or structure changes incompatibly.
+#define SATSOLVER_API_VERSION 1
+
+// Results of satsolver_solve, as in IPASIR.
+#define SATSOLVER_UNKNOWN 0
+#define SATSOLVER_SAT 10
+#define SATSOLVER_UNSAT 20
+#define SATSOLVER_ERROR (-1)
+
+// Largest variable a literal may name; a literal beyond it is invalid input.
+#define SATSOLVER_MAX_VARIABLE (1 << 25)
+
+typedef struct satsolver satsolver;
+
+// Limits of one solve; a field at zero or below means no limit.
+typedef struct satsolver_limits
+{
+    int64_t conflicts; // Conflicts the solve may take
+    double seconds;    // Wall-clock time the solve may take
+} satsolver_limits;
+
+// Totals since the handle was created.
+typedef struct satsolver_stats
+{
+    int32_t variables;
+    uint64_t clauses;            // Clauses added, before simplification
+    uint64_t solves;
+    uint64_t decisions;
+    uint64_t conflicts;
+    uint64_t propagations;
+    uint64_t restarts;
+    uint64_t learned_clauses;
+    uint64_t solve_microseconds; // Time spent in satsolver_solve
+} satsolver_stats;
+
+/**
+<summary>
+Gets the version of the interface the library was built with.
+</summary>
+<returns>SATSOLVER_API_VERSION of the library.</returns>
+*/
+int satsolver_api_version(void);
+
+/**
+<summary>
+Creates an empty solver.
+</summary>
+<returns>The handle, or NULL if memory ran out.</returns>
+*/
+satsolver *satsolver_create(void);
+
+/**
+<summary>
+Destroys a solver.
+</summary>
+<param name="solver">The handle; NULL is ignored.</param>
+*/
+void satsolver_destroy(satsolver *solver);
+
+/**
+<summary>
+Adds clauses from a buffer of zero-terminated literal runs.
+</summary>
+<param name="solver">The handle.</param>
+<param name="literals">The literals; the buffer is not kept.</param>
+<param name="count">The number of entries in the buffer.</param>
+<returns>1 while the clauses may be satisfiable, 0 once they are known not to be, SATSOLVER_ERROR on failure.</returns>
+<remarks>
+A run left unterminated at the end of the buffer is continued by the next call,
+so a large formula can be streamed in pieces of any size. A buffer holding a
+literal beyond SATSOLVER_MAX_VARIABLE is rejected whole with SATSOLVER_ERROR.
+</remarks>
+*/
+int satsolver_add_literals(satsolver *solver, const int32_t *literals, size_t count);
+
+/**
+<summary>
+Solves the clauses added so far.
+</summary>
+<param name="solver">The handle.</param>
+<param name="assumptions">Literals assumed TRUE for this solve only, nonzero and within SATSOLVER_MAX_VARIABLE; may be NULL when count is 0.</param>
+<param name="count">The number of assumptions.</param>
+<param name="limits">The limits of the solve, or NULL for none.</param>
+<returns>SATSOLVER_SAT, SATSOLVER_UNSAT, SATSOLVER_UNKNOWN when a limit or an interrupt stopped it, or SATSOLVER_ERROR.</returns>
+*/
+int satsolver_solve(satsolver *solver, const int32_t *assumptions, size_t count, const satsolver_limits *limits);
+
+/**
+<summary>
+Stops a solve running on another thread; it returns SATSOLVER_UNKNOWN.
+</summary>
+<param name="solver">The handle.</param>
+*/
+void satsolver_interrupt(satsolver *solver);
+
+/**
+<summary>
+Gets the value of a variable in the model of the last satisfiable solve.
+</summary>
+<param name="solver">The handle.</param>
+<param name="variable">The 1-based variable.</param>
+<returns>The variable if it is TRUE, its negation if it is FALSE, 0 if there is no model or the variable is unknown.</returns>
+*/
+int32_t satsolver_value(const satsolver *solver, int32_t variable);
+
+/**
+<summary>
+Copies the model of the last satisfiable solve.
+</summary>
+<param name="solver">The handle.</param>
+<param name="model">Receives satsolver_value() of variables 1, 2, ... up to the capacity.</param>
+<param name="capacity">The number of entries the buffer holds.</param>
+<returns>The number of variables in the model, 0 if there is none; at most the capacity is written.</returns>
+*/
+size_t satsolver_model(const satsolver *solver, int32_t *model, size_t capacity);
+
+/**
+<summary>
+Tells whether an assumption was part of the refutation of the last unsatisfiable solve.
+</summary>
+<param name="solver">The handle.</param>
+<param name="literal">An assumption of that solve.</param>
+<returns>1 if it was, otherwise 0.</returns>
+*/
+int satsolver_failed(const satsolver *solver, int32_t literal);
+
+/**
+<summary>
+Reads the statistics of a solver.
+</summary>
+<param name="solver">The handle.</param>
+<param name="stats">Receives the totals.</param>
+*/
+void satsolver_get_stats(const satsolver *solver, satsolver_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include "EngineSelector.h"
+#include "SolverWorkspace.h"
+#include <vector>
+#include <string>
+
+/**
+<summary>
+How a formula is solved when nothing but its verdict and model is asked for:
+the engine and its settings, shared by the batch, the daemon and the
+distributed workers.
+</summary>
+*/
+struct EngineOptions
+{
+    std::string name = "auto";       // auto|backtrack|twosat|cdcl|portfolio|lookahead; auto picks one per formula
+    EngineThresholds thresholds;     // Of the automatic selection
+    int portfolio_workers = 4;       // Solver threads of the portfolio
+    bool share_clauses = true;       // Whether portfolio workers exchange learned clauses
+    long long round_conflicts = 0;   // Conflicts per deterministic portfolio round; 0 races the workers
+    int inprocess_interval = 2000;   // Conflicts before the first CDCL inprocessing; 0 disables it
+    std::string checkpoint_path;     // Backtracking snapshots; empty takes none
+    double checkpoint_interval = 60; // Minimum seconds between snapshots
+    bool verbose = false;            // Print the models the backtracking engine finds on stdout
+
+    /**
+    <summary>
+    Formats the options as KEY=VALUE lines, thresholds included, for sending to a worker.
+    </summary>
+    <returns>The options as text.</returns>
+    <remarks>
+    Checkpoints and verbosity stay with the process that sets them and are not sent.
+    </remarks>
+    */
+    std::string toText() const;
+
+    /**
+    <summary>
+    Parses options formatted by toText().
+    </summary>
+    <param name="text">The KEY=VALUE lines.</param>
+    <param name="options">Receives the options; keys not in the text keep their values.</param>
+    <returns>True if every line was valid, otherwise false.</returns>
+    */
+    static bool fromText(const std::string &text, EngineOptions &options);
+};
+
+/**
+<summary>
+The outcome and statistics of solving one formula, in a form that can be sent
+over a socket as a single comma-separated row.
+</summary>
+*/
+struct SolveReport
+{
+    bool satisfiable = false;
+    long long elapsed_us = 0;
+    unsigned long long decisions = 0;
+    unsigned long long backtracks = 0;        // Conflicts, for the CDCL engines
+    unsigned long long unit_propagations = 0;
+    std::vector<BoolValue> assignment;
+    std::string details;                      // Log lines naming the engine and its statistics; not part of the row
+
+    /**
+    <summary>
+    Solves a formula with the engine the options name, or the one picked from its features, and records the outcome.
+    </summary>
+    <param name="formula">The formula to solve.</param>
+    <param name="options">The engine and its settings.</param>
+    <param name="workspace">The backtracking engine's storage; nullptr uses one kept per calling thread.</param>
+    <param name="cpus">The CPUs portfolio threads are bound to; empty leaves them unbound.</param>
+    <returns>The report of the solve.</returns>
+    */
+    static SolveReport solve(const BooleanFormula &formula, const EngineOptions &options = EngineOptions(),
+                             SolverWorkspace *workspace = nullptr, const std::vector<int> &cpus = std::vector<int>());
+
+    /**
+    <summary>
+    Formats the report as "S|U,elapsed_us,decisions,backtracks,unit_propagations,assignment...",
+    with the assignment in the CSV convention (1, 0, -1 for unassigned).
+    </summary>
+    <returns>The report as a row.</returns>
+    */
+    std::string toRow() const;
+
+    /**
+    <summary>
+    Parses a row produced by toRow().
+    </summary>
+    <param name="row">The row to parse.</param>
+    <param name="report">Receives the parsed report.</param>
+    <returns>True if the row was well formed, otherwise false.</returns>
+    */
+    static bool fromRow(const std::string &row, SolveReport &report);
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include "ThreadPool.h"
+#include "ResultCache.h"
+#include "SolveReport.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+/**
+<summary>
+Long-running solver daemon listening on a Unix domain socket.
+</summary>
+<remarks>
+Every message is a FrameIO frame. A request payload is a 32-bit request id
+(network byte order), one encoding byte and the formula:
+  'D' - text in the .cnf format of this repository or plain DIMACS; may hold several formulas.
+  'B' - one formula as 32-bit signed literals in network byte order, each clause terminated by 0.
+For every formula of a request the server sends one response frame holding the
+request id followed by the text row
+  index/count,S|U,elapsed_us,decisions,backtracks,unit_propagations,assignment...
+where the assignment uses the CSV convention (1, 0, -1 for unassigned). A request
+that cannot be parsed is answered with the row "0/0,E,message".
+Clients may pipeline requests; responses to different requests can arrive out of
+order and are matched by request id. Each connection has a bounded number of
+requests in flight; once it is reached the server stops reading that socket,
+which pushes back on the client through the socket buffers.
+</remarks>
+*/
+class SolverServer
+{
+public:
+    /**
+    <summary>
+    Constructor for the SolverServer class. Starts the worker pool.
+    </summary>
+    <param name="socket_path">The filesystem path of the Unix domain socket.</param>
+    <param name="num_threads">The number of solver threads kept warm in the pool.</param>
+    <param name="max_in_flight">The maximum number of requests per connection being solved at once.</param>
+    <param name="cache">Results to reuse for resubmitted formulas, or nullptr; it must outlive the server.</param>
+    <param name="engine">The engine formulas are solved with.</param>
+    */
+    SolverServer(const std::string &socket_path, size_t num_threads, size_t max_in_flight, ResultCache *cache = nullptr,
+                 const EngineOptions &engine = EngineOptions());
+
+    /**
+    <summary>
+    Destructor for the SolverServer class. Stops serving and removes the socket file.
+    </summary>
+    */
+    ~SolverServer();
+
+    /**
+    <summary>
+    Binds the socket and accepts connections until requestStop() is called.
+    </summary>
+    <remarks>
+    Throws std::runtime_error if the socket cannot be created or bound.
+    </remarks>
+    */
+    void serve();
+
+    /**
+    <summary>
+    Asks serve() to return. Only performs async-signal-safe operations, so it
+    may be called from a signal handler.
+    </summary>
+    */
+    void requestStop();
+
+private:
+    struct Connection;
+
+    std::string socket_path;
+    size_t max_in_flight;
+    ResultCache *cache;
+    EngineOptions engine;
+    int listen_fd = -1;
+    std::atomic<bool> running;
+    ThreadPool pool;
+    std::mutex connections_mtx;
+    std::condition_variable readers_done;
+    std::vector<std::weak_ptr<Connection>> connections;
+    size_t active_readers = 0; // Reader threads are detached and counted instead of joined
+
+    /**
+    <summary>
+    Reads request frames from a connection and queues them on the pool.
+    </summary>
+    <param name="connection">The connection to serve.</param>
+    */
+    void handleConnection(std::shared_ptr<Connection> connection);
+
+    /**
+    <summary>
+    Parses and solves one request, streaming a response frame per formula.
+    </summary>
+    <param name="connection">The connection the request arrived on.</param>
+    <param name="payload">The request payload.</param>
+    */
+    void handleRequest(const std::shared_ptr<Connection> &connection, const std::string &payload);
+};
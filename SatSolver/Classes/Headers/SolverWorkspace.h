@@ -0,0 +1,47 @@
+#pragma once
+#include "BoolValue.h"
+#include "ClauseStore.h"
+#include <vector>
+#include <cstdint>
+
+/**
+<summary>
+Per-solve storage owned by a worker thread and reused for every formula it
+solves. Resetting clears the contents but keeps the capacity, so a worker
+going through a batch of small formulas stops allocating once its buffers
+have grown to the largest formula seen.
+</summary>
+*/
+struct SolverWorkspace
+{
+    std::vector<BoolValue> assignment;
+    std::vector<int> activity;
+    std::vector<char> positive_seen;
+    std::vector<char> negative_seen;
+    ClauseStore clause_store;
+
+    // Occurrence index and per-clause counters kept up to date along the search path
+    std::vector<int> clause_literals;        // Literals as 2 * (variable - 1) + negative, clause after clause
+    std::vector<uint32_t> clause_starts;     // Clause i spans [clause_starts[i], clause_starts[i + 1])
+    std::vector<uint32_t> occurrence_starts; // Literal l occurs in occurrences[occurrence_starts[l]] onwards
+    std::vector<uint32_t> occurrences;       // Clause indices, grouped by literal
+    std::vector<int> true_counts;            // Literals assigned TRUE in each clause
+    std::vector<int> false_counts;           // Literals assigned FALSE in each clause
+    std::vector<int> evaluated_counts;       // Literals Literal::evaluate() finds TRUE, as decisions rank by
+
+    /**
+    <summary>
+    Prepares the workspace for a new formula.
+    </summary>
+    <param name="num_variables">The number of variables of the formula.</param>
+    <param name="clauses">The clauses of the formula.</param>
+    */
+    void reset(int num_variables, const std::vector<Clause> &clauses)
+    {
+        assignment.assign(num_variables, BoolValue::UNASSIGNED);
+        activity.assign(num_variables, 0);
+        positive_seen.assign(num_variables, 0);
+        negative_seen.assign(num_variables, 0);
+        clause_store.assign(clauses);
+    }
+};
@@ -0,0 +1,215 @@
+#pragma once
+#include "BooleanFormula.h"
+#include <vector>
+#include <cstdint>
+
+/**
+<summary>
+Detects symmetries of a formula and breaks them with lex-leader clauses before
+search. The formula becomes a colored graph, with one vertex per literal, one per
+clause, and edges from each clause to its literals and from each literal to its
+negation. Automorphism generators of that graph are found by partition
+refinement with individualization, and each generator adds clauses that keep
+only the assignments that are lexicographically smallest under it.
+</summary>
+<remarks>
+Every literal vertex shares one color, so symmetries may map a variable to the
+negation of another. Breaking keeps at least one model of every orbit, so a
+satisfiable formula stays satisfiable and its models are models of the original.
+</remarks>
+<remarks>
+The search finds a generating set of the whole group when it finishes within its
+node budget; otherwise the generators found so far are still symmetries and are
+broken all the same.
+</remarks>
+*/
+class SymmetryBreaker
+{
+public:
+    /**
+    <summary>
+    Constructor for the SymmetryBreaker class.
+    </summary>
+    <param name="formula">The Boolean formula; it is not modified and must outlive the breaker.</param>
+    */
+    SymmetryBreaker(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Searches for generators of the formula's symmetry group.
+    </summary>
+    <returns>The number of generators found.</returns>
+    */
+    int detect();
+
+    /**
+    <summary>
+    Builds the formula with the lex-leader clauses of every generator added.
+    </summary>
+    <param name="num_vars">The variable count of the original formula; auxiliary variables are numbered after it.</param>
+    <returns>The clauses of the formula and the breaking clauses, with the answer of the formula.</returns>
+    */
+    BooleanFormula getBrokenFormula(int num_vars) const;
+
+    /**
+    <summary>
+    Limits the refinements the automorphism search may run.
+    </summary>
+    <param name="nodes">The budget.</param>
+    */
+    void setSearchBudget(unsigned long long nodes) { search_budget = nodes; }
+
+    /**
+    <summary>
+    Limits the variables of each lex-leader constraint, taken in variable order.
+    </summary>
+    <param name="vars">The most variables compared per generator.</param>
+    */
+    void setMaxBreakingSize(int vars) { max_breaking_size = vars; }
+
+    /**
+    <summary>
+    Gets the number of generators found.
+    </summary>
+    <returns>The number of generators.</returns>
+    */
+    int getNumGenerators() const { return static_cast<int>(generators.size()); }
+
+    /**
+    <summary>
+    Gets the base-10 logarithm of the size of the group the generators generate.
+    </summary>
+    <returns>The logarithm; exact only when the search finished.</returns>
+    */
+    double getGroupSizeLog10() const { return group_size_log10; }
+
+    /**
+    <summary>
+    Gets the number of refinements the search ran.
+    </summary>
+    <returns>The number of search nodes.</returns>
+    */
+    unsigned long long getNumSearchNodes() const { return search_nodes; }
+
+    /**
+    <summary>
+    Tells whether the search stopped at its budget before finishing.
+    </summary>
+    <returns>True if the budget ran out, otherwise false.</returns>
+    */
+    bool isBudgetExhausted() const { return budget_exhausted; }
+
+    /**
+    <summary>
+    Gets the number of clauses getBrokenFormula() adds.
+    </summary>
+    <returns>The number of breaking clauses.</returns>
+    */
+    int getNumBreakingClauses() const;
+
+    /**
+    <summary>
+    Gets the number of auxiliary variables getBrokenFormula() adds.
+    </summary>
+    <returns>The number of auxiliary variables.</returns>
+    */
+    int getNumAuxiliaryVariables() const;
+
+private:
+    // An ordered partition of the vertices: cells are ranges of lab
+    struct Partition
+    {
+        std::vector<int> lab;      // Vertices, cell by cell
+        std::vector<int> pos;      // Position of each vertex in lab
+        std::vector<int> cell_of;  // Start of the cell holding each vertex
+        std::vector<int> cell_end; // One past the end of the cell starting at each position
+        int num_cells = 0;
+    };
+
+    const BooleanFormula &formula;
+    std::vector<std::vector<int>> clauses;   // Deduplicated, sorted DIMACS literals
+    std::vector<int> variables;              // Variable of literal vertices 2i and 2i + 1, ascending
+    std::vector<int> variable_index;         // Index into variables of each variable, -1 if it occurs nowhere
+    std::vector<std::vector<int>> adjacency; // Sorted neighbours of each vertex
+    int num_literal_vertices = 0;
+    std::vector<std::vector<int>> generators; // Image of each variable's positive literal, as DIMACS literals
+
+    unsigned long long search_budget = 200000;
+    unsigned long long search_nodes = 0;
+    bool budget_exhausted = false;
+    double group_size_log10 = 0;
+    int max_breaking_size = 100;
+
+    // Scratch of refine()
+    std::vector<int> counts;
+    std::vector<int> touched;
+    std::vector<int> queue;
+    std::vector<char> queued;       // By cell start
+    std::vector<int> split_cells;
+    std::vector<int> fragment_starts;
+    std::vector<int> cell_back;     // By cell start: where the touched vertices of the cell begin
+
+    /**
+    <summary>
+    Gets the vertex of a DIMACS literal.
+    </summary>
+    <param name="literal">The literal.</param>
+    <returns>The vertex, or -1 if its variable occurs in no clause.</returns>
+    */
+    int vertexOf(int literal) const;
+
+    /**
+    <summary>
+    Refines a partition until every cell has the same number of neighbours in each cell.
+    </summary>
+    <param name="partition">The partition to refine.</param>
+    <param name="splitters">The cells whose neighbours may not be counted yet.</param>
+    <returns>A hash of the splits made, equal for two partitions related by an automorphism.</returns>
+    */
+    uint64_t refine(Partition &partition, const std::vector<int> &splitters);
+
+    /**
+    <summary>
+    Moves a vertex into a cell of its own at the start of its cell and refines.
+    </summary>
+    <param name="partition">The partition.</param>
+    <param name="vertex">The vertex, in a cell of two or more.</param>
+    <returns>The hash of the refinement.</returns>
+    */
+    uint64_t individualize(Partition &partition, int vertex);
+
+    /**
+    <summary>
+    Searches the right partition's subtree for a leaf matching the left path.
+    </summary>
+    <param name="right">The right partition after individualizing at the given level.</param>
+    <param name="level">The level of the last individualization.</param>
+    <param name="left_leaf">The discrete partition at the end of the left path.</param>
+    <param name="targets">The cell the left path individualized at each level.</param>
+    <param name="path">The vertex the left path individualized at each level.</param>
+    <param name="hashes">The refinement hash of the left path after each level.</param>
+    <param name="automorphism">Receives the automorphism found.</param>
+    <returns>True if an automorphism was found.</returns>
+    */
+    bool searchRight(const Partition &right, size_t level, const Partition &left_leaf, const std::vector<int> &targets,
+                     const std::vector<int> &path, const std::vector<uint64_t> &hashes, std::vector<int> &automorphism);
+
+    /**
+    <summary>
+    Tells whether a vertex permutation maps every edge to an edge.
+    </summary>
+    <param name="permutation">The image of each vertex.</param>
+    <returns>True if it is an automorphism of the graph.</returns>
+    */
+    bool isAutomorphism(const std::vector<int> &permutation) const;
+
+    /**
+    <summary>
+    Writes the lex-leader clauses of one generator.
+    </summary>
+    <param name="generator">The image of each variable's positive literal.</param>
+    <param name="next_variable">The next free auxiliary variable; advanced past those used.</param>
+    <param name="output">Receives the clauses as DIMACS literals.</param>
+    */
+    void breakGenerator(const std::vector<int> &generator, int &next_variable, std::vector<std::vector<int>> &output) const;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+class ThreadPool
+{
+public:
+    /**
+    <summary>
+    Constructor for the ThreadPool class. Starts the worker threads, which stay
+    alive until the pool is destroyed.
+    </summary>
+    <param name="num_threads">The number of worker threads.</param>
+    <param name="max_queued">The maximum number of tasks waiting for a worker.</param>
+    */
+    ThreadPool(size_t num_threads, size_t max_queued);
+
+    /**
+    <summary>
+    Destructor for the ThreadPool class. Runs the tasks still queued and joins the workers.
+    </summary>
+    */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+    <summary>
+    Queues a task. Blocks while the queue is full so that producers are slowed
+    down to the rate at which workers finish tasks.
+    </summary>
+    <param name="task">The task to run on a worker thread.</param>
+    */
+    void submit(std::function<void()> task);
+
+    /**
+    <summary>
+    Gets the number of worker threads.
+    </summary>
+    <returns>The number of worker threads.</returns>
+    */
+    size_t size() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    size_t max_queued;
+    bool stopping = false;
+
+    /**
+    <summary>
+    Runs queued tasks until the pool is stopped and the queue is empty.
+    </summary>
+    */
+    void workerLoop();
+};
@@ -0,0 +1,168 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+<summary>
+Records timed trace events into a ring buffer per thread and exports them in
+the Chrome trace JSON format, which Perfetto and chrome://tracing display as a
+timeline per thread. While tracing is disabled a trace point costs one branch.
+</summary>
+<remarks>
+Event names must be string literals: only the pointer is stored. A thread
+writes only to its own buffer, so recording takes no lock; once a buffer is
+full the oldest events are overwritten. Call enable() before the traced
+threads start and writeChromeTrace() after they have stopped.
+</remarks>
+*/
+class Tracer
+{
+public:
+    /**
+    <summary>
+    Turns tracing on.
+    </summary>
+    <param name="events_per_thread">The capacity of each thread's ring buffer.</param>
+    */
+    static void enable(size_t events_per_thread);
+
+    /**
+    <summary>
+    Tells whether tracing is on.
+    </summary>
+    <returns>True if trace points record events.</returns>
+    */
+    static bool isEnabled() { return enabled; }
+
+    /**
+    <summary>
+    Names the calling thread in the exported trace.
+    </summary>
+    <param name="name">The name of the thread.</param>
+    */
+    static void setThreadName(const std::string &name);
+
+    /**
+    <summary>
+    Gets the time since tracing was enabled.
+    </summary>
+    <returns>The time in nanoseconds.</returns>
+    */
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    /**
+    <summary>
+    Records an event on the calling thread.
+    </summary>
+    <param name="name">The name of the event, a string literal.</param>
+    <param name="start">The start time from now().</param>
+    <param name="duration">The duration in nanoseconds, or -1 for an instant event.</param>
+    <param name="arg">A value shown with the event, or -1 for none.</param>
+    */
+    static void record(const char *name, int64_t start, int64_t duration, long long arg = -1);
+
+    /**
+    <summary>
+    Records an instant event on the calling thread, if tracing is on.
+    </summary>
+    <param name="name">The name of the event, a string literal.</param>
+    <param name="arg">A value shown with the event, or -1 for none.</param>
+    */
+    static void instant(const char *name, long long arg = -1)
+    {
+        if (enabled)
+        {
+            record(name, now(), -1, arg);
+        }
+    }
+
+    /**
+    <summary>
+    Writes the events of every thread as Chrome trace JSON.
+    </summary>
+    <param name="path">The file to write.</param>
+    <returns>True if the file was written, otherwise false.</returns>
+    */
+    static bool writeChromeTrace(const std::string &path);
+
+private:
+    struct Event
+    {
+        const char *name;
+        int64_t start;
+        int64_t duration;
+        long long arg;
+    };
+
+    struct ThreadBuffer
+    {
+        int id;
+        std::string name;
+        std::vector<Event> events; // Grows to the capacity, then is used as a ring
+        size_t next = 0;           // Slot overwritten next once the ring is full
+    };
+
+    static bool enabled;
+    static size_t capacity;
+    static std::chrono::steady_clock::time_point epoch;
+    static std::mutex registry_mtx;
+    static std::vector<std::shared_ptr<ThreadBuffer>> registry; // Outlives the threads it traces
+
+    /**
+    <summary>
+    Gets the calling thread's buffer, registering it on first use.
+    </summary>
+    <returns>The buffer.</returns>
+    */
+    static ThreadBuffer &threadBuffer();
+};
+
+/**
+<summary>
+Records a complete event covering the lifetime of the scope.
+</summary>
+*/
+class TraceScope
+{
+public:
+    /**
+    <summary>
+    Constructor for the TraceScope class. Starts the event if tracing is on.
+    </summary>
+    <param name="name">The name of the event, a string literal.</param>
+    <param name="arg">A value shown with the event, or -1 for none.</param>
+    */
+    explicit TraceScope(const char *name, long long arg = -1)
+        : name(Tracer::isEnabled() ? name : nullptr), arg(arg), start(this->name != nullptr ? Tracer::now() : 0)
+    {
+    }
+
+    /**
+    <summary>
+    Destructor for the TraceScope class. Records the event.
+    </summary>
+    */
+    ~TraceScope()
+    {
+        if (name != nullptr)
+        {
+            Tracer::record(name, start, Tracer::now() - start, arg);
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;
+    long long arg;
+    int64_t start;
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "BooleanFormula.h"
+#include "BoolValue.h"
+#include <vector>
+
+/**
+<summary>
+Decides formulas whose clauses have at most two literals in linear time, from
+the strongly connected components of the implication graph (Aspvall, Plass and
+Tarjan).
+</summary>
+<remarks>
+A clause (a or b) gives the implications not a -> b and not b -> a, and a unit
+clause (a) the implication not a -> a. The formula is unsatisfiable exactly when
+some variable shares a component with its negation. Otherwise each variable is
+set TRUE when its positive literal's component comes later in topological
+order than its negation's, which Tarjan's algorithm finds first.
+</remarks>
+*/
+class TwoSatSolver
+{
+public:
+    /**
+    <summary>
+    Constructor for the TwoSatSolver class.
+    </summary>
+    <param name="formula">The Boolean formula to be solved; no clause may have more than two literals.</param>
+    */
+    explicit TwoSatSolver(const BooleanFormula &formula);
+
+    /**
+    <summary>
+    Searches for a model.
+    </summary>
+    <returns>True if the formula is satisfiable, otherwise false.</returns>
+    */
+    bool solve();
+
+    /**
+    <summary>
+    Gets the model found by solve().
+    </summary>
+    <returns>One BoolValue per variable; UNASSIGNED throughout if the formula is unsatisfiable.</returns>
+    */
+    const std::vector<BoolValue> &getAssignment() const { return model; }
+
+    /**
+    <summary>
+    Gets the number of strongly connected components of the implication graph.
+    </summary>
+    <returns>The number of components found by solve().</returns>
+    */
+    int getNumComponents() const { return num_components; }
+
+private:
+    int num_vars = 0;
+    bool consistent = true;
+    std::vector<std::vector<int>> edges; // Implications out of each internal literal 2 * var + negative
+    std::vector<BoolValue> model;
+    int num_components = 0;
+};
@@ -0,0 +1,152 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+// A NUMA node and the CPUs of it this process may run on.
+struct NumaNode
+{
+    int id;
+    std::vector<int> cpus;
+    std::vector<int> distances; // To each node, by node id, as reported by the kernel
+};
+
+/**
+<summary>
+Places batch workers on the machine's NUMA nodes and hands them work: each node
+owns a contiguous range of the items, its workers take items from that range
+first and steal from the nearest other nodes once it is exhausted.
+</summary>
+<remarks>
+Workers are spread over the nodes in proportion to their CPUs and, when pinned,
+bound to one core each. Memory a pinned worker touches first, such as its
+workspace or a copy of its node's formulas, is then allocated on its node by the
+kernel's default first-touch policy.
+</remarks>
+<remarks>
+With a single node and no CPUs the placement is a plain shared counter, which is
+what an unpinned batch uses.
+</remarks>
+*/
+class WorkerPlacement
+{
+public:
+    /**
+    <summary>
+    Constructor for the WorkerPlacement class.
+    </summary>
+    <param name="nodes">The nodes to place workers on; at least one.</param>
+    <param name="num_workers">The number of workers.</param>
+    <param name="num_items">The number of items to hand out.</param>
+    */
+    WorkerPlacement(const std::vector<NumaNode> &nodes, int num_workers, size_t num_items);
+
+    /**
+    <summary>
+    Reads the NUMA nodes of the machine from sysfs.
+    </summary>
+    <param name="root">The sysfs node directory.</param>
+    <returns>The online nodes with CPUs this process may use; one node holding every allowed CPU if sysfs has none, and one without CPUs outside Linux.</returns>
+    */
+    static std::vector<NumaNode> detectNodes(const std::string &root = "/sys/devices/system/node");
+
+    /**
+    <summary>
+    Binds the calling thread to a set of CPUs.
+    </summary>
+    <param name="cpus">The CPUs; empty leaves the thread unbound.</param>
+    <returns>True if the thread was bound, otherwise false; always false outside Linux.</returns>
+    */
+    static bool pinCurrentThread(const std::vector<int> &cpus);
+
+    /**
+    <summary>
+    Binds the calling thread to the core of a worker.
+    </summary>
+    <param name="worker">The worker index.</param>
+    <returns>True if the thread was bound, otherwise false.</returns>
+    */
+    bool pin(int worker) const;
+
+    /**
+    <summary>
+    Takes the next item for a worker: from its own node's range, else from the nearest node with items left.
+    </summary>
+    <param name="worker">The worker index.</param>
+    <param name="item">Receives the item.</param>
+    <returns>False once every item has been handed out, otherwise true.</returns>
+    */
+    bool next(int worker, size_t &item);
+
+    /**
+    <summary>
+    Gets the node slot a worker is placed on.
+    </summary>
+    <param name="worker">The worker index.</param>
+    <returns>The index into the nodes passed to the constructor.</returns>
+    */
+    int getNode(int worker) const { return worker_nodes[worker]; }
+
+    /**
+    <summary>
+    Tells whether a worker is the first one placed on its node.
+    </summary>
+    <param name="worker">The worker index.</param>
+    <returns>True for exactly one worker of each node that has workers.</returns>
+    */
+    bool isNodeLeader(int worker) const { return worker == 0 || worker_nodes[worker - 1] != worker_nodes[worker]; }
+
+    /**
+    <summary>
+    Gets the range of items a node owns.
+    </summary>
+    <param name="node">The node slot.</param>
+    <returns>The first item and one past the last.</returns>
+    */
+    std::pair<size_t, size_t> getRange(int node) const { return {ranges[node].begin, ranges[node].end}; }
+
+    /**
+    <summary>
+    Gets the CPUs of a worker's node, starting with the worker's own core.
+    </summary>
+    <param name="worker">The worker index.</param>
+    <returns>The CPUs, for threads the worker starts; empty if the node lists none.</returns>
+    */
+    std::vector<int> getNodeCpus(int worker) const;
+
+    /**
+    <summary>
+    Gets the number of nodes that received workers.
+    </summary>
+    <returns>The number of nodes in use.</returns>
+    */
+    int getNumNodesUsed() const;
+
+    /**
+    <summary>
+    Gets the number of items workers took from other nodes' ranges.
+    </summary>
+    <returns>The number of stolen items.</returns>
+    */
+    size_t getNumStolen() const { return num_stolen.load(); }
+
+private:
+    // A node's share of the items; padded to keep cursors of different nodes off one cache line,
+    // since all workers of a node bump its cursor
+    struct NodeRange
+    {
+        size_t begin = 0;
+        size_t end = 0;
+        std::atomic<size_t> cursor{0};
+        char padding[64];
+    };
+
+    std::vector<NumaNode> nodes;
+    std::vector<int> worker_nodes;                 // Node slot of each worker, in ascending order
+    std::vector<int> worker_cpus;                  // Core of each worker, -1 if the node lists none
+    std::unique_ptr<NodeRange[]> ranges;
+    std::vector<std::vector<int>> steal_orders;    // Other node slots of each node, nearest first
+    std::atomic<size_t> num_stolen{0};
+};
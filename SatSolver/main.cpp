@@ -1,5 +1,22 @@
 #include "BooleanFormula.h"
 #include "BacktrackSolver.h"
+#include "Preprocessor.h"
+#include "SymmetryBreaker.h"
+#include "SolverWorkspace.h"
+#include "ModelCounter.h"
+#include "SolverServer.h"
+#include "BatchCoordinator.h"
+#include "BatchWorker.h"
+#include "SolveReport.h"
+#include "ResultCache.h"
+#include "Tracer.h"
+#include "PerfCounters.h"
+#include "MaxSatSolver.h"
+#include "MusExtractor.h"
+#include "BackboneExtractor.h"
+#include "EngineSelector.h"
+#include "InstanceGenerator.h"
+#include "WorkerPlacement.h"
 #include <iostream>
 #include <chrono>
 #include <fstream>
@@ -8,7 +25,21 @@
 #include <vector>
 #include <queue>
 #include <condition_variable>
+#include <atomic>
 #include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <unordered_map>
+#include <climits>
+#include <unistd.h>
+#include <sys/wait.h>
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
 
 // Maximum threads that can be run simultaneously.
 const int MAX_THREADS = 8;
@@ -18,12 +49,20 @@ const int MAX_THREADS = 8;
 Extracts the base filename from a given file path.
 </summary>
 <param name="path">The full path to the file.</param>
-<returns>The base filename without path or extension.</returns>
+<returns>The base filename without path or extension; a compression suffix is removed as well.</returns>
 */
 std::string getBaseFilename(const std::string &path)
 {
     size_t last_slash_pos = path.find_last_of("/\\");
     size_t last_dot_pos = path.find_last_of('.');
+    if (last_dot_pos != std::string::npos && last_dot_pos > 0)
+    {
+        std::string suffix = path.substr(last_dot_pos);
+        if (suffix == ".gz" || suffix == ".xz" || suffix == ".zst")
+        {
+            last_dot_pos = path.find_last_of('.', last_dot_pos - 1);
+        }
+    }
 
     size_t start = (last_slash_pos == std::string::npos) ? 0 : last_slash_pos + 1;
     size_t end = (last_dot_pos == std::string::npos || last_dot_pos <= start) ? path.length() : last_dot_pos;
@@ -31,31 +70,323 @@ std::string getBaseFilename(const std::string &path)
     return path.substr(start, end - start);
 }
 
+// Command line options controlling how each formula is processed.
+struct SolverOptions
+{
+    std::string filename;
+    bool count_models = false;         // --count: exact #SAT with component caching
+    bool enumerate_models = false;     // --enumerate[=LIMIT]: list models with blocking clauses
+    unsigned long long model_limit = 0; // 0 means enumerate every model
+    std::vector<int> projection;       // --project=V1,V2,...: variables models are projected onto
+    std::string serve_socket;          // --serve=PATH: run as a daemon on a Unix domain socket
+    int threads = MAX_THREADS;         // --threads=N: worker threads
+    int max_in_flight = 16;            // --max-in-flight=N: pipelined requests per daemon connection
+    std::string coordinator_address;   // --coordinator=ADDRESS: distribute the batch to worker processes
+    std::string worker_address;        // --worker=ADDRESS: solve tasks for a coordinator
+    int spawn_workers = 0;             // --spawn-workers=N: local worker processes started by the coordinator
+    int chunk_size = 16;               // --chunk=N: formulas per distributed task
+    int cube_depth = 0;                // --cube-depth=K: split each formula into 2^K cubes instead
+    double connect_timeout = 30;       // --connect-timeout=SECONDS: solve locally once no worker has been connected this long
+    EngineOptions engine;              // --engine, --portfolio-workers, --no-share, --deterministic, --inprocess-interval, --checkpoint and --checkpoint-interval
+    std::string thresholds_path;       // --engine-thresholds=PATH: thresholds of the automatic selection, loaded into engine.thresholds
+    std::string tune_path;             // --tune-engines=PATH: time every engine on the batch and write tuned thresholds to PATH
+    bool preprocess = false;           // --preprocess: simplify with the binary implication graph before solving
+    bool symmetry = false;             // --symmetry: add lex-leader clauses for the formula's symmetries before solving
+    std::string cache_path;            // --cache=PATH: reuse verdicts and models of formulas solved before
+    bool dedupe = true;                // --no-dedupe: solve repeated formulas of a batch again
+    std::string trace_path;            // --trace=PATH: write a Chrome trace of the run to PATH
+    size_t trace_events = 1 << 20;     // --trace-events=N: events kept per thread
+    bool perf = false;                 // --perf: report hardware counters per formula
+    bool maxsat = false;               // --maxsat: minimize the weight of violated soft clauses
+    bool stratify = true;              // --no-stratify: pass every MaxSAT assumption from the start
+    double maxsat_timeout = 0;         // --maxsat-timeout=SECONDS: keep the best model found by then; 0 means none
+    bool mus = false;                  // --mus: extract a minimal unsatisfiable subset of each unsatisfiable formula
+    int mus_workers = 4;               // --mus-workers=N: solver threads trimming each MUS
+    bool backbone = false;             // --backbone: find the literals every model of each formula satisfies
+    int backbone_workers = 4;          // --backbone-workers=N: solver threads probing each backbone
+    bool generate = false;             // --generate=SPEC: solve generated formulas instead of a file
+    GeneratorSpec generator;
+    std::string generate_output;       // --generate-output=PATH: write the generated formulas instead; - is stdout
+    bool dimacs = false;               // --format=cnf|dimacs: format of the generated file
+    bool pin = false;                  // --pin: bind workers to cores and keep each NUMA node's formulas local
+};
+
+/**
+<summary>
+Parses the command line into solver options.
+</summary>
+<param name="argc">The number of arguments.</param>
+<param name="argv">The arguments.</param>
+<param name="options">The options to fill in.</param>
+<returns>True if every argument was understood and the options can be combined, otherwise false.</returns>
+*/
+bool parseOptions(int argc, char *argv[], SolverOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--count")
+        {
+            options.count_models = true;
+        }
+        else if (arg == "--enumerate" || arg.compare(0, 12, "--enumerate=") == 0)
+        {
+            options.enumerate_models = true;
+            if (arg.size() > 12)
+            {
+                options.model_limit = std::strtoull(arg.c_str() + 12, nullptr, 10);
+            }
+        }
+        else if (arg.compare(0, 10, "--project=") == 0)
+        {
+            std::istringstream iss(arg.substr(10));
+            std::string var;
+            while (std::getline(iss, var, ','))
+            {
+                options.projection.push_back(std::stoi(var));
+            }
+        }
+        else if (arg.compare(0, 8, "--serve=") == 0)
+        {
+            options.serve_socket = arg.substr(8);
+        }
+        else if (arg.compare(0, 10, "--threads=") == 0)
+        {
+            options.threads = std::max(1, std::atoi(arg.c_str() + 10));
+        }
+        else if (arg.compare(0, 16, "--max-in-flight=") == 0)
+        {
+            options.max_in_flight = std::max(1, std::atoi(arg.c_str() + 16));
+        }
+        else if (arg.compare(0, 14, "--coordinator=") == 0)
+        {
+            options.coordinator_address = arg.substr(14);
+        }
+        else if (arg.compare(0, 9, "--worker=") == 0)
+        {
+            options.worker_address = arg.substr(9);
+        }
+        else if (arg.compare(0, 16, "--spawn-workers=") == 0)
+        {
+            options.spawn_workers = std::max(0, std::atoi(arg.c_str() + 16));
+        }
+        else if (arg.compare(0, 8, "--chunk=") == 0)
+        {
+            options.chunk_size = std::max(1, std::atoi(arg.c_str() + 8));
+        }
+        else if (arg.compare(0, 13, "--cube-depth=") == 0)
+        {
+            options.cube_depth = std::max(0, std::atoi(arg.c_str() + 13));
+            if (options.cube_depth > BatchCoordinator::MAX_CUBE_DEPTH)
+            {
+                return false;
+            }
+        }
+        else if (arg.compare(0, 18, "--connect-timeout=") == 0)
+        {
+            options.connect_timeout = std::max(0.0, std::atof(arg.c_str() + 18));
+        }
+        else if (arg.compare(0, 9, "--engine=") == 0)
+        {
+            options.engine.name = arg.substr(9);
+            const std::string &name = options.engine.name;
+            if (name != "auto" && name != "backtrack" && name != "twosat" && name != "cdcl" && name != "portfolio" && name != "lookahead")
+            {
+                return false;
+            }
+        }
+        else if (arg.compare(0, 20, "--engine-thresholds=") == 0)
+        {
+            options.thresholds_path = arg.substr(20);
+        }
+        else if (arg.compare(0, 15, "--tune-engines=") == 0)
+        {
+            options.tune_path = arg.substr(15);
+        }
+        else if (arg.compare(0, 20, "--portfolio-workers=") == 0)
+        {
+            options.engine.portfolio_workers = std::max(1, std::atoi(arg.c_str() + 20));
+        }
+        else if (arg == "--no-share")
+        {
+            options.engine.share_clauses = false;
+        }
+        else if (arg == "--preprocess")
+        {
+            options.preprocess = true;
+        }
+        else if (arg == "--symmetry")
+        {
+            options.symmetry = true;
+        }
+        else if (arg.compare(0, 13, "--checkpoint=") == 0)
+        {
+            options.engine.checkpoint_path = arg.substr(13);
+        }
+        else if (arg.compare(0, 22, "--checkpoint-interval=") == 0)
+        {
+            options.engine.checkpoint_interval = std::max(0.0, std::atof(arg.c_str() + 22));
+        }
+        else if (arg.compare(0, 8, "--cache=") == 0)
+        {
+            options.cache_path = arg.substr(8);
+        }
+        else if (arg == "--no-dedupe")
+        {
+            options.dedupe = false;
+        }
+        else if (arg.compare(0, 8, "--trace=") == 0)
+        {
+            options.trace_path = arg.substr(8);
+        }
+        else if (arg.compare(0, 15, "--trace-events=") == 0)
+        {
+            options.trace_events = std::strtoull(arg.c_str() + 15, nullptr, 10);
+        }
+        else if (arg == "--perf")
+        {
+            options.perf = true;
+        }
+        else if (arg == "--maxsat")
+        {
+            options.maxsat = true;
+        }
+        else if (arg == "--no-stratify")
+        {
+            options.stratify = false;
+        }
+        else if (arg.compare(0, 17, "--maxsat-timeout=") == 0)
+        {
+            options.maxsat_timeout = std::max(0.0, std::atof(arg.c_str() + 17));
+        }
+        else if (arg == "--mus")
+        {
+            options.mus = true;
+        }
+        else if (arg.compare(0, 14, "--mus-workers=") == 0)
+        {
+            options.mus_workers = std::max(1, std::atoi(arg.c_str() + 14));
+        }
+        else if (arg == "--backbone")
+        {
+            options.backbone = true;
+        }
+        else if (arg.compare(0, 19, "--backbone-workers=") == 0)
+        {
+            options.backbone_workers = std::max(1, std::atoi(arg.c_str() + 19));
+        }
+        else if (arg.compare(0, 11, "--generate=") == 0)
+        {
+            options.generate = true;
+            if (!InstanceGenerator::parseSpec(arg.substr(11), options.generator))
+            {
+                return false;
+            }
+        }
+        else if (arg.compare(0, 18, "--generate-output=") == 0)
+        {
+            options.generate_output = arg.substr(18);
+        }
+        else if (arg == "--deterministic")
+        {
+            options.engine.round_conflicts = 2000;
+        }
+        else if (arg.compare(0, 16, "--deterministic=") == 0)
+        {
+            options.engine.round_conflicts = std::max(1LL, std::atoll(arg.c_str() + 16));
+        }
+        else if (arg.compare(0, 21, "--inprocess-interval=") == 0)
+        {
+            options.engine.inprocess_interval = std::max(0, std::atoi(arg.c_str() + 21));
+        }
+        else if (arg == "--pin")
+        {
+            options.pin = true;
+        }
+        else if (arg == "--format=cnf" || arg == "--format=dimacs")
+        {
+            options.dimacs = (arg == "--format=dimacs");
+        }
+        else if (arg[0] != '-' && options.filename.empty())
+        {
+            options.filename = arg;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    // Workers only report verdicts and models of the formulas as given, so the other modes cannot be distributed
+    if (!options.coordinator_address.empty() &&
+        (options.count_models || options.enumerate_models || options.maxsat || options.mus || options.backbone ||
+         options.preprocess || options.symmetry || !options.engine.checkpoint_path.empty()))
+    {
+        return false;
+    }
+    return options.generate || options.generate_output.empty();
+}
+
 // A structure to store results from the SAT problem evaluation.
 struct FormulaResult
 {
     int index;
     std::string output;
     std::string csv_data;
+    bool satisfiable;                 // Kept so that duplicates of the formula can reuse the result
+    std::vector<BoolValue> assignment;
+    std::string extra_columns;
+};
+
+// Running totals reported in the CSV summary line.
+struct BatchTotals
+{
+    int wffs = 0;
+    int satisfiable = 0;
+    int unsatisfiable = 0;
+    int answer_provided = 0;
+    int correct_answers = 0;
 };
 
 /**
 <summary>
-Processes a SAT formula and evaluates its satisfiability.
+Appends an assignment to a text buffer, growing it once for the whole assignment.
+</summary>
+<param name="buffer">The buffer to append to.</param>
+<param name="assignment">The assignment.</param>
+<param name="tokens">The text written for TRUE, FALSE and UNASSIGNED, in BoolValue order.</param>
+*/
+void appendAssignment(std::string &buffer, const std::vector<BoolValue> &assignment, const std::string (&tokens)[3])
+{
+    size_t counts[3] = {0, 0, 0};
+    for (BoolValue val : assignment)
+    {
+        counts[static_cast<int>(val)]++;
+    }
+    buffer.reserve(buffer.size() + counts[0] * tokens[0].size() + counts[1] * tokens[1].size() + counts[2] * tokens[2].size() + 1);
+    for (BoolValue val : assignment)
+    {
+        buffer += tokens[static_cast<int>(val)];
+    }
+}
+
+/**
+<summary>
+Formats the log and CSV output for a solved formula and adds it to the batch totals.
 </summary>
 <param name="index">The index of the formula in the formulas vector.</param>
-<param name="formulas">A reference to the vector of all formulas.</param>
+<param name="formula">The formula that was solved.</param>
+<param name="solution_found">Whether the formula was found satisfiable.</param>
+<param name="elapsed_time">The solving time in microseconds.</param>
+<param name="assignment">The assignment to report.</param>
+<param name="details">Mode-specific log lines written before the verdict.</param>
+<param name="extra_columns">Mode-specific CSV columns written before the assignment.</param>
+<param name="counter_columns">Hardware counter columns written after them, empty unless --perf is given.</param>
 <param name="results">A reference to the vector storing results.</param>
-<param name="total_wffs">Total number of well-formed formulas processed.</param>
-<param name="total_satisfiable">Total number of satisfiable formulas.</param>
-<param name="total_unsatisfiable">Total number of unsatisfiable formulas.</param>
-<param name="total_answer_provided">Total formulas for which an answer was provided.</param>
-<param name="total_correct_answers">Total number of correctly answered formulas.</param>
+<param name="totals">The batch totals to update.</param>
 <param name="mtx">Mutex for handling concurrent accesses.</param>
 */
-void processFormula(int index, const std::vector<BooleanFormula> &formulas, std::vector<FormulaResult> &results, int &total_wffs, int &total_satisfiable, int &total_unsatisfiable, int &total_answer_provided, int &total_correct_answers, std::mutex &mtx)
+void recordResult(int index, const BooleanFormula &formula, bool solution_found, long long elapsed_time, const std::vector<BoolValue> &assignment, const std::string &details, const std::string &extra_columns, const std::string &counter_columns, std::vector<FormulaResult> &results, BatchTotals &totals, std::mutex &mtx)
 {
-    BooleanFormula formula = formulas[index];
     std::stringstream console_output, csv_output;
 
     console_output << "Solving formula #" << index + 1 << "\n";
@@ -64,12 +395,7 @@ void processFormula(int index, const std::vector<BooleanFormula> &formulas, std:
     console_output << "Answer: " << provided_answer << "\n";
 
     console_output << "Max literals in a clause: " << formula.getMaxLiteralsInClause() << "\n";
-
-    BacktrackSolver solver(formula);
-    auto start_time = std::chrono::high_resolution_clock::now();
-    bool solution_found = solver.solve();
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    console_output << details;
 
     csv_output << index + 1 << ","
                << formula.getVariableCount() << ","
@@ -77,135 +403,773 @@ void processFormula(int index, const std::vector<BooleanFormula> &formulas, std:
                << formula.getMaxLiteralsInClause() << ","
                << formula.getTotalLiterals() << ",";
 
+    static const std::string console_tokens[3] = {"0 ", "1 ", "2 "};
+    static const std::string csv_tokens[3] = {"1,", "0,", "-1,"};
+    std::string model_line;
     if (solution_found)
     {
         csv_output << "S,";
         console_output << "Satisfiable answer found for formula #" << index + 1 << "\n";
-        const auto &assignment = solver.getAssignment();
-        for (BoolValue val : assignment)
-        {
-            console_output << static_cast<int>(val) << " ";
-        }
-        console_output << "\n";
-
-        total_satisfiable++;
+        appendAssignment(model_line, assignment, console_tokens);
+        model_line += '\n';
+        console_output << model_line;
     }
     else
     {
         csv_output << "U,";
         console_output << "No satisfiable answer found for formula #" << index + 1 << "\n";
-        total_unsatisfiable++;
     }
 
+    bool counts_as_correct = false;
     if (provided_answer == 'S' && solution_found)
     {
         csv_output << "1,";
-        total_correct_answers++;
+        counts_as_correct = true;
     }
     else if (provided_answer == 'U' && !solution_found)
     {
         csv_output << "1,";
-        total_correct_answers++;
+        counts_as_correct = true;
     }
     else if (provided_answer != '?')
     {
         csv_output << "-1,";
-        total_correct_answers++;
+        counts_as_correct = true;
     }
     else
     {
         csv_output << "0,";
     }
 
-    csv_output << elapsed_time << ",";
-    total_answer_provided += (provided_answer != '?');
+    csv_output << elapsed_time << "," << extra_columns << counter_columns;
+    std::string csv_line = csv_output.str();
+    appendAssignment(csv_line, assignment, csv_tokens);
+    csv_line += '\n';
+
+    {
+        TraceScope trace("output wait", index + 1);
+        mtx.lock();
+    }
+    totals.wffs++;
+    totals.satisfiable += solution_found;
+    totals.unsatisfiable += !solution_found;
+    totals.answer_provided += (provided_answer != '?');
+    totals.correct_answers += counts_as_correct;
+    results[index] = {index, console_output.str(), std::move(csv_line), solution_found, assignment, extra_columns};
+    mtx.unlock();
+}
+
+/**
+<summary>
+Processes a SAT formula and evaluates its satisfiability.
+</summary>
+<param name="index">The index of the formula in the formulas vector.</param>
+<param name="formulas">A reference to the vector of all formulas.</param>
+<param name="results">A reference to the vector storing results.</param>
+<param name="totals">The batch totals to update.</param>
+<param name="mtx">Mutex for handling concurrent accesses.</param>
+<param name="options">The command line options selecting the solving mode.</param>
+<param name="workspace">The calling worker's storage, reused for every formula it solves.</param>
+<param name="cache">The result cache, or nullptr if none is used.</param>
+<param name="counters">The calling worker's hardware counters, or nullptr if none are reported.</param>
+<param name="cpus">The CPUs portfolio threads are bound to; empty leaves them unbound.</param>
+*/
+void processFormula(int index, const std::vector<BooleanFormula> &formulas, std::vector<FormulaResult> &results, BatchTotals &totals, std::mutex &mtx, const SolverOptions &options, SolverWorkspace &workspace, ResultCache *cache, const PerfCounters *counters, const std::vector<int> &cpus)
+{
+    std::stringstream details, extra_columns;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    PerfSample counters_start = counters != nullptr ? counters->read() : PerfSample();
 
-    const auto &assignment = solver.getAssignment();
-    for (size_t i = 0; i < assignment.size(); ++i)
+    // Counting, enumeration, MaxSAT, MUS and backbone results are not cached, only verdicts and models
+    FormulaFingerprint fingerprint;
+    bool use_cache = cache != nullptr && !options.count_models && !options.enumerate_models && !options.maxsat && !options.mus && !options.backbone;
+    if (use_cache)
     {
-        switch (assignment[i])
+        TraceScope trace("cache lookup");
+        fingerprint = ResultCache::fingerprint(formulas[index]);
+        bool cached_satisfiable;
+        std::vector<BoolValue> cached_model;
+        if (cache->lookup(formulas[index], fingerprint, cached_satisfiable, cached_model))
         {
-        case BoolValue::TRUE:
-            csv_output << "1,";
-            break;
-        case BoolValue::FALSE:
-            csv_output << "0,";
-            break;
-        default:
-            csv_output << "-1,";
-            break;
+            auto elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+            recordResult(index, formulas[index], cached_satisfiable, elapsed_time,
+                         cached_satisfiable ? cached_model : std::vector<BoolValue>(formulas[index].getVariableCount(), BoolValue::UNASSIGNED),
+                         "Result from cache\n", "", counters != nullptr ? (counters->read() - counters_start).toColumns() : "",
+                         results, totals, mtx);
+            return;
         }
     }
-    csv_output << "\n";
 
-    mtx.lock();
-    total_wffs++;
-    results[index] = {index, console_output.str(), csv_output.str()};
-    mtx.unlock();
+    // Simplification only applies to plain solving; counting, enumeration and backbones need every model, MaxSAT and MUS every clause
+    std::unique_ptr<Preprocessor> preprocessor;
+    BooleanFormula simplified;
+    bool refuted = false;
+    if (options.preprocess && !options.count_models && !options.enumerate_models && !options.maxsat && !options.mus && !options.backbone)
+    {
+        TraceScope trace("preprocess");
+        preprocessor.reset(new Preprocessor(formulas[index]));
+        refuted = !preprocessor->simplify();
+        simplified = preprocessor->getSimplifiedFormula();
+        details << "Preprocessing: " << preprocessor->getNumFixed() << " fixed, "
+                << preprocessor->getNumSubstituted() << " substituted, "
+                << preprocessor->getNumFailedLiterals() << " failed literals, "
+                << preprocessor->getNumHyperBinaryResolvents() << " hyper-binary resolvents, "
+                << formulas[index].getClauseCount() << " -> " << simplified.getClauseCount() << " clauses"
+                << (refuted ? ", unsatisfiable" : "") << "\n";
+    }
 
-    console_output << "----------------------------\n";
+    // Symmetry breaking keeps one model of each orbit, so it too only applies to plain solving
+    std::unique_ptr<SymmetryBreaker> symmetry;
+    BooleanFormula broken;
+    if (options.symmetry && !refuted && !options.count_models && !options.enumerate_models && !options.maxsat && !options.mus && !options.backbone)
+    {
+        TraceScope trace("symmetry");
+        symmetry.reset(new SymmetryBreaker(preprocessor ? simplified : formulas[index]));
+        symmetry->detect();
+        broken = symmetry->getBrokenFormula(formulas[index].getVariableCount());
+        details << "Symmetry: " << symmetry->getNumGenerators() << " generators, group size 10^"
+                << std::round(symmetry->getGroupSizeLog10() * 10) / 10
+                << (symmetry->isBudgetExhausted() ? " or more (search budget reached)" : "")
+                << ", " << symmetry->getNumSearchNodes() << " search nodes, "
+                << symmetry->getNumBreakingClauses() << " breaking clauses over "
+                << symmetry->getNumAuxiliaryVariables() << " auxiliary variables\n";
+    }
+    // Solve the batch's own copy unless it was simplified or had symmetries broken
+    const BooleanFormula &formula = symmetry ? broken : preprocessor ? simplified : formulas[index];
+
+    // Only enumeration and the backtracking engine build a BacktrackSolver, with its copy of the clauses
+    ModelCount model_count;
+    std::vector<BoolValue> first_model; // Counting produces no model, enumeration reports its first one
+    std::vector<BoolValue> engine_model; // Model of the engine, of MaxSAT, MUS and backbone extraction
+    bool solution_found;
+    int64_t solve_start = Tracer::isEnabled() ? Tracer::now() : 0;
+    PerfSample counters_solve = counters != nullptr ? counters->read() : PerfSample();
+    if (refuted)
+    {
+        solution_found = false;
+    }
+    else if (options.maxsat)
+    {
+        MaxSatSolver maxsat(formula, options.stratify);
+        maxsat.setTimeLimit(std::chrono::milliseconds(static_cast<long long>(options.maxsat_timeout * 1000)));
+        bool feasible = maxsat.solve([&](unsigned long long cost, unsigned long long lower_bound, const std::vector<BoolValue> &)
+                                     {
+                                         // Stream each improvement right away; the full result follows with the batch
+                                         std::lock_guard<std::mutex> lock(mtx);
+                                         std::cout << "MaxSAT formula #" << index + 1 << ": cost " << cost
+                                                   << " (lower bound " << lower_bound << ")" << std::endl;
+                                         details << "Improved cost: " << cost << " (lower bound " << lower_bound << ")\n";
+                                     });
+        // Only an assignment violating no soft clause satisfies the formula
+        solution_found = feasible && maxsat.getCost() == 0;
+        engine_model = maxsat.getAssignment();
+        if (feasible)
+        {
+            extra_columns << maxsat.getCost() << "," << maxsat.getLowerBound() << ",";
+            details << "MaxSAT cost: " << maxsat.getCost() << (maxsat.isOptimal() ? " (optimal)" : " (time limit reached)")
+                    << ", lower bound: " << maxsat.getLowerBound()
+                    << ", soft clauses: " << maxsat.getNumSoftClauses()
+                    << ", cores: " << maxsat.getNumCores()
+                    << ", SAT calls: " << maxsat.getNumSatCalls() << "\n";
+        }
+        else
+        {
+            extra_columns << "-1,-1,";
+            details << "MaxSAT: the hard clauses are unsatisfiable\n";
+        }
+    }
+    else if (options.mus)
+    {
+        MusExtractor extractor(formula, options.mus_workers);
+        solution_found = !extractor.extract();
+        engine_model = extractor.getAssignment();
+        if (solution_found)
+        {
+            extra_columns << "-1,";
+            details << "MUS: the formula is satisfiable\n";
+        }
+        else
+        {
+            // Clauses are numbered from 1 in the order of the file
+            extra_columns << extractor.getMus().size() << ",";
+            details << "MUS: " << extractor.getMus().size() << " of " << formula.getClauseCount() << " clauses"
+                    << " (refined core: " << extractor.getInitialCoreSize()
+                    << ", SAT calls: " << extractor.getNumSatCalls()
+                    << ", rotated: " << extractor.getNumRotated()
+                    << ", refined away: " << extractor.getNumRefined()
+                    << ", retests: " << extractor.getNumRetests() << ")\nMUS clauses:";
+            for (int clause : extractor.getMus())
+            {
+                details << " " << clause + 1;
+            }
+            details << "\n";
+        }
+    }
+    else if (options.backbone)
+    {
+        BackboneExtractor extractor(formula, options.backbone_workers);
+        solution_found = extractor.compute();
+        engine_model = extractor.getAssignment();
+        if (solution_found)
+        {
+            extra_columns << extractor.getBackbone().size() << ",";
+            details << "Backbone: " << extractor.getBackbone().size() << " of " << formula.getVariableCount() << " variables"
+                    << " (SAT calls: " << extractor.getNumSatCalls()
+                    << ", backbone chunks: " << extractor.getNumBackboneChunks()
+                    << ", refuted by models: " << extractor.getNumFilteredByModels()
+                    << ", by flips: " << extractor.getNumFilteredByFlips() << ")\nBackbone literals:";
+            for (int lit : extractor.getBackbone())
+            {
+                details << " " << lit;
+            }
+            details << "\n";
+        }
+        else
+        {
+            extra_columns << "-1,";
+            details << "Backbone: the formula is unsatisfiable\n";
+        }
+    }
+    else if (options.count_models)
+    {
+        ModelCounter counter(formula);
+        model_count = counter.count();
+        solution_found = !model_count.isZero();
+        details << "Model count: " << model_count.toString()
+                << " (decisions: " << counter.getNumDecisions()
+                << ", cache hits: " << counter.getNumCacheHits()
+                << ", component splits: " << counter.getNumComponentSplits() << ")\n";
+    }
+    else if (options.enumerate_models)
+    {
+        BacktrackSolver solver(formula, &workspace);
+        model_count = solver.enumerate(options.projection, options.model_limit,
+                                       [&](const std::vector<BoolValue> &model)
+                                       {
+                                           if (first_model.empty())
+                                           {
+                                               first_model = model;
+                                           }
+                                           details << "Model: ";
+                                           for (BoolValue val : model)
+                                           {
+                                               details << static_cast<int>(val) << " ";
+                                           }
+                                           details << "\n";
+                                           return true;
+                                       });
+        solution_found = !model_count.isZero();
+        details << "Projected models found: " << model_count.toString()
+                << (options.model_limit != 0 && model_count.atLeast(options.model_limit) ? " (limit reached)" : "") << "\n";
+    }
+    else
+    {
+        // Plain solving goes through the same engine dispatch as the daemon and the distributed workers
+        EngineOptions engine = options.engine;
+        engine.verbose = true;
+        if (!engine.checkpoint_path.empty() && formulas.size() > 1)
+        {
+            // One snapshot file per formula of a batch
+            engine.checkpoint_path += "." + std::to_string(index + 1);
+        }
+        SolveReport report = SolveReport::solve(formula, engine, &workspace, cpus);
+        solution_found = report.satisfiable;
+        engine_model = report.assignment;
+        details << report.details;
+    }
+    if (Tracer::isEnabled())
+    {
+        Tracer::record("solve", solve_start, Tracer::now() - solve_start, index + 1);
+    }
+    std::string counter_columns;
+    if (counters != nullptr)
+    {
+        // Attribute the counts to the phases before and during search
+        PerfSample counters_end = counters->read();
+        PerfSample setup = counters_solve - counters_start;
+        PerfSample search = counters_end - counters_solve;
+        details << "Hardware counters (setup / solve):";
+        for (int i = 0; i < PerfSample::NUM_EVENTS; i++)
+        {
+            details << (i == 0 ? " " : ", ") << PerfCounters::eventName(i) << " " << setup.values[i] << " / " << search.values[i];
+        }
+        details << "\n";
+        counter_columns = (counters_end - counters_start).toColumns();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+    if (options.count_models || options.enumerate_models)
+    {
+        extra_columns << model_count.toString() << ",";
+    }
+    std::vector<BoolValue> assignment = (options.count_models || options.enumerate_models) ? first_model : engine_model;
+    if (symmetry && !preprocessor)
+    {
+        // Drop the auxiliary variables of the breaking clauses
+        assignment.resize(std::min<size_t>(assignment.size(), formulas[index].getVariableCount()));
+    }
+    if (preprocessor)
+    {
+        // Report the model over the original variables
+        assignment = solution_found ? preprocessor->extendModel(assignment)
+                                    : std::vector<BoolValue>(formulas[index].getVariableCount(), BoolValue::UNASSIGNED);
+    }
+    if (use_cache)
+    {
+        cache->store(formulas[index], fingerprint, solution_found, assignment);
+    }
+    recordResult(index, formulas[index], solution_found, elapsed_time, assignment,
+                 details.str(), extra_columns.str(), counter_columns, results, totals, mtx);
+}
+
+/**
+<summary>
+Times every engine on each formula of the batch, adds the measurements to the
+benchmark records and tunes the engine selection thresholds on all of them.
+</summary>
+<param name="formulas">The batch.</param>
+<param name="options">The command line options; tune_path names the thresholds file written.</param>
+<returns>True if the records and thresholds were written, otherwise false.</returns>
+<remarks>
+The records are kept in tune_path with ".records.csv" appended, so that
+thresholds tuned on several batches in turn account for all of them.
+</remarks>
+*/
+bool tuneEngines(const std::vector<BooleanFormula> &formulas, const SolverOptions &options)
+{
+    const std::vector<std::string> &names = EngineSelector::engineNames();
+    std::vector<EngineRecord> batch;
+    for (size_t i = 0; i < formulas.size(); i++)
+    {
+        batch.push_back(EngineSelector::measure(formulas[i], options.engine.portfolio_workers));
+        std::cout << "Formula #" << i + 1 << ":";
+        for (size_t e = 0; e < names.size(); e++)
+        {
+            if (batch.back().times[e] >= 0)
+            {
+                std::cout << " " << names[e] << " " << batch.back().times[e] << " us";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    std::string records_path = options.tune_path + ".records.csv";
+    std::vector<EngineRecord> records;
+    if (!EngineSelector::appendRecords(records_path, batch) || !EngineSelector::loadRecords(records_path, records))
+    {
+        std::cerr << "Failed to write " << records_path << "." << std::endl;
+        return false;
+    }
+    EngineThresholds thresholds = options.engine.thresholds;
+    double before = EngineSelector::totalTime(records, thresholds);
+    double after = EngineSelector::tune(records, thresholds);
+    if (!EngineSelector::saveThresholds(options.tune_path, thresholds))
+    {
+        std::cerr << "Failed to write " << options.tune_path << "." << std::endl;
+        return false;
+    }
+
+    double fastest = 0;
+    for (const EngineRecord &record : records)
+    {
+        double best = -1;
+        for (double time : record.times)
+        {
+            best = time >= 0 && (best < 0 || time < best) ? time : best;
+        }
+        fastest += std::max(0.0, best);
+    }
+    std::cout << "Tuned on " << records.size() << " records: the selected engines take " << after << " us, "
+              << before << " us before tuning and " << fastest << " us with the fastest engine for every formula" << std::endl;
+    return true;
 }
 
-int main()
+/**
+<summary>
+Finds the file of the running executable, so that worker processes can be started from it.
+</summary>
+<param name="argv0">The program name the executable was started with.</param>
+<returns>The absolute path of the executable, or argv0 for execvp to look up if it cannot be found.</returns>
+*/
+std::string executablePath(const char *argv0)
 {
-    std::string filename;
-    // Ask the user for the SAT file to be processed.
-    std::cout << "Enter the path to the SAT formula file: ";
-    std::cin >> filename;
+    char path[PATH_MAX];
+#if defined(__linux__)
+    ssize_t length = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length > 0)
+    {
+        return std::string(path, length);
+    }
+#elif defined(__APPLE__)
+    uint32_t size = sizeof(path);
+    char resolved[PATH_MAX];
+    if (_NSGetExecutablePath(path, &size) == 0 && ::realpath(path, resolved) != nullptr)
+    {
+        return resolved;
+    }
+#endif
+    // A name without a slash was found on the PATH
+    if (std::strchr(argv0, '/') != nullptr && ::realpath(argv0, path) != nullptr)
+    {
+        return path;
+    }
+    return argv0;
+}
+
+// The daemon being served, so that SIGINT and SIGTERM can stop it cleanly.
+SolverServer *active_server = nullptr;
+
+void stopServer(int)
+{
+    if (active_server != nullptr)
+    {
+        active_server->requestStop();
+    }
+}
 
-    // Load the SAT formulas from the provided file.
-    BooleanFormula loader;
-    auto formulas = loader.loadFromFile(filename);
+int main(int argc, char *argv[])
+{
+    // Resolved before anything can change the working directory
+    std::string executable = executablePath(argv[0]);
+    SolverOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--count | --enumerate[=LIMIT]] [--project=V1,V2,...] [--threads=N] [file]\n"
+                  << "       " << argv[0] << " --engine=auto|backtrack|twosat|cdcl|portfolio|lookahead [--engine-thresholds=PATH] [--portfolio-workers=N] [--no-share] [--deterministic[=CONFLICTS]] [--inprocess-interval=CONFLICTS] [--preprocess] [--symmetry] [--threads=N] [file]\n"
+                  << "       " << argv[0] << " --tune-engines=PATH [--engine-thresholds=PATH] [--portfolio-workers=N] [file]\n"
+                  << "       " << argv[0] << " --checkpoint=PATH [--checkpoint-interval=SECONDS] [--threads=N] [file]\n"
+                  << "       " << argv[0] << " --cache=PATH [--no-dedupe] [--threads=N] [file]\n"
+                  << "       " << argv[0] << " --trace=PATH [--trace-events=N] [other options] [file]\n"
+                  << "       " << argv[0] << " --perf [other options] [file]\n"
+                  << "       " << argv[0] << " --pin [other options] [file]\n"
+                  << "       " << argv[0] << " --maxsat [--no-stratify] [--maxsat-timeout=SECONDS] [--threads=N] [file]\n"
+                  << "       " << argv[0] << " --mus [--mus-workers=N] [--threads=N] [file]\n"
+                  << "       " << argv[0] << " --backbone [--backbone-workers=N] [--threads=N] [file]\n"
+                  << "       " << argv[0] << " --generate=random|planted|sudoku[:KEY=VALUE,...] [--generate-output=PATH [--format=cnf|dimacs]] [other options]\n"
+                  << "       " << argv[0] << " --serve=SOCKET [--engine=NAME] [--threads=N] [--max-in-flight=N] [--cache=PATH]\n"
+                  << "       " << argv[0] << " --coordinator=ADDRESS [--spawn-workers=N] [--chunk=N | --cube-depth=K (at most 20)] [--connect-timeout=SECONDS] [--engine=NAME] [file]\n"
+                  << "       " << argv[0] << " --worker=ADDRESS\n"
+                  << "ADDRESS is unix:PATH or HOST:PORT. Generator keys: vars, k, ratio, order, givens, count, growth, seed.\n"
+                  << "Distributed batches only solve: --coordinator takes no counting, enumeration, MaxSAT, MUS, backbone,\n"
+                  << "preprocessing, symmetry or checkpoint options." << std::endl;
+        return 1;
+    }
+
+    if (!options.thresholds_path.empty() && !EngineSelector::loadThresholds(options.thresholds_path, options.engine.thresholds))
+    {
+        std::cerr << "Failed to read engine thresholds from " << options.thresholds_path << "." << std::endl;
+        return 1;
+    }
+
+    if (!options.worker_address.empty())
+    {
+        BatchWorker worker(options.worker_address);
+        return worker.run() ? 0 : 1;
+    }
+
+    // Shared by the daemon's pool threads or the batch workers
+    if (!options.trace_path.empty())
+    {
+        Tracer::enable(options.trace_events);
+        Tracer::setThreadName("main");
+    }
+
+    std::unique_ptr<ResultCache> cache;
+    if (!options.cache_path.empty())
+    {
+        cache.reset(new ResultCache(options.cache_path));
+    }
+
+    if (!options.serve_socket.empty())
+    {
+        // Requests share no snapshot file, so the daemon takes no checkpoints
+        EngineOptions engine = options.engine;
+        engine.checkpoint_path.clear();
+        SolverServer server(options.serve_socket, options.threads, options.max_in_flight, cache.get(), engine);
+        active_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        try
+        {
+            server.serve();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            active_server = nullptr;
+            return 1;
+        }
+        active_server = nullptr;
+        if (Tracer::isEnabled() && !Tracer::writeChromeTrace(options.trace_path))
+        {
+            std::cerr << "Failed to write trace file." << std::endl;
+        }
+        return 0;
+    }
+
+    std::string filename = options.filename;
+    std::vector<BooleanFormula> formulas;
+    if (options.generate)
+    {
+        // Generate the formulas in memory; results are named after the family.
+        {
+            TraceScope trace("generate");
+            formulas = InstanceGenerator::generate(options.generator);
+        }
+        filename = "generated_" + options.generator.family;
+        if (!options.generate_output.empty())
+        {
+            std::ofstream file;
+            if (options.generate_output != "-")
+            {
+                file.open(options.generate_output);
+                if (!file.is_open())
+                {
+                    std::cerr << "Failed to open " << options.generate_output << "." << std::endl;
+                    return 1;
+                }
+            }
+            std::ostream &output = (options.generate_output == "-") ? std::cout : file;
+            for (size_t i = 0; i < formulas.size(); i++)
+            {
+                if (options.dimacs)
+                {
+                    formulas[i].writeDimacs(output, static_cast<int>(i) + 1);
+                }
+                else
+                {
+                    formulas[i].writeToStream(output, static_cast<int>(i) + 1);
+                }
+            }
+            return output.flush() ? 0 : 1;
+        }
+    }
+    else
+    {
+        if (filename.empty())
+        {
+            // Ask the user for the SAT file to be processed.
+            std::cout << "Enter the path to the SAT formula file: ";
+            std::cin >> filename;
+        }
+
+        // Load the SAT formulas from the provided file.
+        BooleanFormula loader;
+        try
+        {
+            TraceScope trace("parse");
+            formulas = loader.loadFromFile(filename);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
     if (formulas.empty())
     {
         std::cerr << "Failed to load formulas from the file." << std::endl;
         return 1;
     }
+    if (!options.tune_path.empty())
+    {
+        return tuneEngines(formulas, options) ? 0 : 1;
+    }
 
     // Set up the CSV file for output.
     std::string base_filename = getBaseFilename(filename);
     std::ofstream csv_file(base_filename + ".csv");
-    csv_file << "Problem Number,Number of Variables,Number of Clauses,Max Literals in a Clause,Total Literals,S/U,Agreement,Execution Time in Microseconds,Assignments..." << std::endl;
+    csv_file << "Problem Number,Number of Variables,Number of Clauses,Max Literals in a Clause,Total Literals,S/U,Agreement,Execution Time in Microseconds,"
+             << (options.count_models || options.enumerate_models ? "Model Count," : "")
+             << (options.maxsat ? "Cost,Lower Bound," : "")
+             << (options.mus ? "MUS Size," : "")
+             << (options.backbone ? "Backbone Size," : "")
+             << (options.perf ? PerfCounters::csvHeader() : "") << "Assignments..." << std::endl;
     std::ofstream log_file(base_filename + ".log");
     if (!log_file.is_open())
     {
         std::cerr << "Failed to open log file." << std::endl;
         return 1;
     }
+    if (options.perf)
+    {
+        PerfCounters probe;
+        if (!probe.getError().empty())
+        {
+            std::cerr << "Hardware counters unavailable (" << probe.getError() << "); their columns will be -1." << std::endl;
+        }
+    }
+
     // Initialize counters and containers.
-    int total_wffs = 0, total_satisfiable = 0, total_unsatisfiable = 0, total_answer_provided = 0, total_correct_answers = 0;
+    BatchTotals totals;
     std::mutex mtx;
     std::vector<std::thread> workers;
     std::vector<FormulaResult> results(formulas.size());
 
-    // Launch threads to process formulas.
-    for (size_t i = 0; i < formulas.size(); ++i)
+    // Formulas a coordinator has results for; the rest are solved here
+    std::vector<char> distributed(formulas.size(), 0);
+    bool solve_locally = true;
+    if (!options.coordinator_address.empty())
     {
-        workers.emplace_back(processFormula, i, std::ref(formulas), std::ref(results), std::ref(total_wffs), std::ref(total_satisfiable), std::ref(total_unsatisfiable), std::ref(total_answer_provided), std::ref(total_correct_answers), std::ref(mtx));
+        // Distribute the batch to worker processes, optionally started here as stand-in nodes.
+        BatchCoordinator coordinator(options.coordinator_address, formulas, options.chunk_size, options.cube_depth, options.engine);
+        coordinator.setConnectTimeout(static_cast<int>(options.connect_timeout * 1000));
+        std::vector<pid_t> children;
+        try
+        {
+            coordinator.listen();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        for (int i = 0; i < options.spawn_workers; i++)
+        {
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                std::string worker_arg = "--worker=" + options.coordinator_address;
+                execlp(executable.c_str(), argv[0], worker_arg.c_str(), static_cast<char *>(nullptr));
+                _exit(127);
+            }
+            children.push_back(pid);
+        }
 
-        if (workers.size() == MAX_THREADS || i == formulas.size() - 1)
+        solve_locally = !coordinator.run([&](int index, const SolveReport &report)
+                                         {
+                                             distributed[index] = 1;
+                                             recordResult(index, formulas[index], report.satisfiable, report.elapsed_us, report.assignment,
+                                                          "", "", options.perf ? PerfSample().toColumns() : "", results, totals, mtx);
+                                         });
+        if (solve_locally)
         {
-            for (auto &worker : workers)
+            std::cerr << "Solving the formulas without a distributed result locally." << std::endl;
+            for (pid_t pid : children)
             {
-                worker.join();
+                kill(pid, SIGTERM);
             }
-            workers.clear();
+        }
+        for (pid_t pid : children)
+        {
+            waitpid(pid, nullptr, 0);
+        }
+        if (coordinator.getNumReassignments() > 0)
+        {
+            std::cerr << coordinator.getNumReassignments() << " tasks were reassigned after worker failures." << std::endl;
+        }
+    }
+
+    // Repeated formulas, up to clause and literal order, are solved once and share the result;
+    // fingerprints ignore clause weights, so MaxSAT solves every formula.
+    std::vector<size_t> original(formulas.size());
+    std::unordered_map<FormulaFingerprint, size_t, FormulaFingerprint::Hash> first_seen;
+    for (size_t i = 0; i < formulas.size(); i++)
+    {
+        original[i] = options.dedupe && !options.maxsat && !distributed[i] ? first_seen.emplace(ResultCache::fingerprint(formulas[i]), i).first->second : i;
+    }
+
+    // Launch worker threads; each keeps one workspace and takes the next formula until none are left.
+    // Unpinned, the workers share one counter; pinned, each NUMA node has its own range of formulas.
+    WorkerPlacement placement(options.pin ? WorkerPlacement::detectNodes() : std::vector<NumaNode>(1, NumaNode{0, {}, {}}),
+                              options.threads, formulas.size());
+    int relocating_nodes = options.pin ? placement.getNumNodesUsed() : 0;
+    std::condition_variable nodes_relocated;
+    int running_workers = solve_locally ? options.threads : 0;
+    std::condition_variable workers_done;
+    for (int t = 0; t < options.threads && solve_locally; ++t)
+    {
+        workers.emplace_back([&, t]()
+                             {
+                                 Tracer::setThreadName("worker " + std::to_string(t));
+                                 std::vector<int> node_cpus;
+                                 if (options.pin)
+                                 {
+                                     placement.pin(t);
+                                     node_cpus = placement.getNodeCpus(t);
+                                     if (placement.isNodeLeader(t))
+                                     {
+                                         // Copy the node's formulas from here so their clauses are first touched on this node
+                                         TraceScope trace("relocate");
+                                         std::pair<size_t, size_t> range = placement.getRange(placement.getNode(t));
+                                         for (size_t i = range.first; i < range.second; i++)
+                                         {
+                                             BooleanFormula local(formulas[i]);
+                                             formulas[i] = std::move(local);
+                                         }
+                                     }
+                                     // No formula may be solved, or stolen, while it is being moved
+                                     std::unique_lock<std::mutex> lock(mtx);
+                                     if (placement.isNodeLeader(t) && --relocating_nodes == 0)
+                                     {
+                                         nodes_relocated.notify_all();
+                                     }
+                                     nodes_relocated.wait(lock, [&]
+                                                          { return relocating_nodes == 0; });
+                                 }
+                                 SolverWorkspace workspace;
+                                 std::unique_ptr<PerfCounters> counters(options.perf ? new PerfCounters() : nullptr);
+                                 for (size_t i; placement.next(t, i);)
+                                 {
+                                     if (original[i] == i && !distributed[i])
+                                     {
+                                         TraceScope trace("formula", i + 1);
+                                         processFormula(i, formulas, results, totals, mtx, options, workspace, cache.get(), counters.get(), node_cpus);
+                                     }
+                                 }
+                                 if (Tracer::isEnabled())
+                                 {
+                                     // Show the time this worker sits idle until the last one finishes
+                                     TraceScope trace("idle");
+                                     std::unique_lock<std::mutex> lock(mtx);
+                                     if (--running_workers == 0)
+                                     {
+                                         workers_done.notify_all();
+                                     }
+                                     workers_done.wait(lock, [&]
+                                                       { return running_workers == 0; });
+                                 } });
+    }
+    {
+        TraceScope trace("join");
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+    for (size_t i = 0; i < formulas.size(); i++)
+    {
+        if (original[i] != i)
+        {
+            const FormulaResult &first = results[original[i]];
+            recordResult(i, formulas[i], first.satisfiable, 0, first.assignment,
+                         "Duplicate of formula #" + std::to_string(original[i] + 1) + "\n", first.extra_columns,
+                         options.perf ? PerfSample().toColumns() : "", results, totals, mtx);
         }
     }
 
     // Output the results.
-    for (const auto &result : results)
     {
-        std::cout << result.output;
-        log_file << result.output;
-        csv_file << result.csv_data;
+        TraceScope trace("write output");
+        for (const auto &result : results)
+        {
+            std::cout << result.output;
+            log_file << result.output;
+            csv_file << result.csv_data;
+        }
     }
 
     // Append the summary results to the CSV file.
     csv_file << "Filename,Team Name,Total WFFs,Satisfiable WFFs,Unsatisfiable WFFs,WFFs with Provided Answers,Correctly Answered WFFs" << std::endl;
-    csv_file << base_filename << ",OrozcoAniceto," << total_wffs << "," << total_satisfiable << "," << total_unsatisfiable << "," << total_answer_provided << "," << total_correct_answers << std::endl;
+    csv_file << base_filename << ",OrozcoAniceto," << totals.wffs << "," << totals.satisfiable << "," << totals.unsatisfiable << "," << totals.answer_provided << "," << totals.correct_answers << std::endl;
 
     log_file.close();
     csv_file.close();
+    if (Tracer::isEnabled() && !Tracer::writeChromeTrace(options.trace_path))
+    {
+        std::cerr << "Failed to write trace file." << std::endl;
+        return 1;
+    }
     return 0;
 }